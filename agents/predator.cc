@@ -40,7 +40,7 @@ void Predator::AdjustProductPrefs(
   if (prefs.size() == 0)
     return;
   Request<Product>* req = prefs.begin()->first;
-  std::map<Bid<Product>*, double>::iterator it;
+  cyclus::PrefMap<cyclus::Product>::bid_map::iterator it;
   std::vector<Bid<Product>*> bids;
   for (it = prefs[req].begin(); it != prefs[req].end(); ++it) {
     bids.push_back(it->first);
@@ -10,6 +10,7 @@
 #include <boost/uuid/uuid_io.hpp>
 #include <boost/uuid/string_generator.hpp>
 
+#include "checkpoint_back.h"
 #include "cyclus.h"
 #include "hdf5_back.h"
 #include "pyhooks.h"
@@ -46,6 +47,12 @@ int EarlyExitArgs(const ArgInfo& ai);
 // Using cli flags, retrieves and sets global params for the simulation.
 void GetSimInfo(ArgInfo* ai);
 
+// Applies the table storage settings of the input file and then those of the
+// cli flags, which take precedence, to the hdf5 output backend. Returns false
+// if a setting is invalid.
+bool SetHdf5Storage(const ArgInfo& ai, Hdf5Back* hback,
+                    std::vector<TableStorageInfo> tables);
+
 static std::string usage = "Usage:   cyclus [opts] [input-file]";
 
 //-----------------------------------------------------------------------
@@ -128,14 +135,24 @@ int main(int argc, char* argv[]) {
 
   std::string ext = fs::path(ai.output_path).extension().string();
   std::string stem = fs::path(ai.output_path).stem().string();
+  Hdf5Back* hback = NULL;
   if (ext == ".h5") {
-    fback = new Hdf5Back(ai.output_path.c_str());
+    hback = new Hdf5Back(ai.output_path.c_str());
+    fback = hback;
   } else {
     fback = new SqliteBack(ai.output_path);
   }
   rec.RegisterBackend(fback);
   bdel.Add(fback);
 
+  // Checkpoints are written next to the output file as [stem].[time].ckpt
+  CheckpointBack* cback = NULL;
+  if (ai.vm.count("checkpoint") > 0) {
+    fs::path parent = fs::path(ai.output_path).parent_path();
+    cback = new CheckpointBack((parent / stem).string());
+    bdel.Add(cback);
+  }
+
   // Try to detect schema type
   std::stringstream input;
   LoadStringstreamFromFile(input, infile, format);
@@ -155,6 +172,19 @@ int main(int argc, char* argv[]) {
 
   SimInit si;
   if (ai.restart == "") {
+    // The loader flushes the recorder, so the storage settings must be set
+    // before it runs
+    if (hback != NULL) {
+      std::vector<TableStorageInfo> tables;
+      InfileTree* control = tree.SubTree("/*/control");
+      if (control->NMatches("hdf5") > 0) {
+        tables = LoadHdf5Storage(control->SubTree("hdf5"));
+      }
+      if (!SetHdf5Storage(ai, hback, tables)) {
+        return 1;
+      }
+    }
+
     // Read input file and initialize db and simulation from input file
     bool ms_print;
     if(ai.vm.count("rng-print") >= 1){
@@ -172,6 +202,9 @@ int main(int argc, char* argv[]) {
       CLOG(LEV_ERROR) << e.what();
       return 1;
     }
+    if (cback != NULL) {
+      rec.RegisterBackend(cback);
+    }
     si.Init(&rec, fback);
   } else {
     // Read output db and restart simulation from specified simid and timestep
@@ -199,13 +232,31 @@ int main(int argc, char* argv[]) {
     std::string ext = dbfile.extension().string();
     if (ext == ".h5") {
       rback = new Hdf5Back(dbfile.c_str());
+    } else if (ext == ".ckpt") {
+      rback = new CheckpointBack();
     } else {
       rback = new SqliteBack(dbfile.c_str());
     }
     bdel.Add(rback);
 
+    if (ext == ".ckpt") {
+      try {
+        static_cast<CheckpointBack*>(rback)->Load(dbfile.string());
+      } catch (cyclus::Error e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+      }
+    }
+
     si.Restart(rback, simid, t);
+    if (hback != NULL &&
+        !SetHdf5Storage(ai, hback, si.context()->sim_info().hdf5_storage)) {
+      return 1;
+    }
     si.recorder()->RegisterBackend(fback);
+    if (cback != NULL) {
+      si.recorder()->RegisterBackend(cback);
+    }
   }
 
   char* CYCLUS_NO_CATCH = getenv("CYCLUS_NO_CATCH");
@@ -238,7 +289,10 @@ int ParseCliArgs(ArgInfo* ai, int argc, char* argv[]) {
       ("help,h", "produce help message")
       ("version,V", "print cyclus core and dependency versions and quit")
       ("restart", po::value<std::string>(),
-       "restart from the specified simulation snapshot [db-file]:[sim-id]:[timestep]")
+       "restart from the specified simulation snapshot [db-file]:[sim-id]:[timestep],"
+       " where db-file may be a .ckpt checkpoint file")
+      ("checkpoint",
+       "write a binary checkpoint file for fast restarts at each snapshot")
       ("schema",
        "dump the cyclus master schema including all installed module schemas")
       ("agent-schema", po::value<std::string>(),
@@ -266,6 +320,15 @@ int ParseCliArgs(ArgInfo* ai, int argc, char* argv[]) {
       ("warn-limit", po::value<unsigned int>(),
        "number of warnings to issue per kind, defaults to 42")
       ("warn-as-error", "throw errors when warnings are issued")
+      ("hdf5-chunk-size", po::value<unsigned int>(),
+       "the default number of rows per chunk of .h5 output tables")
+      ("hdf5-codec", po::value<std::string>(),
+       "the default compression of .h5 output tables: none, deflate, lz4, "
+       "or zstd")
+      ("hdf5-level", po::value<int>(),
+       "the default compression level of .h5 output tables")
+      ("hdf5-shuffle", "shuffle the bytes of .h5 output tables before "
+       "compressing them")
       ("path,p", "print the CYCLUS_PATH")
       ("include", "print the cyclus include directory")
       ("install-path", "print the cyclus install directory")
@@ -530,3 +593,46 @@ void GetSimInfo(ArgInfo* ai) {
     ai->output_path = ai->vm["output-path"].as<std::string>();
   }
 }
+
+bool SetHdf5Storage(const ArgInfo& ai, Hdf5Back* hback,
+                    std::vector<TableStorageInfo> tables) {
+  // the cli flags set the default of all tables even if the input file
+  // does not
+  tables.insert(tables.begin(), TableStorageInfo());
+  for (int i = 0; i < tables.size(); ++i) {
+    TableStorageInfo& t = tables[i];
+    if (ai.vm.count("hdf5-chunk-size") > 0) {
+      t.chunk_size = ai.vm["hdf5-chunk-size"].as<unsigned int>();
+    }
+    if (ai.vm.count("hdf5-codec") > 0) {
+      t.codec = ai.vm["hdf5-codec"].as<std::string>();
+    }
+    if (ai.vm.count("hdf5-level") > 0) {
+      t.level = ai.vm["hdf5-level"].as<int>();
+    }
+    if (ai.vm.count("hdf5-shuffle") > 0) {
+      t.shuffle = 1;
+    }
+
+    Hdf5Back::TableStorage st = hback->storage(t.table);
+    if (t.chunk_size >= 0) {
+      st.chunk_size = t.chunk_size;
+    }
+    if (t.codec != "") {
+      st.codec = t.codec;
+    }
+    if (t.level >= 0) {
+      st.level = t.level;
+    }
+    if (t.shuffle >= 0) {
+      st.shuffle = t.shuffle > 0;
+    }
+    try {
+      hback->storage(t.table, st);
+    } catch (cyclus::ValueError err) {
+      std::cerr << err.what() << "\n";
+      return false;
+    }
+  }
+  return true;
+}
@@ -33,6 +33,8 @@ cdef cppclass CyclusAgentShim "CyclusAgentShim" (cpp_cyclus.Agent):  # C++CONSTR
     void DecomNotify() except +
     void AdjustMatlPrefs(cpp_cyclus.PrefMap[cpp_cyclus.Material].type&) except +
     void AdjustProductPrefs(cpp_cyclus.PrefMap[cpp_cyclus.Product].type&) except +
+    void AdjustMatlPrefTable(cpp_cyclus.PrefTable[cpp_cyclus.Material]&) except +
+    void AdjustProductPrefTable(cpp_cyclus.PrefTable[cpp_cyclus.Product]&) except +
     # Extra interface
     PyObject* self  # the Python object we are shimming
 
@@ -59,6 +61,8 @@ cdef cppclass CyclusRegionShim "CyclusRegionShim" (cpp_cyclus.Region):  # C++CON
     void DecomNotify() except +
     void AdjustMatlPrefs(cpp_cyclus.PrefMap[cpp_cyclus.Material].type&) except +
     void AdjustProductPrefs(cpp_cyclus.PrefMap[cpp_cyclus.Product].type&) except +
+    void AdjustMatlPrefTable(cpp_cyclus.PrefTable[cpp_cyclus.Material]&) except +
+    void AdjustProductPrefTable(cpp_cyclus.PrefTable[cpp_cyclus.Product]&) except +
     void Tick() except +
     void Tock() except +
     # Extra interface
@@ -87,6 +91,8 @@ cdef cppclass CyclusInstitutionShim "CyclusInstitutionShim" (cpp_cyclus.Institut
     void DecomNotify() except +
     void AdjustMatlPrefs(cpp_cyclus.PrefMap[cpp_cyclus.Material].type&) except +
     void AdjustProductPrefs(cpp_cyclus.PrefMap[cpp_cyclus.Product].type&) except +
+    void AdjustMatlPrefTable(cpp_cyclus.PrefTable[cpp_cyclus.Material]&) except +
+    void AdjustProductPrefTable(cpp_cyclus.PrefTable[cpp_cyclus.Product]&) except +
     void Tick() except +
     void Tock() except +
     # Extra interface
@@ -115,6 +121,8 @@ cdef cppclass CyclusFacilityShim "CyclusFacilityShim" (cpp_cyclus.Facility):  #
     void DecomNotify() except +
     void AdjustMatlPrefs(cpp_cyclus.PrefMap[cpp_cyclus.Material].type&) except +
     void AdjustProductPrefs(cpp_cyclus.PrefMap[cpp_cyclus.Product].type&) except +
+    void AdjustMatlPrefTable(cpp_cyclus.PrefTable[cpp_cyclus.Material]&) except +
+    void AdjustProductPrefTable(cpp_cyclus.PrefTable[cpp_cyclus.Product]&) except +
     void Tick() except +
     void Tock() except +
     cpp_bool CheckDecommissionCondition() except +
@@ -52,6 +52,57 @@ cdef cpp_cyclus.PrefMap[cpp_cyclus.Product].type* _GET_PROD_PREFS_PTR = NULL
 cdef dict _GET_PROD_PREFS = {}
 
 
+cdef dict material_pref_table_to_py(cpp_cyclus.PrefTable[cpp_cyclus.Material]& t):
+    """Converts a material PrefTable to a dict of equal-length lists."""
+    cdef int i
+    cdef list reqs = []
+    cdef list bids = []
+    for i in range(t.size()):
+        r = ts.MaterialRequest()
+        (<ts._MaterialRequest> r).ptx = t.requests[i]
+        reqs.append(r)
+        b = ts.MaterialBid()
+        (<ts._MaterialBid> b).ptx = t.bids[i]
+        bids.append(b)
+    return {'requests': reqs, 'bids': bids,
+            'requester_ids': t.requester_ids, 'bidder_ids': t.bidder_ids,
+            'commod_ids': t.commod_ids,
+            'commods': std_vector_std_string_to_py(t.commods),
+            'prefs': t.prefs}
+
+
+cdef dict product_pref_table_to_py(cpp_cyclus.PrefTable[cpp_cyclus.Product]& t):
+    """Converts a product PrefTable to a dict of equal-length lists."""
+    cdef int i
+    cdef list reqs = []
+    cdef list bids = []
+    for i in range(t.size()):
+        r = ts.ProductRequest()
+        (<ts._ProductRequest> r).ptx = t.requests[i]
+        reqs.append(r)
+        b = ts.ProductBid()
+        (<ts._ProductBid> b).ptx = t.bids[i]
+        bids.append(b)
+    return {'requests': reqs, 'bids': bids,
+            'requester_ids': t.requester_ids, 'bidder_ids': t.bidder_ids,
+            'commod_ids': t.commod_ids,
+            'commods': std_vector_std_string_to_py(t.commods),
+            'prefs': t.prefs}
+
+
+cdef void set_pref_table_prefs(std_vector[double]& prefs, object updates) except *:
+    """Writes the preferences returned by a Python pref table adjustment."""
+    cdef int i
+    if updates is None:
+        return
+    if len(updates) != prefs.size():
+        raise ValueError('a pref table adjustment must return one preference '
+                         'per arc, got {0} for {1} arcs'.format(len(updates),
+                                                               prefs.size()))
+    for i, pref in enumerate(updates):
+        prefs[i] = pref
+
+
 #
 # Shims
 #
@@ -177,6 +228,16 @@ cdef cppclass CyclusAgentShim "CyclusAgentShim" (cpp_cyclus.Agent):
         for (req, bid), pref in updates.items():
             prefs[(<ts._ProductRequest> req).ptx][(<ts._ProductBid> bid).ptx] = pref
 
+    void AdjustMatlPrefTable(cpp_cyclus.PrefTable[cpp_cyclus.Material]& prefs) except +:
+        pytable = material_pref_table_to_py(prefs)
+        updates = (<object> this.self).adjust_material_pref_table(pytable)
+        set_pref_table_prefs(prefs.prefs, updates)
+
+    void AdjustProductPrefTable(cpp_cyclus.PrefTable[cpp_cyclus.Product]& prefs) except +:
+        pytable = product_pref_table_to_py(prefs)
+        updates = (<object> this.self).adjust_product_pref_table(pytable)
+        set_pref_table_prefs(prefs.prefs, updates)
+
 
 cdef cppclass CyclusRegionShim "CyclusRegionShim" (cpp_cyclus.Region):
     # A C++ class that acts as a Region. It implements the Region virtual
@@ -301,6 +362,16 @@ cdef cppclass CyclusRegionShim "CyclusRegionShim" (cpp_cyclus.Region):
         for (req, bid), pref in updates.items():
             prefs[(<ts._ProductRequest> req).ptx][(<ts._ProductBid> bid).ptx] = pref
 
+    void AdjustMatlPrefTable(cpp_cyclus.PrefTable[cpp_cyclus.Material]& prefs) except +:
+        pytable = material_pref_table_to_py(prefs)
+        updates = (<object> this.self).adjust_material_pref_table(pytable)
+        set_pref_table_prefs(prefs.prefs, updates)
+
+    void AdjustProductPrefTable(cpp_cyclus.PrefTable[cpp_cyclus.Product]& prefs) except +:
+        pytable = product_pref_table_to_py(prefs)
+        updates = (<object> this.self).adjust_product_pref_table(pytable)
+        set_pref_table_prefs(prefs.prefs, updates)
+
     void Tick() except +:
         (<object> this.self).tick()
 
@@ -431,6 +502,16 @@ cdef cppclass CyclusInstitutionShim "CyclusInstitutionShim" (cpp_cyclus.Institut
         for (req, bid), pref in updates.items():
             prefs[(<ts._ProductRequest> req).ptx][(<ts._ProductBid> bid).ptx] = pref
 
+    void AdjustMatlPrefTable(cpp_cyclus.PrefTable[cpp_cyclus.Material]& prefs) except +:
+        pytable = material_pref_table_to_py(prefs)
+        updates = (<object> this.self).adjust_material_pref_table(pytable)
+        set_pref_table_prefs(prefs.prefs, updates)
+
+    void AdjustProductPrefTable(cpp_cyclus.PrefTable[cpp_cyclus.Product]& prefs) except +:
+        pytable = product_pref_table_to_py(prefs)
+        updates = (<object> this.self).adjust_product_pref_table(pytable)
+        set_pref_table_prefs(prefs.prefs, updates)
+
     void Tick() except +:
         (<object> this.self).tick()
 
@@ -570,6 +651,16 @@ cdef cppclass CyclusFacilityShim "CyclusFacilityShim" (cpp_cyclus.Facility):
         for (req, bid), pref in updates.items():
             prefs[(<ts._ProductRequest> req).ptx][(<ts._ProductBid> bid).ptx] = pref
 
+    void AdjustMatlPrefTable(cpp_cyclus.PrefTable[cpp_cyclus.Material]& prefs) except +:
+        pytable = material_pref_table_to_py(prefs)
+        updates = (<object> this.self).adjust_material_pref_table(pytable)
+        set_pref_table_prefs(prefs.prefs, updates)
+
+    void AdjustProductPrefTable(cpp_cyclus.PrefTable[cpp_cyclus.Product]& prefs) except +:
+        pytable = product_pref_table_to_py(prefs)
+        updates = (<object> this.self).adjust_product_pref_table(pytable)
+        set_pref_table_prefs(prefs.prefs, updates)
+
     void Tick() except +:
         (<object> this.self).tick()
 
@@ -713,6 +804,7 @@ cdef class _Agent(lib._Agent):
     niche = None
     tooltip = None
     userlevel = 0
+    use_pref_tables = False
 
     def __cinit__(self, lib._Context ctx):
         # Let subclasses do cinit() and if they don't make an new instance,
@@ -750,6 +842,9 @@ cdef class _Agent(lib._Agent):
             self.__dict__[name] = inv
             invs.append((name, inv))
         self._inventories = tuple(invs)
+        # register for the pref table adjustments
+        (<cpp_cyclus.Agent*> self.ptx).UsePrefTables(
+            bool_to_cpp(cls.use_pref_tables))
 
     @classmethod
     def _init_statevars(cls):
@@ -1025,6 +1120,23 @@ cdef class _Agent(lib._Agent):
         """Product preferences adjustment."""
         return None
 
+    def adjust_material_pref_table(self, table):
+        """Adjusts, in one pass, the material preferences of every arc requested
+        by this agent's descendants. This is only called on agents whose class
+        sets ``use_pref_tables = True``, after all adjust_material_prefs()
+        calls, with children called before their parents.
+
+        The table is a dict of equal-length lists with one entry per arc:
+        'requests', 'bids', 'requester_ids', 'bidder_ids', 'commod_ids' (indices
+        into 'commods'), and 'prefs'. Return None to leave the preferences as
+        they are, or a sequence of new preferences, one per arc.
+        """
+        return None
+
+    def adjust_product_pref_table(self, table):
+        """Product preference table adjustment, see adjust_material_pref_table()."""
+        return None
+
 
 class Agent(_Agent, lib.Agent):
     """Python Agent that is subclassable into any kind of agent.
@@ -442,6 +442,19 @@ cdef extern from "product.h" namespace "cyclus":
         void Absorb(shared_ptr[Product])
 
 
+cdef extern from "sequenced.h" namespace "cyclus":
+
+    cdef cppclass SequencedLess[T]:
+        pass
+
+    cdef cppclass SequencedMap[K, V]:
+        size_t size()
+        cpp_bool empty()
+        size_t count(K*)
+        V& at(K*)
+        V& operator[](K*)
+
+
 cdef extern from "request.h" namespace "cyclus":
 
     cdef cppclass Trader
@@ -522,9 +535,9 @@ cdef extern from "exchange_translation_context.h" namespace "cyclus":
     cdef cppclass ExchangeTranslationContext[T]:
         ctypedef Request[T]* request_ptr
         ctypedef Bid[T]* bid_ptr
-        map[request_ptr, ExchangeNode.Ptr] request_to_node
+        SequencedMap[Request[T], ExchangeNode.Ptr] request_to_node
         map[ExchangeNode.Ptr, request_ptr] node_to_request
-        map[bid_ptr, ExchangeNode.Ptr] bid_to_node
+        SequencedMap[Bid[T], ExchangeNode.Ptr] bid_to_node
         map[ExchangeNode.Ptr, bid_ptr] node_to_bid
 
 
@@ -605,13 +618,15 @@ cdef extern from "bid_portfolio.h" namespace "cyclus":
     cdef cppclass BidPortfolio[T]:
         ctypedef shared_ptr[BidPortfolio[T]] Ptr
         ctypedef Bid[T]* bid_ptr
+        cppclass bid_set:
+            size_t size()
         BidPortfolio()
         Bid[T]* AddBid(Request[T]*, shared_ptr[T], Trader*, cpp_bool)
         Bid[T]* AddBid(Request[T]*, shared_ptr[T], Trader*, cpp_bool, double)
         void AddConstraint(const CapacityConstraint[T]&)
         Trader* bidder()
         std_string commodity()
-        set[bid_ptr]& bids()
+        bid_set& bids()
         set[CapacityConstraint[T]]& constraints()
 
 
@@ -620,12 +635,25 @@ cdef extern from "exchange_context.h" namespace "cyclus":
     cdef cppclass PrefMap[T]:
         ctypedef Request[T]* request_ptr
         ctypedef Bid[T]* bid_ptr
-        ctypedef map[request_ptr, map[bid_ptr, double]] type
+        ctypedef map[bid_ptr, double, SequencedLess[Bid[T]]] bid_map
+        ctypedef map[request_ptr, bid_map, SequencedLess[Request[T]]] type
 
     cdef cppclass CommodMap[T]:
         ctypedef Request[T]* request_ptr
         ctypedef map[std_string, vector[request_ptr]] type
 
+    cdef cppclass PrefTable[T]:
+        ctypedef Request[T]* request_ptr
+        ctypedef Bid[T]* bid_ptr
+        size_t size()
+        vector[request_ptr] requests
+        vector[bid_ptr] bids
+        vector[int] requester_ids
+        vector[int] bidder_ids
+        vector[int] commod_ids
+        vector[std_string] commods
+        vector[double] prefs
+
 
 cdef extern from "agent.h" namespace "cyclus":
 
@@ -658,6 +686,10 @@ cdef extern from "agent.h" namespace "cyclus":
         void Decommission()
         void AdjustMatlPrefs(PrefMap[Material].type&)
         void AdjustProductPrefs(PrefMap[Product].type&)
+        void AdjustMatlPrefTable(PrefTable[Material]&)
+        void AdjustProductPrefTable(PrefTable[Product]&)
+        void UsePrefTables(cpp_bool)
+        cpp_bool use_pref_tables()
         std_string schema()
         cpp_jsoncpp.Value annotations() except +
         const std_string get_prototype "prototype" ()
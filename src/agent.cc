@@ -21,6 +21,7 @@ void Agent::InitFrom(Agent* m) {
   kind_ = m->kind_;
   spec_ = m->spec_;
   lifetime_ = m->lifetime_;
+  use_pref_tables_ = m->use_pref_tables_;
   ctx_ = m->ctx_;
 }
 
@@ -64,6 +65,7 @@ Agent::Agent(Context* ctx)
       enter_time_(-1),
       lifetime_(-1),
       parent_(NULL),
+      use_pref_tables_(false),
       spec_("UNSPECIFIED") {
   ctx_->agent_list_.insert(this);
   MLOG(LEV_DEBUG3) << "Agent ID=" << id_ << ", ptr=" << this << " created.";
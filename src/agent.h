@@ -329,6 +329,27 @@ class Agent : public StateWrangler, virtual public Ider {
   /// default implementation for material preferences.
   virtual void AdjustProductPrefs(PrefMap<Product>::type& prefs) {}
 
+  /// Adjusts, in one pass, the material preferences of every arc requested by
+  /// this agent's descendants. It is called once per exchange on every agent
+  /// that has a requesting descendant and has registered with
+  /// UsePrefTables, after all AdjustMatlPrefs calls, with children called
+  /// before their parents. The default implementation does nothing.
+  virtual void AdjustMatlPrefTable(PrefTable<Material>& prefs) {}
+
+  /// Adjusts, in one pass, the product preferences of every arc requested by
+  /// this agent's descendants (see AdjustMatlPrefTable).
+  virtual void AdjustProductPrefTable(PrefTable<Product>& prefs) {}
+
+  /// Registers (or unregisters) this agent for the AdjustMatlPrefTable and
+  /// AdjustProductPrefTable calls. Building the tables costs a pass over the
+  /// arcs of every requesting descendant, so agents that override either
+  /// hook must opt in, e.g., in their constructor. The registration is
+  /// copied by InitFrom.
+  inline void UsePrefTables(bool use) { use_pref_tables_ = use; }
+
+  /// Returns true if this agent has registered for the PrefTable calls.
+  inline bool use_pref_tables() const { return use_pref_tables_; }
+
   /// Returns an agent's xml rng schema for initializing from input files. All
   /// concrete agents should override this function. This must validate the same
   /// xml input that the InfileToDb function receives.
@@ -483,6 +504,9 @@ class Agent : public StateWrangler, virtual public Ider {
   /// an instance-unique ID for the agent
   int id_;
 
+  /// true if the agent has registered for the PrefTable calls
+  bool use_pref_tables_;
+
   Context* ctx_;
 };
 
@@ -5,7 +5,9 @@
 #include <boost/weak_ptr.hpp>
 #include <limits>
 
+#include "block_pool.h"
 #include "request.h"
+#include "sequenced.h"
 
 namespace cyclus {
 
@@ -16,8 +18,10 @@ template <class T> class BidPortfolio;
 ///
 /// @brief A Bid encapsulates all the information required to communicate a bid
 /// response to a request for a resource, including the resource bid and the
-/// bidder.
-template <class T> class Bid {
+/// bidder. Bids are allocated from a BlockPool and are numbered in the order
+/// of their creation.
+template <class T> class Bid : public Pooled<Bid<T> >,
+                               public Sequenced<Bid<T> > {
  public:
   /// @brief a factory method for a bid
   /// @param request the request being responded to by this bid
@@ -133,4 +137,5 @@ template <class T> class Bid {
 };
 
 }  // namespace cyclus
+
 #endif  // CYCLUS_SRC_BID_H_
@@ -8,8 +8,10 @@
 #include <boost/shared_ptr.hpp>
 
 #include "bid.h"
+#include "block_pool.h"
 #include "capacity_constraint.h"
 #include "error.h"
+#include "sequenced.h"
 
 namespace cyclus {
 
@@ -27,18 +29,24 @@ std::string GetTraderSpec(Trader* bidder);
 /// response to resource requests. It is a light wrapper around the set of bids
 /// and constraints for a given bidder, guaranteeing a single bidder per
 /// portfolio. Responses are grouped by the bidder. Constraints are assumed to
-/// act over the entire set of possible bids.
+/// act over the entire set of possible bids. Portfolios are allocated from a
+/// BlockPool and are numbered in the order of their creation.
 template <class T>
-class BidPortfolio : public boost::enable_shared_from_this<BidPortfolio<T>> {
+class BidPortfolio : public boost::enable_shared_from_this<BidPortfolio<T>>,
+                     public Pooled<BidPortfolio<T> >,
+                     public Sequenced<BidPortfolio<T> > {
  public:
   typedef boost::shared_ptr<BidPortfolio<T>> Ptr;
 
+  /// bids are ordered by id
+  typedef std::set<Bid<T>*, SequencedLess<Bid<T> > > bid_set;
+
   /// @brief default constructor
   BidPortfolio() : bidder_(NULL) {}
 
   /// deletes all bids associated with it
   ~BidPortfolio() {
-    typename std::set<Bid<T>*>::iterator it;
+    typename bid_set::iterator it;
     for (it = bids_.begin(); it != bids_.end(); ++it) {
       delete *it;
     }
@@ -96,7 +104,7 @@ class BidPortfolio : public boost::enable_shared_from_this<BidPortfolio<T>> {
   inline std::string commodity() const { return ""; }
 
   /// @return const access to the bids
-  inline const std::set<Bid<T>*>& bids() const { return bids_; }
+  inline const bid_set& bids() const { return bids_; }
 
   /// @return the set of constraints over the bids
   inline const std::set<CapacityConstraint<T>>& constraints() const {
@@ -110,7 +118,7 @@ class BidPortfolio : public boost::enable_shared_from_this<BidPortfolio<T>> {
     bidder_ = rhs.bidder_;
     bids_ = rhs.bids_;
     constraints_ = rhs.constraints_;
-    typename std::set<Bid<T>*>::iterator it;
+    typename bid_set::iterator it;
     for (it = bids_.begin(); it != bids_.end(); ++it) {
       it->get()->set_portfolio(this->shared_from_this());
     }
@@ -135,7 +143,7 @@ class BidPortfolio : public boost::enable_shared_from_this<BidPortfolio<T>> {
 
   // bid_ is a set because there is a one-to-one correspondence between a
   // bid and a request, i.e., bids are unique
-  std::set<Bid<T>*> bids_;
+  bid_set bids_;
 
   // constraints_ is a set because constraints are assumed to be unique
   std::set<CapacityConstraint<T>> constraints_;
@@ -0,0 +1,270 @@
+#ifndef CYCLUS_SRC_BLOCK_POOL_H_
+#define CYCLUS_SRC_BLOCK_POOL_H_
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+#include <boost/checked_delete.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace cyclus {
+
+/// @class BlockPool
+///
+/// @brief A BlockPool hands out fixed-size blocks of memory carved from large
+/// chunks and keeps freed blocks on a free list for reuse.
+///
+/// Objects that live for a single resource exchange (requests, bids, and their
+/// portfolios) are created and destroyed in bulk every time step. Drawing them
+/// from a pool means that after the first few exchanges the pool has grown to
+/// the high-water mark and the system allocator is no longer called at all.
+/// Chunks are never returned to the system.
+///
+/// Every thread keeps its own cache of free blocks, so that threads rarely
+/// contend for a pool. Since chunks are never returned and all blocks of a
+/// pool have the same size, a block may be freed on a different thread than
+/// the one it was allocated on: it joins the cache of the freeing thread. So
+/// that blocks allocated on one thread and freed on another (e.g., resources
+/// traded on the main thread and absorbed by agents ticking in parallel) are
+/// reused, a cache holds at most kMaxCached blocks. The surplus is moved, a
+/// chunk's worth at a time, to a free list shared by all threads, which a
+/// thread draws from before it allocates a new chunk. The cache of a thread
+/// that exits is moved to the shared list as well.
+template <std::size_t Size>
+class BlockPool {
+ public:
+  /// the number of blocks allocated from the system at a time
+  static const std::size_t kBlocksPerChunk = 256;
+
+  /// the number of free blocks a thread keeps to itself
+  static const std::size_t kMaxCached = 2 * kBlocksPerChunk;
+
+  /// @return a block of at least Size bytes, suitably aligned for any type
+  static void* Allocate() {
+    State& s = state();
+    if (s.free == NULL && !Refill(&s))
+      Grow(&s);
+    Block* b = s.free;
+    s.free = b->next;
+    --s.n_free;
+    ++s.n_allocated;
+    return b;
+  }
+
+  /// @brief returns a block obtained from Allocate() to the pool
+  static void Free(void* p) {
+    if (p == NULL)
+      return;
+    State& s = state();
+    Block* b = static_cast<Block*>(p);
+    b->next = s.free;
+    s.free = b;
+    ++s.n_free;
+    --s.n_allocated;
+    if (s.n_free > (s.exited ? 0 : kMaxCached))
+      Release(&s, s.exited ? s.n_free : kBlocksPerChunk);
+  }
+
+  /// @return the number of blocks currently handed out by this thread, less
+  /// the number of blocks it freed that other threads handed out
+  static std::size_t n_allocated() { return state().n_allocated; }
+
+  /// @return the number of blocks this thread obtained from the system so far
+  static std::size_t n_reserved() { return state().n_reserved; }
+
+  /// @return the number of free blocks in this thread's cache
+  static std::size_t n_cached() { return state().n_free; }
+
+ private:
+  union Block {
+    Block* next;
+    typename std::aligned_storage<
+        Size, std::alignment_of<std::max_align_t>::value>::type data;
+  };
+
+  struct State {
+    State()
+        : free(NULL), n_free(0), n_allocated(0), n_reserved(0),
+          exited(false) {}
+    Block* free;
+    std::size_t n_free;
+    std::size_t n_allocated;
+    std::size_t n_reserved;
+    /// whether the thread's thread_local objects have been destroyed, after
+    /// which freed blocks go straight to the shared list
+    bool exited;
+  };
+
+  /// the free blocks shared by all threads
+  struct Shared {
+    Shared() : free(NULL) {}
+    std::mutex mu;
+    Block* free;
+  };
+
+  /// moves the cache of a thread to the shared list when the thread exits
+  struct Releaser {
+    explicit Releaser(State* s) : s(s) {}
+    ~Releaser() {
+      s->exited = true;
+      Release(s, s->n_free);
+    }
+    State* s;
+  };
+
+  static void Grow(State* s) {
+    Block* chunk = static_cast<Block*>(
+        ::operator new(kBlocksPerChunk * sizeof(Block)));
+    for (std::size_t i = 0; i != kBlocksPerChunk; ++i) {
+      chunk[i].next = s->free;
+      s->free = &chunk[i];
+    }
+    s->n_free += kBlocksPerChunk;
+    s->n_reserved += kBlocksPerChunk;
+  }
+
+  /// moves up to a chunk's worth of blocks from the shared list to the cache
+  /// of a thread
+  /// @return whether any block was moved
+  static bool Refill(State* s) {
+    Shared& sh = shared();
+    std::lock_guard<std::mutex> lock(sh.mu);
+    std::size_t n = 0;
+    while (sh.free != NULL && n != kBlocksPerChunk) {
+      Block* b = sh.free;
+      sh.free = b->next;
+      b->next = s->free;
+      s->free = b;
+      ++n;
+    }
+    s->n_free += n;
+    return n > 0;
+  }
+
+  /// moves n blocks from the cache of a thread to the shared list
+  static void Release(State* s, std::size_t n) {
+    Shared& sh = shared();
+    std::lock_guard<std::mutex> lock(sh.mu);
+    for (std::size_t i = 0; i != n; ++i) {
+      Block* b = s->free;
+      s->free = b->next;
+      b->next = sh.free;
+      sh.free = b;
+    }
+    s->n_free -= n;
+  }
+
+  /// the state of each thread and the shared list are deliberately never
+  /// destroyed, so that pooled objects with static storage duration can
+  /// still be freed during program exit
+  /// @{
+  static State& state() {
+    static thread_local State* s = NULL;
+    if (s == NULL) {
+      s = new State();
+      static thread_local Releaser releaser(s);
+    }
+    return *s;
+  }
+
+  static Shared& shared() {
+    static Shared* sh = new Shared();
+    return *sh;
+  }
+  /// @}
+};
+
+template <std::size_t Size>
+const std::size_t BlockPool<Size>::kBlocksPerChunk;
+
+template <std::size_t Size>
+const std::size_t BlockPool<Size>::kMaxCached;
+
+/// @class Pooled
+///
+/// @brief Deriving T from Pooled<T> gives T class-specific operator new and
+/// delete that draw from a BlockPool sized for T. Objects of classes derived
+/// from T that are larger than T use the global allocator.
+template <class T>
+struct Pooled {
+  static void* operator new(std::size_t n) {
+    if (n != sizeof(T))
+      return ::operator new(n);
+    return BlockPool<sizeof(T)>::Allocate();
+  }
+
+  static void operator delete(void* p, std::size_t n) {
+    if (n != sizeof(T)) {
+      ::operator delete(p);
+    } else {
+      BlockPool<sizeof(T)>::Free(p);
+    }
+  }
+};
+
+/// @class PoolAllocator
+///
+/// @brief A standard allocator that draws single objects from a BlockPool sized
+/// for T. Arrays use the global allocator. It is mainly used to place the
+/// control blocks of shared pointers in a pool (see PoolShared).
+template <class T>
+struct PoolAllocator {
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  template <class U>
+  struct rebind {
+    typedef PoolAllocator<U> other;
+  };
+
+  PoolAllocator() {}
+
+  template <class U>
+  PoolAllocator(const PoolAllocator<U>&) {}
+
+  T* allocate(std::size_t n, const void* hint = NULL) {
+    if (n != 1)
+      return static_cast<T*>(::operator new(n * sizeof(T)));
+    return static_cast<T*>(BlockPool<sizeof(T)>::Allocate());
+  }
+
+  void deallocate(T* p, std::size_t n) {
+    if (n != 1) {
+      ::operator delete(p);
+    } else {
+      BlockPool<sizeof(T)>::Free(p);
+    }
+  }
+
+  std::size_t max_size() const { return std::size_t(-1) / sizeof(T); }
+};
+
+template <class T, class U>
+bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) {
+  return true;
+}
+
+template <class T, class U>
+bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) {
+  return false;
+}
+
+/// @return a shared pointer that owns p and whose reference count lives in a
+/// BlockPool. Combined with a Pooled T, creating the pointer does not call the
+/// system allocator at all.
+template <class T>
+boost::shared_ptr<T> PoolShared(T* p) {
+  return boost::shared_ptr<T>(p, boost::checked_deleter<T>(),
+                              PoolAllocator<T>());
+}
+
+}  // namespace cyclus
+
+#endif  // CYCLUS_SRC_BLOCK_POOL_H_
@@ -27,6 +27,18 @@ struct Converter {
       Arc const * a = NULL,
       ExchangeTranslationContext<T> const * ctx = NULL) const = 0;
 
+  /// @brief whether convert() depends only on the offer's quantity and
+  /// quality (its qual_id and, for materials, the time it was last decayed),
+  /// and not on the arc or exchange context
+  ///
+  /// During translation, the unit capacity of a pure converter is computed
+  /// once per distinct offer quantity and quality and reused for every other
+  /// arc with such an offer. Converters that do expensive work per offer (e.g.,
+  /// walking a composition) and meet this condition should return true.
+  virtual bool pure() const {
+    return false;
+  }
+
   /// @brief operator== is available for subclassing, see
   /// cyclus::TrivialConverter for an example
   virtual bool operator==(Converter& other) const {
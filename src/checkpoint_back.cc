@@ -0,0 +1,864 @@
+#include "checkpoint_back.h"
+
+#include <fstream>
+#include <sstream>
+#include <string.h>
+#include <typeinfo>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/serialization/list.hpp>
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/set.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/utility.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/uuid/uuid.hpp>
+
+#include "blob.h"
+#include "composition.h"
+#include "datum.h"
+#include "error.h"
+#include "logger.h"
+#include "material.h"
+#include "product.h"
+
+namespace cyclus {
+
+namespace {
+
+const char* kMagic = "cyclus-checkpoint";
+const int kVersion = 1;
+const std::vector<int> kNoRows;
+
+// returns the index of field in q or -1
+int Col(const QueryResult& q, const std::string& field) {
+  for (int i = 0; i < q.fields.size(); ++i) {
+    if (q.fields[i] == field) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int IntVal(const QueryResult& q, int row, int col) {
+  return q.rows[row][col].cast<int>();
+}
+
+// returns the value of key in m, or def if there is none
+int At(const std::map<int, int>& m, int key, int def) {
+  std::map<int, int>::const_iterator it = m.find(key);
+  return it == m.end() ? def : it->second;
+}
+
+bool StartsWith(const std::string& s, const std::string& prefix) {
+  return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool EndsWith(const std::string& s, const std::string& suffix) {
+  return s.size() >= suffix.size() &&
+         s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+struct TypeInfoLess {
+  bool operator()(const std::type_info* a, const std::type_info* b) const {
+    return a->before(*b);
+  }
+};
+
+typedef std::map<const std::type_info*, DbTypes, TypeInfoLess> TypeMap;
+
+// the types supported by the checkpoint format; these are the same as those
+// supported by the sqlite backend
+DbTypes TypeOf(const boost::spirit::hold_any& v) {
+  static TypeMap type_map;
+  if (type_map.empty()) {
+    type_map[&typeid(int)] = INT;
+    type_map[&typeid(double)] = DOUBLE;
+    type_map[&typeid(float)] = FLOAT;
+    type_map[&typeid(bool)] = BOOL;
+    type_map[&typeid(Blob)] = BLOB;
+    type_map[&typeid(boost::uuids::uuid)] = UUID;
+    type_map[&typeid(std::string)] = STRING;
+    type_map[&typeid(std::set<int>)] = SET_INT;
+    type_map[&typeid(std::set<std::string>)] = SET_STRING;
+    type_map[&typeid(std::vector<int>)] = VECTOR_INT;
+    type_map[&typeid(std::vector<double>)] = VECTOR_DOUBLE;
+    type_map[&typeid(std::vector<std::string>)] = VECTOR_STRING;
+    type_map[&typeid(std::list<int>)] = LIST_INT;
+    type_map[&typeid(std::list<std::string>)] = LIST_STRING;
+    type_map[&typeid(std::map<int, int>)] = MAP_INT_INT;
+    type_map[&typeid(std::map<int, double>)] = MAP_INT_DOUBLE;
+    type_map[&typeid(std::map<int, std::string>)] = MAP_INT_STRING;
+    type_map[&typeid(std::map<std::string, int>)] = MAP_STRING_INT;
+    type_map[&typeid(std::map<std::string, double>)] = MAP_STRING_DOUBLE;
+    type_map[&typeid(std::map<std::string, std::string>)] = MAP_STRING_STRING;
+    type_map[&typeid(std::map<std::string, std::vector<double> >)] =
+        MAP_STRING_VECTOR_DOUBLE;
+    type_map[&typeid(std::map<std::string, std::map<int, double> >)] =
+        MAP_STRING_MAP_INT_DOUBLE;
+    type_map[&typeid(std::map<std::string,
+                              std::pair<double, std::map<int, double> > >)] =
+        MAP_STRING_PAIR_DOUBLE_MAP_INT_DOUBLE;
+    type_map[&typeid(std::map<int, std::map<std::string, double> >)] =
+        MAP_INT_MAP_STRING_DOUBLE;
+    type_map[&typeid(
+        std::map<std::string,
+                 std::vector<std::pair<int, std::pair<std::string,
+                                                      std::string> > > >)] =
+        MAP_STRING_VECTOR_PAIR_INT_PAIR_STRING_STRING;
+    type_map[&typeid(
+        std::map<std::string,
+                 std::pair<std::string, std::vector<double> > >)] =
+        MAP_STRING_PAIR_STRING_VECTOR_DOUBLE;
+    type_map[&typeid(std::map<std::string, std::map<std::string, int> >)] =
+        MAP_STRING_MAP_STRING_INT;
+    type_map[&typeid(std::list<std::pair<int, int> >)] = LIST_PAIR_INT_INT;
+    type_map[&typeid(
+        std::vector<std::pair<std::pair<double, double>,
+                              std::map<std::string, double> > >)] =
+        VECTOR_PAIR_PAIR_DOUBLE_DOUBLE_MAP_STRING_DOUBLE;
+    type_map[&typeid(std::map<std::pair<std::string, std::string>, int>)] =
+        MAP_PAIR_STRING_STRING_INT;
+  }
+
+  TypeMap::iterator it = type_map.find(&v.type());
+  if (it == type_map.end()) {
+    throw ValueError(std::string("unsupported checkpoint type ") +
+                     v.type().name());
+  }
+  return it->second;
+}
+
+#define CYCLUS_COMMA ,
+#define CYCLUS_CKPT_TYPES(X) \
+  X(INT, int); \
+  X(BOOL, bool); \
+  X(DOUBLE, double); \
+  X(FLOAT, float); \
+  X(STRING, std::string); \
+  X(SET_INT, std::set<int>); \
+  X(SET_STRING, std::set<std::string>); \
+  X(LIST_INT, std::list<int>); \
+  X(LIST_STRING, std::list<std::string>); \
+  X(VECTOR_INT, std::vector<int>); \
+  X(VECTOR_DOUBLE, std::vector<double>); \
+  X(VECTOR_STRING, std::vector<std::string>); \
+  X(MAP_INT_DOUBLE, std::map<int CYCLUS_COMMA double>); \
+  X(MAP_INT_INT, std::map<int CYCLUS_COMMA int>); \
+  X(MAP_INT_STRING, std::map<int CYCLUS_COMMA std::string>); \
+  X(MAP_STRING_INT, std::map<std::string CYCLUS_COMMA int>); \
+  X(MAP_STRING_DOUBLE, std::map<std::string CYCLUS_COMMA double>); \
+  X(MAP_STRING_STRING, std::map<std::string CYCLUS_COMMA std::string>); \
+  X(MAP_STRING_VECTOR_DOUBLE, \
+    std::map<std::string CYCLUS_COMMA std::vector<double> >); \
+  X(MAP_STRING_MAP_INT_DOUBLE, \
+    std::map<std::string CYCLUS_COMMA std::map<int CYCLUS_COMMA double> >); \
+  X(MAP_STRING_PAIR_DOUBLE_MAP_INT_DOUBLE, \
+    std::map<std::string CYCLUS_COMMA std::pair< \
+        double CYCLUS_COMMA std::map<int CYCLUS_COMMA double> > >); \
+  X(MAP_INT_MAP_STRING_DOUBLE, \
+    std::map<int CYCLUS_COMMA std::map<std::string CYCLUS_COMMA double> >); \
+  X(MAP_STRING_VECTOR_PAIR_INT_PAIR_STRING_STRING, \
+    std::map<std::string CYCLUS_COMMA \
+             std::vector<std::pair<int CYCLUS_COMMA \
+             std::pair<std::string CYCLUS_COMMA std::string> > > >); \
+  X(MAP_STRING_PAIR_STRING_VECTOR_DOUBLE, \
+    std::map<std::string CYCLUS_COMMA \
+             std::pair<std::string CYCLUS_COMMA std::vector<double> > >); \
+  X(LIST_PAIR_INT_INT, std::list<std::pair<int CYCLUS_COMMA int> >); \
+  X(MAP_STRING_MAP_STRING_INT, \
+    std::map<std::string CYCLUS_COMMA \
+             std::map<std::string CYCLUS_COMMA int> >); \
+  X(VECTOR_PAIR_PAIR_DOUBLE_DOUBLE_MAP_STRING_DOUBLE, \
+    std::vector<std::pair<std::pair<double CYCLUS_COMMA double> CYCLUS_COMMA \
+                          std::map<std::string CYCLUS_COMMA double> > >); \
+  X(MAP_PAIR_STRING_STRING_INT, \
+    std::map<std::pair<std::string CYCLUS_COMMA std::string> CYCLUS_COMMA \
+             int>)
+
+void SaveVal(boost::archive::binary_oarchive& ar, DbTypes type,
+             const boost::spirit::hold_any& v) {
+#define CYCLUS_SAVEVAL(D, T) \
+  case D: { \
+    const T& x = v.cast<T>(); \
+    ar << x; \
+    break; \
+  }
+
+  switch (type) {
+    CYCLUS_CKPT_TYPES(CYCLUS_SAVEVAL);
+    case BLOB: {
+      std::string s = v.cast<Blob>().str();
+      ar << s;
+      break;
+    }
+    case UUID: {
+      boost::uuids::uuid u = v.cast<boost::uuids::uuid>();
+      ar.save_binary(u.data, 16);
+      break;
+    }
+    default: {
+      throw ValueError("attempted to save unsupported checkpoint type");
+    }
+  }
+#undef CYCLUS_SAVEVAL
+}
+
+void LoadVal(boost::archive::binary_iarchive& ar, DbTypes type,
+             boost::spirit::hold_any* v) {
+#define CYCLUS_LOADVAL(D, T) \
+  case D: { \
+    T x; \
+    ar >> x; \
+    *v = x; \
+    break; \
+  }
+
+  switch (type) {
+    CYCLUS_CKPT_TYPES(CYCLUS_LOADVAL);
+    case BLOB: {
+      std::string s;
+      ar >> s;
+      *v = Blob(s);
+      break;
+    }
+    case UUID: {
+      boost::uuids::uuid u;
+      ar.load_binary(u.data, 16);
+      *v = u;
+      break;
+    }
+    default: {
+      throw IOError("attempted to load unsupported checkpoint type");
+    }
+  }
+#undef CYCLUS_LOADVAL
+}
+
+#undef CYCLUS_CKPT_TYPES
+#undef CYCLUS_COMMA
+
+// compares a value of a scalar column against a condition
+bool MatchCond(const boost::spirit::hold_any& v, DbTypes type, Cond* c) {
+  switch (type) {
+    case INT: {
+      int x = v.cast<int>();
+      return CmpCond<int>(&x, c);
+    }
+    case BOOL: {
+      bool x = v.cast<bool>();
+      return CmpCond<bool>(&x, c);
+    }
+    case DOUBLE: {
+      double x = v.cast<double>();
+      return CmpCond<double>(&x, c);
+    }
+    case FLOAT: {
+      float x = v.cast<float>();
+      return CmpCond<float>(&x, c);
+    }
+    case STRING: {
+      std::string x = v.cast<std::string>();
+      return CmpCond<std::string>(&x, c);
+    }
+    case UUID: {
+      boost::uuids::uuid x = v.cast<boost::uuids::uuid>();
+      return CmpCond<boost::uuids::uuid>(&x, c);
+    }
+    default: {
+      throw ValueError("unsupported condition on field " + c->field);
+    }
+  }
+}
+
+// copies the fields and types of in, and the rows for which keep is true
+QueryResult Select(const QueryResult& in, const std::vector<bool>& keep) {
+  QueryResult out;
+  out.fields = in.fields;
+  out.types = in.types;
+  for (int i = 0; i < in.rows.size(); ++i) {
+    if (keep[i]) {
+      out.rows.push_back(in.rows[i]);
+    }
+  }
+  return out;
+}
+
+}  // namespace
+
+CheckpointBack::CheckpointBack(std::string prefix)
+    : prefix_(prefix),
+      pending_(-1),
+      saved_(false),
+      time_(-1) {}
+
+CheckpointBack::~CheckpointBack() {
+  try {
+    Flush();
+  } catch (Error err) {
+    CLOG(LEV_ERROR) << "Error in CheckpointBack destructor: " << err.what();
+  }
+}
+
+std::string CheckpointBack::Path(std::string prefix, int t) {
+  return prefix + "." + boost::lexical_cast<std::string>(t) + ".ckpt";
+}
+
+bool CheckpointBack::Keep(const std::string& title) {
+  static std::set<std::string> keep;
+  if (keep.empty()) {
+    keep.insert("DecayMode");
+    keep.insert("TimeStepDur");
+    keep.insert("Epsilon");
+    keep.insert("Recipes");
+    keep.insert("CommodPriority");
+    keep.insert("Prototypes");
+    keep.insert("AgentEntry");
+    keep.insert("AgentExit");
+    keep.insert("BuildSchedule");
+    keep.insert("DecomSchedule");
+    keep.insert("NextIds");
+    keep.insert("Sleeps");
+    keep.insert("Snapshots");
+    keep.insert("Resources");
+    keep.insert("MaterialInfo");
+    keep.insert("Compositions");
+    keep.insert("Products");
+  }
+  // simulation settings are recorded in tables whose titles start with Info
+  return keep.count(title) > 0 || StartsWith(title, "Info") ||
+         StartsWith(title, "AgentState") || EndsWith(title, "SolverInfo");
+}
+
+void CheckpointBack::Notify(DatumList data) {
+  // the indices of the tables that get rows are dropped once, after the
+  // batch; rows of a table mostly come in runs, so only a change of title is
+  // looked up in the set
+  std::set<std::string> changed;
+  const std::string* last = NULL;
+  for (DatumList::iterator it = data.begin(); it != data.end(); ++it) {
+    Datum* d = *it;
+    std::string title = d->title();
+    if (!Keep(title)) {
+      continue;
+    }
+    const Datum::Vals& vals = d->vals();
+
+    if (title == "Snapshots") {
+      // the previous snapshot is complete
+      if (pending_ != -1) {
+        if (!prefix_.empty() && !saved_) {
+          Save(Path(prefix_, pending_), pending_);
+        }
+        Prune(pending_);
+      }
+      saved_ = false;
+      for (int i = 0; i < vals.size(); ++i) {
+        if (std::string(vals[i].first) == "Time") {
+          pending_ = vals[i].second.cast<int>();
+        }
+      }
+      snap_mark_.clear();
+      for (Tables_::iterator t = tables_.begin(); t != tables_.end(); ++t) {
+        snap_mark_[t->first] = t->second.rows.size();
+      }
+    }
+
+    QueryResult& q = tables_[title];
+    if (q.fields.empty()) {
+      for (int i = 0; i < vals.size(); ++i) {
+        q.fields.push_back(vals[i].first);
+        q.types.push_back(TypeOf(vals[i].second));
+      }
+    }
+    QueryRow row;
+    row.reserve(vals.size());
+    for (int i = 0; i < vals.size(); ++i) {
+      row.push_back(vals[i].second);
+    }
+    q.rows.push_back(row);
+    if (last == NULL || *last != title) {
+      last = &*changed.insert(title).first;
+    }
+  }
+  for (std::set<std::string>::iterator it = changed.begin();
+       it != changed.end(); ++it) {
+    index_.erase(*it);
+  }
+}
+
+std::string CheckpointBack::Name() {
+  return prefix_.empty() ? "checkpoint" : prefix_;
+}
+
+void CheckpointBack::Flush() {
+  if (pending_ != -1 && !prefix_.empty() && !saved_) {
+    Save(Path(prefix_, pending_), pending_);
+    saved_ = true;
+  }
+}
+
+void CheckpointBack::Close() {
+  Flush();
+}
+
+std::map<int, int> CheckpointBack::StateTimes(int t) {
+  // every write of an agent's state includes its AgentStateAgent row
+  std::map<int, int> times;
+  if (tables_.count("AgentStateAgent") > 0) {
+    const QueryResult& q = tables_["AgentStateAgent"];
+    int ca = Col(q, "AgentId");
+    int ct = Col(q, "SimTime");
+    for (int i = 0; i < q.rows.size(); ++i) {
+      int time = IntVal(q, i, ct);
+      int id = IntVal(q, i, ca);
+      if (time <= t && (times.count(id) == 0 || times[id] < time)) {
+        times[id] = time;
+      }
+    }
+  }
+  return times;
+}
+
+CheckpointBack::Tables_ CheckpointBack::Filter(int t) {
+  Tables_ ckpt;
+
+  // prototypes are snapshotted once, when they are added
+  std::set<int> protos;
+  if (tables_.count("Prototypes") > 0) {
+    const QueryResult& q = tables_["Prototypes"];
+    int c = Col(q, "AgentId");
+    for (int i = 0; i < q.rows.size(); ++i) {
+      protos.insert(IntVal(q, i, c));
+    }
+  }
+
+  std::set<int> exited;
+  if (tables_.count("AgentExit") > 0) {
+    const QueryResult& q = tables_["AgentExit"];
+    int ca = Col(q, "AgentId");
+    int ct = Col(q, "ExitTime");
+    for (int i = 0; i < q.rows.size(); ++i) {
+      if (IntVal(q, i, ct) < t) {
+        exited.insert(IntVal(q, i, ca));
+      }
+    }
+  }
+
+  // with delta snapshots, an agent's state at t is the one it last wrote
+  std::map<int, int> times = StateTimes(t);
+
+  // the resources in inventories at the snapshot
+  std::set<int> rsrcs;
+  if (tables_.count("AgentStateInventories") > 0) {
+    const QueryResult& q = tables_["AgentStateInventories"];
+    int ca = Col(q, "AgentId");
+    int cr = Col(q, "ResourceId");
+    int ct = Col(q, "SimTime");
+    for (int i = 0; i < q.rows.size(); ++i) {
+      int id = IntVal(q, i, ca);
+      if (exited.count(id) == 0 && IntVal(q, i, ct) == At(times, id, t)) {
+        rsrcs.insert(IntVal(q, i, cr));
+      }
+    }
+  }
+
+  for (Tables_::iterator it = tables_.begin(); it != tables_.end(); ++it) {
+    const std::string& name = it->first;
+    const QueryResult& q = it->second;
+    if (name == "Compositions" || name == "Products") {
+      continue;  // depend on the resources, below
+    }
+
+    std::vector<bool> keep(q.rows.size(), true);
+    for (int i = 0; i < q.rows.size(); ++i) {
+      if (StartsWith(name, "AgentState")) {
+        int id = IntVal(q, i, Col(q, "AgentId"));
+        keep[i] = (exited.count(id) == 0 &&
+                   IntVal(q, i, Col(q, "SimTime")) == At(times, id, t)) ||
+                  protos.count(id) > 0;
+      } else if (name == "NextIds" || name == "Sleeps" ||
+                 name == "Snapshots") {
+        keep[i] = IntVal(q, i, Col(q, "Time")) == t;
+      } else if (name == "AgentEntry") {
+        keep[i] = exited.count(IntVal(q, i, Col(q, "AgentId"))) == 0;
+      } else if (name == "AgentExit") {
+        keep[i] = IntVal(q, i, Col(q, "ExitTime")) >= t;
+      } else if (name == "BuildSchedule") {
+        keep[i] = IntVal(q, i, Col(q, "BuildTime")) >= t;
+      } else if (name == "DecomSchedule") {
+        keep[i] = IntVal(q, i, Col(q, "DecomTime")) >= t;
+      } else if (name == "Resources" || name == "MaterialInfo") {
+        keep[i] = rsrcs.count(IntVal(q, i, Col(q, "ResourceId"))) > 0;
+      }
+    }
+    ckpt[name] = Select(q, keep);
+  }
+
+  // the compositions and products of the kept resources and recipes
+  std::set<int> comps;
+  std::set<int> prods;
+  if (ckpt.count("Resources") > 0) {
+    const QueryResult& q = ckpt["Resources"];
+    int ct = Col(q, "Type");
+    int cq = Col(q, "QualId");
+    for (int i = 0; i < q.rows.size(); ++i) {
+      std::string type = q.rows[i][ct].cast<std::string>();
+      if (type == Material::kType) {
+        comps.insert(IntVal(q, i, cq));
+      } else if (type == Product::kType) {
+        prods.insert(IntVal(q, i, cq));
+      }
+    }
+  }
+  if (ckpt.count("Recipes") > 0) {
+    const QueryResult& q = ckpt["Recipes"];
+    int cq = Col(q, "QualId");
+    for (int i = 0; i < q.rows.size(); ++i) {
+      comps.insert(IntVal(q, i, cq));
+    }
+  }
+  if (tables_.count("Compositions") > 0) {
+    const QueryResult& q = tables_["Compositions"];
+    int cq = Col(q, "QualId");
+    std::vector<bool> keep(q.rows.size());
+    for (int i = 0; i < q.rows.size(); ++i) {
+      keep[i] = comps.count(IntVal(q, i, cq)) > 0;
+    }
+    ckpt["Compositions"] = Select(q, keep);
+  }
+  if (tables_.count("Products") > 0) {
+    const QueryResult& q = tables_["Products"];
+    int cq = Col(q, "QualId");
+    std::vector<bool> keep(q.rows.size());
+    for (int i = 0; i < q.rows.size(); ++i) {
+      keep[i] = prods.count(IntVal(q, i, cq)) > 0;
+    }
+    ckpt["Products"] = Select(q, keep);
+  }
+
+  return ckpt;
+}
+
+void CheckpointBack::Prune(int t) {
+  std::set<int> protos;
+  std::set<int> exited;
+  std::set<int> rsrcs;
+  Tables_ ckpt = Filter(t);
+  if (ckpt.count("AgentEntry") > 0) {
+    // AgentEntry rows that were filtered out belong to exited agents
+    const QueryResult& q = tables_["AgentEntry"];
+    const QueryResult& kept = ckpt["AgentEntry"];
+    int c = Col(q, "AgentId");
+    std::set<int> alive;
+    for (int i = 0; i < kept.rows.size(); ++i) {
+      alive.insert(IntVal(kept, i, c));
+    }
+    for (int i = 0; i < q.rows.size(); ++i) {
+      if (alive.count(IntVal(q, i, c)) == 0) {
+        exited.insert(IntVal(q, i, c));
+      }
+    }
+  }
+  if (ckpt.count("Resources") > 0) {
+    const QueryResult& q = ckpt["Resources"];
+    int c = Col(q, "ResourceId");
+    for (int i = 0; i < q.rows.size(); ++i) {
+      rsrcs.insert(IntVal(q, i, c));
+    }
+  }
+  if (tables_.count("Prototypes") > 0) {
+    const QueryResult& q = tables_["Prototypes"];
+    int c = Col(q, "AgentId");
+    for (int i = 0; i < q.rows.size(); ++i) {
+      protos.insert(IntVal(q, i, c));
+    }
+  }
+
+  // later snapshots only need the state at t of the agents that did not
+  // write it again since, state recorded after t, and resource states that
+  // are either in an inventory at t or were recorded after t began;
+  // compositions are pruned below, once the resource states are, and
+  // products are always kept
+  std::map<int, int> times = StateTimes(t);
+  for (Tables_::iterator it = tables_.begin(); it != tables_.end(); ++it) {
+    const std::string& name = it->first;
+    QueryResult& q = it->second;
+    if (name == "Compositions") {
+      continue;
+    }
+    int mark = snap_mark_.count(name) > 0 ? snap_mark_[name] : 0;
+    std::vector<bool> keep(q.rows.size(), true);
+    for (int i = 0; i < q.rows.size(); ++i) {
+      if (StartsWith(name, "AgentState")) {
+        int id = IntVal(q, i, Col(q, "AgentId"));
+        int time = IntVal(q, i, Col(q, "SimTime"));
+        keep[i] = time > t || protos.count(id) > 0 ||
+                  (exited.count(id) == 0 && time == At(times, id, t));
+      } else if (name == "NextIds" || name == "Sleeps" ||
+                 name == "Snapshots") {
+        keep[i] = IntVal(q, i, Col(q, "Time")) > t;
+      } else if (name == "AgentEntry" || name == "AgentExit") {
+        keep[i] = exited.count(IntVal(q, i, Col(q, "AgentId"))) == 0;
+      } else if (name == "BuildSchedule") {
+        keep[i] = IntVal(q, i, Col(q, "BuildTime")) >= t;
+      } else if (name == "DecomSchedule") {
+        keep[i] = IntVal(q, i, Col(q, "DecomTime")) >= t;
+      } else if (name == "Resources" || name == "MaterialInfo") {
+        keep[i] = i >= mark ||
+                  rsrcs.count(IntVal(q, i, Col(q, "ResourceId"))) > 0;
+      }
+    }
+    q = Select(q, keep);
+  }
+
+  // later resource states may only refer to the compositions of the
+  // remaining resource states, of recipes, of the decay cache, or to new ones
+  if (tables_.count("Compositions") > 0) {
+    std::vector<int> cached = Composition::CachedIds();
+    std::set<int> comps(cached.begin(), cached.end());
+    if (tables_.count("Resources") > 0) {
+      const QueryResult& q = tables_["Resources"];
+      int ct = Col(q, "Type");
+      int cq = Col(q, "QualId");
+      for (int i = 0; i < q.rows.size(); ++i) {
+        if (q.rows[i][ct].cast<std::string>() == Material::kType) {
+          comps.insert(IntVal(q, i, cq));
+        }
+      }
+    }
+    if (tables_.count("Recipes") > 0) {
+      const QueryResult& q = tables_["Recipes"];
+      int cq = Col(q, "QualId");
+      for (int i = 0; i < q.rows.size(); ++i) {
+        comps.insert(IntVal(q, i, cq));
+      }
+    }
+    QueryResult& q = tables_["Compositions"];
+    int mark = snap_mark_.count("Compositions") > 0 ?
+               snap_mark_["Compositions"] : 0;
+    int cq = Col(q, "QualId");
+    std::vector<bool> keep(q.rows.size());
+    for (int i = 0; i < q.rows.size(); ++i) {
+      keep[i] = i >= mark || comps.count(IntVal(q, i, cq)) > 0;
+    }
+    q = Select(q, keep);
+  }
+  index_.clear();
+}
+
+std::string CheckpointBack::Pack(Datum* d, const char* exclude) {
+  return Pack(DatumList(1, d), exclude);
+}
+
+std::string CheckpointBack::Pack(const DatumList& data, const char* exclude) {
+  std::ostringstream ss(std::ios::out | std::ios::binary);
+  {
+    boost::archive::binary_oarchive ar(ss, boost::archive::no_header);
+    for (int j = 0; j < data.size(); ++j) {
+      std::string title = data[j]->title();
+      ar << title;
+      const Datum::Vals& vals = data[j]->vals();
+      for (int i = 0; i < vals.size(); ++i) {
+        if (exclude != NULL && strcmp(vals[i].first, exclude) == 0) {
+          continue;
+        }
+        std::string field = vals[i].first;
+        ar << field;
+        SaveVal(ar, TypeOf(vals[i].second), vals[i].second);
+      }
+    }
+  }
+  return ss.str();
+}
+
+void CheckpointBack::Save(std::string path, int t) {
+  Tables_ ckpt = Filter(t);
+
+  std::ofstream f(path.c_str(), std::ios::out | std::ios::binary);
+  if (!f) {
+    throw IOError("could not open checkpoint file " + path + " for writing");
+  }
+
+  // NOTE: the archive must be closed before the stream
+  {
+    boost::archive::binary_oarchive ar(f);
+    std::string magic(kMagic);
+    int version = kVersion;
+    int ntables = ckpt.size();
+    ar << magic << version << t << ntables;
+    for (Tables_::iterator it = ckpt.begin(); it != ckpt.end(); ++it) {
+      const QueryResult& q = it->second;
+      std::vector<int> types(q.types.begin(), q.types.end());
+      int nrows = q.rows.size();
+      ar << it->first << q.fields << types << nrows;
+      for (int i = 0; i < nrows; ++i) {
+        for (int j = 0; j < types.size(); ++j) {
+          SaveVal(ar, q.types[j], q.rows[i][j]);
+        }
+      }
+    }
+  }
+
+  if (!f) {
+    throw IOError("could not write checkpoint file " + path);
+  }
+}
+
+void CheckpointBack::Load(std::string path) {
+  std::ifstream f(path.c_str(), std::ios::in | std::ios::binary);
+  if (!f) {
+    throw IOError("could not open checkpoint file " + path);
+  }
+
+  // read the whole file at once
+  std::stringstream buf;
+  buf << f.rdbuf();
+
+  Tables_ tables;
+  int t;
+  try {
+    boost::archive::binary_iarchive ar(buf);
+    std::string magic;
+    int version;
+    ar >> magic >> version;
+    if (magic != kMagic || version != kVersion) {
+      throw IOError(path + " is not a cyclus checkpoint file (version " +
+                    boost::lexical_cast<std::string>(kVersion) + ")");
+    }
+
+    int ntables;
+    ar >> t >> ntables;
+    for (int n = 0; n < ntables; ++n) {
+      std::string name;
+      std::vector<int> types;
+      int nrows;
+      ar >> name;
+      QueryResult& q = tables[name];
+      ar >> q.fields >> types >> nrows;
+      for (int j = 0; j < types.size(); ++j) {
+        q.types.push_back(static_cast<DbTypes>(types[j]));
+      }
+      q.rows.resize(nrows);
+      for (int i = 0; i < nrows; ++i) {
+        q.rows[i].resize(types.size());
+        for (int j = 0; j < types.size(); ++j) {
+          LoadVal(ar, q.types[j], &q.rows[i][j]);
+        }
+      }
+    }
+  } catch (Error& e) {
+    throw;
+  } catch (std::exception& e) {
+    // a corrupt archive may fail in any number of ways
+    throw IOError("could not read checkpoint file " + path + ": " + e.what());
+  }
+
+  tables_.swap(tables);
+  index_.clear();
+  snap_mark_.clear();
+  pending_ = -1;
+  saved_ = false;
+  time_ = t;
+}
+
+const std::vector<int>* CheckpointBack::Candidates(const std::string& table,
+                                                   const QueryResult& q,
+                                                   std::vector<Cond>* conds) {
+  if (conds == NULL) {
+    return NULL;
+  }
+
+  for (int j = 0; j < conds->size(); ++j) {
+    Cond& c = (*conds)[j];
+    int col = Col(q, c.field);
+    if (c.opcode != EQ || q.types[col] != INT) {
+      continue;
+    }
+
+    std::map<int, std::vector<int> >& idx = index_[table][col];
+    if (idx.empty()) {
+      for (int i = 0; i < q.rows.size(); ++i) {
+        idx[IntVal(q, i, col)].push_back(i);
+      }
+    }
+    std::map<int, std::vector<int> >::iterator it = idx.find(c.val.cast<int>());
+    return it == idx.end() ? &kNoRows : &it->second;
+  }
+  return NULL;
+}
+
+QueryResult CheckpointBack::Query(std::string table,
+                                  std::vector<Cond>* conds) {
+  Tables_::iterator it = tables_.find(table);
+  if (it == tables_.end()) {
+    throw ValueError("Invalid table name " + table);
+  }
+  const QueryResult& q = it->second;
+
+  std::vector<int> cols;
+  if (conds != NULL) {
+    for (int j = 0; j < conds->size(); ++j) {
+      int col = Col(q, (*conds)[j].field);
+      if (col == -1) {
+        throw ValueError("Invalid field " + (*conds)[j].field +
+                         " for table " + table);
+      }
+      cols.push_back(col);
+    }
+  }
+
+  QueryResult rtn;
+  rtn.fields = q.fields;
+  rtn.types = q.types;
+  const std::vector<int>* rows = Candidates(table, q, conds);
+  int n = rows == NULL ? q.rows.size() : rows->size();
+  for (int k = 0; k < n; ++k) {
+    int i = rows == NULL ? k : (*rows)[k];
+    bool match = true;
+    for (int j = 0; j < cols.size() && match; ++j) {
+      match = MatchCond(q.rows[i][cols[j]], q.types[cols[j]], &(*conds)[j]);
+    }
+    if (match) {
+      rtn.rows.push_back(q.rows[i]);
+    }
+  }
+  return rtn;
+}
+
+std::map<std::string, DbTypes> CheckpointBack::ColumnTypes(std::string table) {
+  Tables_::iterator it = tables_.find(table);
+  if (it == tables_.end()) {
+    throw ValueError("Invalid table name " + table);
+  }
+  std::map<std::string, DbTypes> rtn;
+  for (int i = 0; i < it->second.fields.size(); ++i) {
+    rtn[it->second.fields[i]] = it->second.types[i];
+  }
+  return rtn;
+}
+
+std::list<ColumnInfo> CheckpointBack::Schema(std::string table) {
+  Tables_::iterator it = tables_.find(table);
+  if (it == tables_.end()) {
+    throw ValueError("Invalid table name " + table);
+  }
+  std::list<ColumnInfo> schema;
+  for (int i = 0; i < it->second.fields.size(); ++i) {
+    schema.push_back(ColumnInfo(table, it->second.fields[i], i,
+                                it->second.types[i], std::vector<int>()));
+  }
+  return schema;
+}
+
+std::set<std::string> CheckpointBack::Tables() {
+  std::set<std::string> rtn;
+  for (Tables_::iterator it = tables_.begin(); it != tables_.end(); ++it) {
+    rtn.insert(it->first);
+  }
+  return rtn;
+}
+
+}  // namespace cyclus
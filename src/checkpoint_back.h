@@ -0,0 +1,152 @@
+#ifndef CYCLUS_SRC_CHECKPOINT_BACK_H_
+#define CYCLUS_SRC_CHECKPOINT_BACK_H_
+
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "query_backend.h"
+
+namespace cyclus {
+
+/// A backend for fast restarts. When registered with a simulation's recorder,
+/// it keeps (in memory) only the tables that SimInit needs to restart a
+/// simulation and writes the state at each snapshot to a single binary
+/// checkpoint file. A checkpoint contains the simulation setup (info,
+/// recipes, solver, and prototypes), the agents alive at the snapshot and
+/// their state, the resources in their inventories and the compositions and
+/// products those refer to, the build and decommission schedules, the
+/// sleeping time listeners, and the next ids. Other datums are ignored. With
+/// delta snapshots, the state of an agent is the one it last wrote at or
+/// before the snapshot.
+///
+/// Between snapshots, the backend holds the rows of the last snapshot that
+/// later checkpoints still need plus every kept row recorded since: the
+/// memory used grows with the resource states and compositions recorded per
+/// snapshot interval rather than with the length of the simulation. Rows
+/// that the next checkpoint cannot need are dropped as each snapshot
+/// completes; among them, the compositions that are neither referenced by
+/// the remaining resource states or recipes nor held by the decay cache.
+/// Products are kept, since Product reuses the quality id of a quality for
+/// the whole run. This assumes that every resource alive at a snapshot is in
+/// an agent's inventory, as restarts do.
+///
+/// A checkpoint file is loaded with a single bulk read, and queries are
+/// answered from memory using per-column indices, so restarting from it takes
+/// time proportional to the size of the simulation state rather than to the
+/// size of the output database. For example:
+///
+/// @code
+/// CheckpointBack b;
+/// b.Load(CheckpointBack::Path("run", 120));
+/// SimInit si;
+/// si.Restart(&b, simid, 120);
+/// @endcode
+class CheckpointBack : public FullBackend {
+ public:
+  /// Creates an empty checkpoint backend. If prefix is not empty, the state
+  /// at each snapshot is written to Path(prefix, t) once the snapshot has been
+  /// recorded, i.e., when the backend is first flushed or the next snapshot
+  /// begins, whichever comes first. Each checkpoint is written once.
+  explicit CheckpointBack(std::string prefix = "");
+
+  virtual ~CheckpointBack();
+
+  /// @return the path of the checkpoint file for the snapshot at time t
+  static std::string Path(std::string prefix, int t);
+
+  /// Stores the Datum objects of the tables needed for restarts.
+  virtual void Notify(DatumList data);
+
+  /// Returns a unique name for this backend.
+  virtual std::string Name();
+
+  /// Writes the checkpoint of the most recent snapshot, if there is one, a
+  /// prefix was given, and it has not been written yet.
+  virtual void Flush();
+
+  /// Same as Flush.
+  virtual void Close();
+
+  virtual QueryResult Query(std::string table, std::vector<Cond>* conds);
+
+  virtual std::map<std::string, DbTypes> ColumnTypes(std::string table);
+
+  virtual std::list<ColumnInfo> Schema(std::string table);
+
+  virtual std::set<std::string> Tables();
+
+  /// Writes the state at the snapshot at time t to a checkpoint file.
+  ///
+  /// @throws IOError if the file cannot be written
+  void Save(std::string path, int t);
+
+  /// Replaces the contents of this backend with the checkpoint file at path.
+  ///
+  /// @throws IOError if the file cannot be read or is not a checkpoint
+  void Load(std::string path);
+
+  /// @return the time of the snapshot in the last loaded checkpoint, or -1
+  inline int time() const { return time_; }
+
+  /// Serializes the title, fields, and values of a datum in the checkpoint
+  /// format, skipping the field named exclude. Datums with equal contents
+  /// serialize to equal strings.
+  ///
+  /// @throws ValueError if a value has a type that checkpoints do not support
+  static std::string Pack(Datum* d, const char* exclude = NULL);
+
+  /// Serializes the datums in data one after another through a single
+  /// archive, as Pack does for each of them.
+  ///
+  /// @throws ValueError if a value has a type that checkpoints do not support
+  static std::string Pack(const DatumList& data, const char* exclude = NULL);
+
+ private:
+  typedef std::map<std::string, QueryResult> Tables_;
+
+  /// @return true if datums with the given title are needed for restarts
+  static bool Keep(const std::string& title);
+
+  /// @return the time at or before t at which each agent last wrote its
+  /// state; agents that are not listed are at t
+  std::map<int, int> StateTimes(int t);
+
+  /// @return the checkpoint for the snapshot at time t
+  Tables_ Filter(int t);
+
+  /// Drops the rows that are no longer needed once the snapshot at time t has
+  /// been written.
+  void Prune(int t);
+
+  /// Returns the rows of table that may match an "==" condition in conds,
+  /// using (and building, if needed) an index on an int column.
+  const std::vector<int>* Candidates(const std::string& table,
+                                     const QueryResult& q,
+                                     std::vector<Cond>* conds);
+
+  Tables_ tables_;
+
+  /// index_[table][column][value] are the rows with value in column
+  std::map<std::string,
+           std::map<int, std::map<int, std::vector<int> > > > index_;
+
+  /// the number of rows in each table when the pending snapshot began
+  std::map<std::string, int> snap_mark_;
+
+  std::string prefix_;
+
+  /// the time of the most recent snapshot, or -1
+  int pending_;
+
+  /// true once the checkpoint of the pending snapshot has been written
+  bool saved_;
+
+  int time_;
+};
+
+}  // namespace cyclus
+
+#endif  // CYCLUS_SRC_CHECKPOINT_BACK_H_
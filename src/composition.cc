@@ -1,9 +1,14 @@
 #include "composition.h"
 
+#include <mutex>
+#include <vector>
+
 #include "comp_math.h"
 #include "context.h"
 #include "decayer.h"
 #include "error.h"
+#include "id_blocks.h"
+#include "mem_stats.h"
 #include "recorder.h"
 
 extern "C" {
@@ -12,7 +17,22 @@ extern "C" {
 
 namespace cyclus {
 
-int Composition::next_id_ = 1;
+namespace {
+
+/// guards the lazily evaluated and shared state of all compositions: atom_ and
+/// mass_ until they are filled, recorded_, decay chains, and the decay cache.
+/// It is never destroyed, so that compositions can still be freed during
+/// program exit.
+std::mutex& CompMutex() {
+  static std::mutex* m = new std::mutex();
+  return *m;
+}
+
+}  // namespace
+
+std::atomic<int> Composition::next_id_(1);
+int Composition::cache_size_ = Composition::kDefaultDecayCacheSize;
+std::list<Composition::Ptr> Composition::cache_;
 
 Composition::Ptr Composition::CreateFromAtom(CompMap v) {
   if (!compmath::ValidNucs(v))
@@ -43,6 +63,11 @@ int Composition::id() {
 }
 
 const CompMap& Composition::atom() {
+  if (atom_ready_.load(std::memory_order_acquire)) {
+    return atom_;
+  }
+
+  std::lock_guard<std::mutex> lock(CompMutex());
   if (atom_.size() == 0) {
     CompMap::iterator it;
     for (it = mass_.begin(); it != mass_.end(); ++it) {
@@ -50,10 +75,16 @@ const CompMap& Composition::atom() {
       atom_[nuc] = it->second / pyne::atomic_mass(nuc);
     }
   }
+  atom_ready_.store(true, std::memory_order_release);
   return atom_;
 }
 
 const CompMap& Composition::mass() {
+  if (mass_ready_.load(std::memory_order_acquire)) {
+    return mass_;
+  }
+
+  std::lock_guard<std::mutex> lock(CompMutex());
   if (mass_.size() == 0) {
     CompMap::iterator it;
     for (it = atom_.begin(); it != atom_.end(); ++it) {
@@ -61,22 +92,56 @@ const CompMap& Composition::mass() {
       mass_[nuc] = it->second * pyne::atomic_mass(nuc);
     }
   }
+  mass_ready_.store(true, std::memory_order_release);
   return mass_;
 }
 
 Composition::Ptr Composition::Decay(int delta, uint64_t secs_per_timestep) {
   int tot_decay = prev_decay_ + delta;
-  if (decay_line_->count(tot_decay) == 1) {
-    // decay_line_ has cached, pre-computed result of this decay
-    return (*decay_line_)[tot_decay];
+
+  // compositions evicted from the cache are freed only once the lock is
+  // released, since freeing a composition takes it
+  std::list<Ptr> evicted;
+  {
+    std::lock_guard<std::mutex> lock(CompMutex());
+    Composition::Ptr decayed = Cached(tot_decay, &evicted);
+    if (decayed) {
+      return decayed;
+    }
   }
 
   // Calculate a new decayed composition and insert it into the decay chain.
   // It will automagically appear in the decay chain for all other compositions
   // that are a part of this decay chain because decay_line_ is a pointer that
-  // all compositions in the chain share.
+  // all compositions in the chain share. The calculation runs unlocked, so if
+  // another thread inserted the same decay in the meantime, its result is
+  // used instead.
   Composition::Ptr decayed = NewDecay(delta, secs_per_timestep);
+  std::lock_guard<std::mutex> lock(CompMutex());
+  Composition::Ptr other = Cached(tot_decay, &evicted);
+  if (other) {
+    evicted.push_back(decayed);
+    return other;
+  }
+  if (decay_line_->count(tot_decay) == 0) {
+    MemStats::Add(MemStats::DECAY_CHAIN, ChainBytes());
+  }
   (*decay_line_)[tot_decay] = decayed;
+  Cache(decayed, &evicted);
+  return decayed;
+}
+
+Composition::Ptr Composition::Cached(int tot_decay, std::list<Ptr>* evicted) {
+  Chain::iterator it = decay_line_->find(tot_decay);
+  if (it == decay_line_->end()) {
+    return Ptr();
+  }
+
+  // decay_line_ has a pre-computed result of this decay that may be alive
+  Composition::Ptr decayed = it->second.lock();
+  if (decayed) {
+    Cache(decayed, evicted);
+  }
   return decayed;
 }
 
@@ -84,11 +149,66 @@ Composition::Ptr Composition::Decay(int delta) {
   return Decay(delta, kDefaultTimeStepDur);
 }
 
-void Composition::Record(Context* ctx) {
-  if (recorded_) {
+void Composition::SetDecayCacheSize(int n) {
+  if (n < 0) {
+    throw ValueError("decay cache size must be non-negative");
+  }
+  std::list<Ptr> evicted;
+  std::lock_guard<std::mutex> lock(CompMutex());
+  cache_size_ = n;
+  Evict(&evicted);
+}
+
+std::vector<int> Composition::CachedIds() {
+  std::lock_guard<std::mutex> lock(CompMutex());
+  std::vector<int> ids;
+  ids.reserve(cache_.size());
+  for (std::list<Ptr>::iterator it = cache_.begin(); it != cache_.end(); ++it) {
+    ids.push_back((*it)->id_);
+  }
+  return ids;
+}
+
+void Composition::ClearDecayCache() {
+  // evicted compositions are freed after the lock is released
+  std::list<Ptr> evicted;
+  std::lock_guard<std::mutex> lock(CompMutex());
+  for (std::list<Ptr>::iterator it = cache_.begin(); it != cache_.end(); ++it) {
+    (*it)->cached_ = false;
+  }
+  evicted.splice(evicted.end(), cache_);
+}
+
+void Composition::Cache(Ptr c, std::list<Ptr>* evicted) {
+  if (cache_size_ == 0) {
     return;
   }
-  recorded_ = true;
+
+  if (c->cached_) {
+    cache_.splice(cache_.begin(), cache_, c->cache_pos_);
+  } else {
+    cache_.push_front(c);
+    c->cache_pos_ = cache_.begin();
+    c->cached_ = true;
+  }
+  Evict(evicted);
+}
+
+void Composition::Evict(std::list<Ptr>* evicted) {
+  while (cache_.size() > static_cast<size_t>(cache_size_)) {
+    cache_.back()->cached_ = false;
+    evicted->splice(evicted->end(), cache_, --cache_.end());
+  }
+}
+
+void Composition::Record(Context* ctx) {
+  {
+    std::lock_guard<std::mutex> lock(CompMutex());
+    if (recorded_) {
+      return;
+    }
+    recorded_ = true;
+  }
 
   CompMap::const_iterator it;
   CompMap cm = mass();  // force lazy evaluation now
@@ -102,18 +222,44 @@ void Composition::Record(Context* ctx) {
   }
 }
 
-Composition::Composition() : prev_decay_(0), recorded_(false) {
-  id_ = next_id_;
-  next_id_++;
+Composition::Composition()
+    : recorded_(false),
+      atom_ready_(false),
+      mass_ready_(false),
+      prev_decay_(0),
+      cached_(false) {
+  id_ = IdBlocks::Next(IdBlocks::COMP, &next_id_);
   decay_line_ = ChainPtr(new Chain());
+  MemStats::Add(MemStats::COMPOSITION, sizeof(Composition));
 }
 
 Composition::Composition(int prev_decay, ChainPtr decay_line)
-    : recorded_(false),
+    : decay_line_(decay_line),
+      recorded_(false),
+      atom_ready_(false),
+      mass_ready_(false),
       prev_decay_(prev_decay),
-      decay_line_(decay_line) {
-  id_ = next_id_;
-  next_id_++;
+      cached_(false) {
+  id_ = IdBlocks::Next(IdBlocks::COMP, &next_id_);
+  MemStats::Add(MemStats::COMPOSITION, sizeof(Composition));
+}
+
+Composition::~Composition() {
+  MemStats::Remove(MemStats::COMPOSITION, sizeof(Composition));
+  std::lock_guard<std::mutex> lock(CompMutex());
+
+  // drop this composition's entry from the decay chain, unless it has
+  // already been replaced by a live one
+  Chain::iterator it = decay_line_->find(prev_decay_);
+  if (it != decay_line_->end() && it->second.expired()) {
+    decay_line_->erase(it);
+    MemStats::Remove(MemStats::DECAY_CHAIN, ChainBytes());
+  }
+}
+
+long Composition::ChainBytes() {
+  // a map node is about four pointers plus its value
+  return 4 * sizeof(void*) + sizeof(Chain::value_type);
 }
 
 Composition::Ptr Composition::NewDecay(int delta, uint64_t secs_per_timestep) {
@@ -1,9 +1,13 @@
 #ifndef CYCLUS_SRC_COMPOSITION_H_
 #define CYCLUS_SRC_COMPOSITION_H_
 
+#include <atomic>
+#include <list>
 #include <map>
 #include <stdint.h>
+#include <vector>
 #include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
 
 class SimInitTest;
 
@@ -22,6 +26,13 @@ typedef std::map<Nuc, double> CompMap;
 /// keeps a pointer to references to every other composition that is a result of
 /// decaying this or a previously decayed-from composition.
 ///
+/// The references in a decay chain are weak, so decayed compositions are
+/// freed once no material uses them. To keep the common pattern of decaying
+/// many materials of the same recipe forward in lockstep from recomputing the
+/// same decay, the most recently used decayed compositions (of all chains)
+/// are also kept alive in a bounded cache whose size is set with
+/// SetDecayCacheSize.
+///
 /// Compositions are immutable and thus their state must be created/defined
 /// entirely at their creation. Compositions are created by passing in a
 /// CompMap (a map of nuclides to quantities). In general CompMaps are
@@ -37,11 +48,14 @@ typedef std::map<Nuc, double> CompMap;
 ///
 class Composition {
   friend class SimInit;
+  friend class Timer;
   friend class ::SimInitTest;
 
  public:
   typedef boost::shared_ptr<Composition> Ptr;
 
+  ~Composition();
+
   /// Creates a new composition from v with its components having appropriate
   /// atom-based ratios. v does not need to be normalized to any particular
   /// value.
@@ -77,11 +91,32 @@ class Composition {
   /// not done previously).
   void Record(Context* ctx);
 
+  /// Sets the maximum number of decayed compositions kept alive by the decay
+  /// cache, evicting the least recently used ones beyond it. 0 disables the
+  /// cache, so decayed compositions are only reused while a material holds
+  /// them.
+  static void SetDecayCacheSize(int n);
+
+  /// @return the maximum number of decayed compositions in the decay cache
+  static int decay_cache_size() { return cache_size_; }
+
+  /// @return the ids of the decayed compositions in the decay cache, which
+  /// may be given to new materials even if no material holds them
+  static std::vector<int> CachedIds();
+
+  /// Empties the decay cache, so that decayed compositions of a previous
+  /// simulation in the same process are neither kept alive nor reused.
+  /// Called whenever the Timer is initialized or reset.
+  static void ClearDecayCache();
+
+  /// Default of decay_cache_size.
+  static const int kDefaultDecayCacheSize = 1024;
+
  protected:
   /// a chain containing compositions that are a result of decay from a common
   /// ancestor composition. The key is the total amount of time a composition
   /// has been decayed from its root parent.
-  typedef std::map<int, Composition::Ptr> Chain;
+  typedef std::map<int, boost::weak_ptr<Composition> > Chain;
 
   typedef boost::shared_ptr<Chain> ChainPtr;
 
@@ -97,14 +132,46 @@ class Composition {
   /// Performs a decay calculation and creates a new decayed composition.
   Ptr NewDecay(int delta, uint64_t secs_per_timestep);
 
-  static int next_id_;
+  /// @return the live composition of this decay chain decayed tot_decay
+  /// timesteps, or an empty pointer. Requires the composition lock.
+  Ptr Cached(int tot_decay, std::list<Ptr>* evicted);
+
+  /// Marks c as the most recently used entry of the decay cache, moving the
+  /// least recently used entries beyond decay_cache_size to evicted.
+  /// Requires the composition lock.
+  static void Cache(Ptr c, std::list<Ptr>* evicted);
+
+  /// Moves the least recently used entries beyond decay_cache_size from the
+  /// decay cache to evicted. Requires the composition lock.
+  static void Evict(std::list<Ptr>* evicted);
+
+  /// @return the estimated bytes held by an entry in a decay chain
+  static long ChainBytes();
+
+  static std::atomic<int> next_id_;
+
+  /// The decay cache, shared by all decay chains of the process, from the
+  /// most to the least recently used composition. Both are guarded by the
+  /// composition lock (CompMutex in composition.cc).
+  static int cache_size_;
+  static std::list<Ptr> cache_;
+
   int id_;
   bool recorded_;
   CompMap atom_;
   CompMap mass_;
 
+  /// whether atom_ and mass_ are filled and will not change, so that they can
+  /// be read without the composition lock
+  std::atomic<bool> atom_ready_;
+  std::atomic<bool> mass_ready_;
+
   /// the total time delta this composition has been decayed from its root ancestor.
   int prev_decay_;
+
+  /// whether this composition is in cache_, and where
+  bool cached_;
+  std::list<Ptr>::iterator cache_pos_;
 };
 
 }  // namespace cyclus
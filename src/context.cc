@@ -7,6 +7,7 @@
 #include "exchange_solver.h"
 #include "logger.h"
 #include "pyhooks.h"
+#include "query_backend.h"
 #include "sim_init.h"
 #include "timer.h"
 #include "version.h"
@@ -25,6 +26,13 @@ SimInfo::SimInfo()
       branch_time(-1),
       explicit_inventory(false),
       explicit_inventory_compact(false),
+      dre_stats(false),
+      threads(1),
+      delta_snapshots(false),
+      checkpoint_interval(0),
+      checkpoint_minutes(0),
+      memory_stats(false),
+      decay_cache_size(Composition::kDefaultDecayCacheSize),
       parent_sim(boost::uuids::nil_uuid()),
       parent_type("init") {}
 
@@ -38,6 +46,13 @@ SimInfo::SimInfo(int dur, int y0, int m0, std::string handle)
       handle(handle),
       explicit_inventory(false),
       explicit_inventory_compact(false),
+      dre_stats(false),
+      threads(1),
+      delta_snapshots(false),
+      checkpoint_interval(0),
+      checkpoint_minutes(0),
+      memory_stats(false),
+      decay_cache_size(Composition::kDefaultDecayCacheSize),
       parent_sim(boost::uuids::nil_uuid()),
       parent_type("init") {}
 
@@ -51,6 +66,13 @@ SimInfo::SimInfo(int dur, int y0, int m0, std::string handle, std::string d)
       handle(handle),
       explicit_inventory(false),
       explicit_inventory_compact(false),
+      dre_stats(false),
+      threads(1),
+      delta_snapshots(false),
+      checkpoint_interval(0),
+      checkpoint_minutes(0),
+      memory_stats(false),
+      decay_cache_size(Composition::kDefaultDecayCacheSize),
       parent_sim(boost::uuids::nil_uuid()),
       parent_type("init") {}
 
@@ -67,10 +89,18 @@ SimInfo::SimInfo(int dur, boost::uuids::uuid parent_sim,
       branch_time(branch_time),
       explicit_inventory(false),
       explicit_inventory_compact(false),
+      dre_stats(false),
+      threads(1),
+      delta_snapshots(false),
+      checkpoint_interval(0),
+      checkpoint_minutes(0),
+      memory_stats(false),
+      decay_cache_size(Composition::kDefaultDecayCacheSize),
       handle(handle) {}
 
 Context::Context(Timer* ti, Recorder* rec)
-    : ti_(ti),
+    : snap_digests_(new std::map<int, Digest>()),
+      ti_(ti),
       rec_(rec),
       solver_(NULL),
       trans_id_(0),
@@ -93,12 +123,14 @@ Context::~Context() {
   for (int i = 0; i < to_del.size(); ++i) {
     DelAgent(to_del[i]);
   }
+  delete snap_digests_;
 }
 
 void Context::DelAgent(Agent* m) {
   int n = agent_list_.erase(m);
   if (n == 1) {
     PyDelAgent(m->id());
+    snap_digests_->erase(m->id());
     delete m;
     m = NULL;
   }
@@ -205,6 +237,27 @@ void Context::InitSim(SimInfo si) {
       ->AddVal("RecordInventoryCompact", si.explicit_inventory_compact)
       ->Record();
 
+  NewDatum("InfoOptions")
+      ->AddVal("RecordDreStats", si.dre_stats)
+      ->AddVal("Threads", si.threads)
+      ->AddVal("DeltaSnapshots", si.delta_snapshots)
+      ->AddVal("CheckpointInterval", si.checkpoint_interval)
+      ->AddVal("CheckpointMinutes", si.checkpoint_minutes)
+      ->AddVal("RecordMemoryStats", si.memory_stats)
+      ->AddVal("DecayCacheSize", si.decay_cache_size)
+      ->Record();
+
+  for (int i = 0; i < si.hdf5_storage.size(); ++i) {
+    const TableStorageInfo& st = si.hdf5_storage[i];
+    NewDatum("InfoHdf5Storage")
+        ->AddVal("TableName", st.table)
+        ->AddVal("ChunkSize", st.chunk_size)
+        ->AddVal("Codec", st.codec)
+        ->AddVal("Level", st.level)
+        ->AddVal("Shuffle", st.shuffle)
+        ->Record();
+  }
+
   // TODO: when the backends get uint64_t support, the static_cast here should
   // be removed.
   NewDatum("TimeStepDur")
@@ -236,10 +289,22 @@ void Context::UnregisterTimeListener(TimeListener* tl) {
   ti_->UnregisterTimeListener(tl);
 }
 
+void Context::Sleep(TimeListener* tl, int t) {
+  ti_->Sleep(tl, t);
+}
+
+void Context::Wake(Agent* a) {
+  ti_->Wake(a->id());
+}
+
 Datum* Context::NewDatum(std::string title) {
   return rec_->NewDatum(title);
 }
 
+void Context::RunTasks(int n, const std::function<void(int)>& task) {
+  ti_->RunTasks(n, task);
+}
+
 void Context::Snapshot() {
   ti_->Snapshot();
 }
@@ -1,9 +1,11 @@
 #ifndef CYCLUS_SRC_CONTEXT_H_
 #define CYCLUS_SRC_CONTEXT_H_
 
+#include <functional>
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 #include <stdint.h>
 
 #ifndef CYCPP
@@ -26,6 +28,7 @@ class SimInitTest;
 namespace cyclus {
 
 class Datum;
+class Digest;
 class ExchangeSolver;
 class Recorder;
 class Trader;
@@ -34,6 +37,28 @@ class TimeListener;
 class SimInit;
 class DynamicModule;
 
+/// The storage settings of an HDF5 output table (see Hdf5Back::storage). An
+/// empty table name sets the default of all tables, and negative or empty
+/// values leave the setting of the backend unchanged.
+struct TableStorageInfo {
+  TableStorageInfo() : chunk_size(-1), level(-1), shuffle(-1) {}
+
+  /// Name of the table.
+  std::string table;
+
+  /// Number of rows per chunk.
+  int chunk_size;
+
+  /// Compression codec.
+  std::string codec;
+
+  /// Compression level.
+  int level;
+
+  /// 1 to shuffle the bytes of the table before compression, 0 not to.
+  int shuffle;
+};
+
 /// Container for a static simulation-global parameters that both describe
 /// the simulation and affect its behavior.
 class SimInfo {
@@ -114,6 +139,39 @@ class SimInfo {
   /// every time step in a table (i.e. agent ID, Time, Quantity,
   /// Composition-object and/or reference).
   bool explicit_inventory_compact;
+
+  /// True if the timing and size of each phase of every resource exchange
+  /// should be recorded every time step in the DreStats table.
+  bool dre_stats;
+
+  /// Number of threads used to run the Tick and Tock of time listeners whose
+  /// agents are annotated as thread-safe (see Timer). 1 runs every time
+  /// listener serially.
+  int threads;
+
+  /// True if snapshots should only record the state of agents whose state
+  /// changed since their last snapshot, rather than that of every agent.
+  bool delta_snapshots;
+
+  /// Number of timesteps between automatic checkpoints (see Timer). 0
+  /// disables timestep-based checkpoints.
+  int checkpoint_interval;
+
+  /// Wall-clock minutes between automatic checkpoints (see Timer). 0
+  /// disables wall-clock-based checkpoints.
+  double checkpoint_minutes;
+
+  /// True if per-subsystem memory usage should be recorded to the
+  /// MemoryStats table every timestep (see MemStats).
+  bool memory_stats;
+
+  /// Maximum number of decayed compositions kept alive for reuse by later
+  /// decays (see Composition::SetDecayCacheSize).
+  int decay_cache_size;
+
+  /// Storage settings of HDF5 output tables, which the executable applies to
+  /// its Hdf5Back (see TableStorageInfo).
+  std::vector<TableStorageInfo> hdf5_storage;
 };
 
 /// A simulation context provides access to necessary simulation-global
@@ -227,6 +285,22 @@ class Context {
   /// Agents should unregister from their Decommission method.
   void UnregisterTimeListener(TimeListener* tl);
 
+  /// Puts a registered time listener to sleep: its Tick and Tock are not
+  /// called, starting with the current phase, until it is woken. A sleeping
+  /// time listener is woken at the start of timestep t (before the build
+  /// phase), when its agent receives a trade (i.e., before its next Tock), or
+  /// by Wake(), whichever comes first. The default t=-1 sleeps until one of
+  /// the latter two happens. Sleeping again changes the wake time. Sleep
+  /// states are recorded with each snapshot (in the Sleeps table) and
+  /// restored on restart.
+  ///
+  /// @throws ValueError if t is not in the future or tl is not registered
+  void Sleep(TimeListener* tl, int t = -1);
+
+  /// Wakes the time listener with the same id as a, if it is sleeping, so that
+  /// it receives tick/tock notifications again starting with the next phase.
+  void Wake(Agent* a);
+
   /// Initializes the simulation time parameters. Should only be called once -
   /// NOT idempotent.
   void InitSim(SimInfo si);
@@ -252,6 +326,9 @@ class Context {
   /// Schedules the simulation to be terminated at the end of this timestep.
   void KillSim();
 
+  /// See Timer::RunTasks documentation.
+  void RunTasks(int n, const std::function<void(int)>& task);
+
   /// @return the next transaction id
   inline int NextTransactionID() {
     return trans_id_++;
@@ -307,6 +384,9 @@ class Context {
   std::map<std::string, int> n_prototypes_;
   std::map<std::string, int> n_specs_;
 
+  /// digests of the state each agent last recorded in a delta snapshot
+  std::map<int, Digest>* snap_digests_;
+
   SimInfo si_;
   Timer* ti_;
   ExchangeSolver* solver_;
@@ -2,6 +2,7 @@
 
 #include <boost/pool/singleton_pool.hpp>
 
+#include "mem_stats.h"
 #include "timer.h"
 
 namespace cyclus {
@@ -75,6 +76,7 @@ void* Datum::operator new(size_t size) {
   while (true) {
     void* ptr = DatumPool::malloc();
     if (ptr != NULL) {
+      MemStats::Add(MemStats::DATUM, sizeof(Datum));
       return ptr;
     }
 
@@ -94,6 +96,7 @@ void Datum::operator delete(void* rawMemory) throw() {
   if (rawMemory == 0) {
     return;
   }
+  MemStats::Remove(MemStats::DATUM, sizeof(Datum));
   DatumPool::free(rawMemory);
 }
 
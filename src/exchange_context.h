@@ -4,6 +4,8 @@
 #include <assert.h>
 #include <map>
 #include <cmath>
+#include <cstddef>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -12,6 +14,7 @@
 #include "bid_portfolio.h"
 #include "request.h"
 #include "request_portfolio.h"
+#include "sequenced.h"
 
 // Undefines isnan from pyne
 #ifdef isnan
@@ -21,11 +24,69 @@
 
 namespace cyclus {
 
+/// @brief A strict weak ordering of traders by the id of each trader's
+/// manager, and of (supplier, requester) pairs of traders lexicographically.
+/// Traders with the same manager are ordered by address.
+///
+/// Containers of traders that are iterated during an exchange use this
+/// ordering rather than the traders' addresses, so that the order in which
+/// traders are visited, and hence the outcome of the exchange, is the same in
+/// every run.
+struct TraderCompare {
+  bool operator()(Trader* lhs, Trader* rhs) const;
+  bool operator()(const std::pair<Trader*, Trader*>& lhs,
+                  const std::pair<Trader*, Trader*>& rhs) const;
+};
+
+/// @brief The preferences of a requester's request-bid arcs, keyed by request
+/// and then by bid. Requests and bids are ordered by id.
 template <class T>
 struct PrefMap {
-  typedef std::map<Request<T>*, std::map<Bid<T>*, double> > type;
+  typedef std::map<Bid<T>*, double, SequencedLess<Bid<T> > > bid_map;
+  typedef std::map<Request<T>*, bid_map, SequencedLess<Request<T> > > type;
+  typedef Request<T>* request_ptr;
+  typedef Bid<T>* bid_ptr;
+};
+
+/// @class PrefTable
+///
+/// @brief A PrefTable holds the preferences of many request-bid arcs as flat
+/// arrays, one entry per arc, for agents that adjust preferences in bulk (see
+/// Agent::AdjustMatlPrefTable).
+///
+/// An institution or region that applies one policy to all of its children's
+/// trades (e.g., penalizing trades with agents of another region) can make a
+/// single pass over these arrays instead of walking each child's PrefMap.
+/// Only the preferences are read back into the exchange; changes to the other
+/// arrays are ignored.
+template <class T>
+struct PrefTable {
   typedef Request<T>* request_ptr;
   typedef Bid<T>* bid_ptr;
+
+  /// @return the number of arcs in the table
+  inline std::size_t size() const { return prefs.size(); }
+
+  /// @brief each arc's request
+  std::vector<Request<T>*> requests;
+
+  /// @brief each arc's bid
+  std::vector<Bid<T>*> bids;
+
+  /// @brief the id of the agent that manages each arc's requester
+  std::vector<int> requester_ids;
+
+  /// @brief the id of the agent that manages each arc's bidder
+  std::vector<int> bidder_ids;
+
+  /// @brief each arc's commodity, as an index into commods
+  std::vector<int> commod_ids;
+
+  /// @brief the commodities of the exchange, sorted by name
+  std::vector<std::string> commods;
+
+  /// @brief each arc's preference
+  std::vector<double> prefs;
 };
 
 template <class T>
@@ -71,8 +132,8 @@ struct ExchangeContext {
   /// @brief adds a bid to the context
   void AddBidPortfolio(const typename BidPortfolio<T>::Ptr port) {
     bids.push_back(port);
-    const std::set<Bid<T>*>& vr = port->bids();
-    typename std::set<Bid<T>*>::const_iterator it;
+    const typename BidPortfolio<T>::bid_set& vr = port->bids();
+    typename BidPortfolio<T>::bid_set::const_iterator it;
 
     for (it = vr.begin(); it != vr.end(); ++it) {
       Bid<T>* pb = *it;
@@ -101,20 +162,20 @@ struct ExchangeContext {
   std::vector<typename BidPortfolio<T>::Ptr> bids;
 
   /// @brief known requesters
-  std::set<Trader*> requesters;
+  std::set<Trader*, TraderCompare> requesters;
 
   /// @brief known bidders
-  std::set<Trader*> bidders;
+  std::set<Trader*, TraderCompare> bidders;
 
   /// @brief maps commodity name to requests for that commodity
   typename CommodMap<T>::type commod_requests;
 
-  /// @brief maps request to all bids for request
-  std::map< Request<T>*, std::vector<Bid<T>*> >
-      bids_by_request;
+  /// @brief maps request to all bids for request, in the order the requests
+  /// were first bid on
+  SequencedMap<Request<T>, std::vector<Bid<T>*> > bids_by_request;
 
   /// @brief maps commodity name to requests for that commodity
-  std::map<Trader*, typename PrefMap<T>::type> trader_prefs;
+  std::map<Trader*, typename PrefMap<T>::type, TraderCompare> trader_prefs;
 };
 
 }  // namespace cyclus
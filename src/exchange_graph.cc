@@ -15,35 +15,60 @@ ExchangeNode::ExchangeNode(double qty, bool exclusive, std::string commod,
       exclusive(exclusive),
       commod(commod),
       agent_id(agent_id),
-      group(NULL) {}
+      group(NULL) {
+  MemStats::Add(MemStats::EXCHANGE_NODE, sizeof(ExchangeNode));
+}
 
 ExchangeNode::ExchangeNode(double qty, bool exclusive)
     : qty(qty),
       exclusive(exclusive),
       commod(""),
       agent_id(-1),
-      group(NULL) {}
+      group(NULL) {
+  MemStats::Add(MemStats::EXCHANGE_NODE, sizeof(ExchangeNode));
+}
 
 ExchangeNode::ExchangeNode(double qty, bool exclusive, std::string commod)
     : qty(qty),
       exclusive(exclusive),
       commod(commod),
       agent_id(-1),
-      group(NULL) {}
+      group(NULL) {
+  MemStats::Add(MemStats::EXCHANGE_NODE, sizeof(ExchangeNode));
+}
 
 ExchangeNode::ExchangeNode(double qty)
     : qty(qty),
       exclusive(false),
       commod(""),
       agent_id(-1),
-      group(NULL) {}
+      group(NULL) {
+  MemStats::Add(MemStats::EXCHANGE_NODE, sizeof(ExchangeNode));
+}
 
 ExchangeNode::ExchangeNode()
     : qty(std::numeric_limits<double>::max()),
       exclusive(false),
       commod(""),
       agent_id(-1),
-      group(NULL) {}
+      group(NULL) {
+  MemStats::Add(MemStats::EXCHANGE_NODE, sizeof(ExchangeNode));
+}
+
+ExchangeNode::ExchangeNode(const ExchangeNode& other)
+    : group(other.group),
+      unit_capacities(other.unit_capacities),
+      prefs(other.prefs),
+      exclusive(other.exclusive),
+      commod(other.commod),
+      agent_id(other.agent_id),
+      qty(other.qty) {
+  MemStats::Add(MemStats::EXCHANGE_NODE, sizeof(ExchangeNode));
+}
+
+ExchangeNode::~ExchangeNode() {
+  MemStats::Remove(MemStats::EXCHANGE_NODE, sizeof(ExchangeNode));
+}
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 bool operator==(const ExchangeNode& lhs, const ExchangeNode& rhs) {
@@ -59,6 +84,7 @@ Arc::Arc(boost::shared_ptr<ExchangeNode> unode,
          boost::shared_ptr<ExchangeNode> vnode)
     : unode_(unode),
       vnode_(vnode) {
+  MemStats::Add(MemStats::ARC, sizeof(Arc));
   exclusive_ = unode->exclusive || vnode->exclusive;
   if (exclusive_) {
     double fqty = unode->qty;
@@ -84,7 +110,9 @@ Arc::Arc(const Arc& other)
       vnode_(other.vnode()),
       pref_(other.pref()),
       exclusive_(other.exclusive()),
-      excl_val_(other.excl_val()) {}
+      excl_val_(other.excl_val()) {
+  MemStats::Add(MemStats::ARC, sizeof(Arc));
+}
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void ExchangeNodeGroup::AddExchangeNode(ExchangeNode::Ptr node) {
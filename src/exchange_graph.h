@@ -10,6 +10,8 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/weak_ptr.hpp>
 
+#include "mem_stats.h"
+
 namespace cyclus {
 
 class ExchangeNodeGroup;
@@ -33,6 +35,8 @@ struct ExchangeNode {
   ExchangeNode(double qty, bool exclusive);
   ExchangeNode(double qty, bool exclusive, std::string commod);
   ExchangeNode(double qty, bool exclusive, std::string commod, int agent_id);
+  ExchangeNode(const ExchangeNode& other);
+  ~ExchangeNode();
 
   /// @brief the parent ExchangeNodeGroup to which this ExchangeNode belongs
   ExchangeNodeGroup* group;
@@ -69,12 +73,14 @@ class Arc {
   /// default required for usage in maps
   /// @warning, in general do not use this constructor; it exists for arcs to be
   /// map values
-  Arc() {}
+  Arc() { MemStats::Add(MemStats::ARC, sizeof(Arc)); }
 
   Arc(boost::shared_ptr<ExchangeNode> unode,
       boost::shared_ptr<ExchangeNode> vnode);
   Arc(const Arc& other);
 
+  ~Arc() { MemStats::Remove(MemStats::ARC, sizeof(Arc)); }
+
   inline Arc& operator=(const Arc& other) {
     unode_ = other.unode();
     vnode_ = other.vnode();
@@ -2,6 +2,7 @@
 #define CYCLUS_SRC_EXCHANGE_MANAGER_H_
 
 #include <algorithm>
+#include <chrono>
 
 #include "exchange_graph.h"
 #include "exchange_solver.h"
@@ -27,35 +28,58 @@ namespace cyclus {
 template <class T>
 class ExchangeManager {
  public:
-  ExchangeManager(Context* ctx) : ctx_(ctx), debug_(false) {
+  ExchangeManager(Context* ctx) : ctx_(ctx), debug_(false), stats_(false) {
     debug_ = Env::GetEnv("CYCLUS_DEBUG_DRE").size() > 0;
+    stats_ = ctx->sim_info().dre_stats;
   }
 
+  /// whether per-phase timing and sizing of each exchange is recorded in the
+  /// DreStats table, defaults to the simulation's SimInfo::dre_stats
+  /// @{
+  inline void record_stats(bool x) { stats_ = x; }
+  inline bool record_stats() const { return stats_; }
+  /// @}
+
   /// @brief execute the full resource sequence
   void Execute() {
+    Stats s;
+    Clock::time_point t = Clock::now();
+
     // collect resource exchange information
     ResourceExchange<T> exchng(ctx_);
     exchng.AddAllRequests();
+    s.request_time = Lap(&t);
     exchng.AddAllBids();
+    s.bid_time = Lap(&t);
     exchng.AdjustAll();
+    s.pref_time = Lap(&t);
     CLOG(LEV_DEBUG1) << "done with info gathering";
     
     if (debug_)
       RecordDebugInfo(exchng.ex_ctx());
 
-    if (exchng.Empty())
+    if (stats_)
+      CountPortfolios(exchng.ex_ctx(), &s);
+
+    if (exchng.Empty()) {
+      if (stats_)
+        RecordStats(s);
       return; // empty exchange, move on
+    }
 
     // translate graph
+    t = Clock::now();
     ExchangeTranslator<T> xlator(&exchng.ex_ctx());
     CLOG(LEV_DEBUG1) << "translating graph...";
     ExchangeGraph::Ptr graph = xlator.Translate();
     CLOG(LEV_DEBUG1) << "graph translated!";
+    s.translate_time = Lap(&t);
 
     // solve graph
     CLOG(LEV_DEBUG1) << "solving graph...";
     ctx_->solver()->Solve(graph.get());
     CLOG(LEV_DEBUG1) << "graph solved!";
+    s.solve_time = Lap(&t);
 
     // get trades
     std::vector< Trade<T> > trades;
@@ -65,6 +89,12 @@ class ExchangeManager {
     // execute trades!
     TradeExecutor<T> exec(trades);
     exec.ExecuteTrades(ctx_);
+    s.trade_time = Lap(&t);
+
+    if (stats_) {
+      CountGraph(graph.get(), &s);
+      RecordStats(s);
+    }
   }
 
  private:
@@ -93,8 +123,8 @@ class ExchangeManager {
 
     typename std::vector<typename BidPortfolio<T>::Ptr>::iterator it3;
     for (it3 = exctx.bids.begin(); it3 != exctx.bids.end(); ++it3) {
-      std::set<Bid<T>*> bids = (*it3)->bids();
-      typename std::set<Bid<T>*>::iterator it4;
+      const typename BidPortfolio<T>::bid_set& bids = (*it3)->bids();
+      typename BidPortfolio<T>::bid_set::const_iterator it4;
       for (it4 = bids.begin(); it4 != bids.end(); ++it4) {
         Bid<T>* b = *it4;
         Request<T>* r = b->request();
@@ -112,7 +142,79 @@ class ExchangeManager {
     }
   }
 
+  typedef std::chrono::steady_clock Clock;
+
+  /// wall times (s) and sizes of the phases of one exchange
+  struct Stats {
+    Stats()
+        : request_time(0), bid_time(0), pref_time(0), translate_time(0),
+          solve_time(0), trade_time(0), n_request_portfolios(0), n_requests(0),
+          n_bid_portfolios(0), n_bids(0), n_nodes(0), n_arcs(0),
+          n_matches(0) {}
+
+    double request_time;
+    double bid_time;
+    double pref_time;
+    double translate_time;
+    double solve_time;
+    double trade_time;
+    int n_request_portfolios;
+    int n_requests;
+    int n_bid_portfolios;
+    int n_bids;
+    int n_nodes;
+    int n_arcs;
+    int n_matches;
+  };
+
+  /// @return the seconds elapsed since *t, and resets *t to now
+  static double Lap(Clock::time_point* t) {
+    Clock::time_point now = Clock::now();
+    double dt = std::chrono::duration<double>(now - *t).count();
+    *t = now;
+    return dt;
+  }
+
+  void CountPortfolios(ExchangeContext<T>& exctx, Stats* s) {
+    s->n_request_portfolios = exctx.requests.size();
+    for (int i = 0; i != exctx.requests.size(); i++)
+      s->n_requests += exctx.requests[i]->requests().size();
+    s->n_bid_portfolios = exctx.bids.size();
+    for (int i = 0; i != exctx.bids.size(); i++)
+      s->n_bids += exctx.bids[i]->bids().size();
+  }
+
+  void CountGraph(ExchangeGraph* g, Stats* s) {
+    for (int i = 0; i != g->request_groups().size(); i++)
+      s->n_nodes += g->request_groups()[i]->nodes().size();
+    for (int i = 0; i != g->supply_groups().size(); i++)
+      s->n_nodes += g->supply_groups()[i]->nodes().size();
+    s->n_arcs = g->arcs().size();
+    s->n_matches = g->matches().size();
+  }
+
+  void RecordStats(const Stats& s) {
+    ctx_->NewDatum("DreStats")
+        ->AddVal("Time", ctx_->time())
+        ->AddVal("ResourceType", T::kType)
+        ->AddVal("RequestTime", s.request_time)
+        ->AddVal("BidTime", s.bid_time)
+        ->AddVal("PrefTime", s.pref_time)
+        ->AddVal("TranslateTime", s.translate_time)
+        ->AddVal("SolveTime", s.solve_time)
+        ->AddVal("TradeTime", s.trade_time)
+        ->AddVal("NRequestPortfolios", s.n_request_portfolios)
+        ->AddVal("NRequests", s.n_requests)
+        ->AddVal("NBidPortfolios", s.n_bid_portfolios)
+        ->AddVal("NBids", s.n_bids)
+        ->AddVal("NNodes", s.n_nodes)
+        ->AddVal("NArcs", s.n_arcs)
+        ->AddVal("NMatches", s.n_matches)
+        ->Record();
+  }
+
   bool debug_;
+  bool stats_;
   Context* ctx_;
 };
 
@@ -2,10 +2,12 @@
 #define CYCLUS_SRC_EXCHANGE_TRANSLATION_CONTEXT_H_
 
 #include <map>
+#include <utility>
 
 #include "bid.h"
 #include "exchange_graph.h"
 #include "request.h"
+#include "sequenced.h"
 
 namespace cyclus {
 
@@ -17,10 +19,18 @@ namespace cyclus {
 template <class T>
 struct ExchangeTranslationContext {
  public:
-  std::map<Request<T>*, ExchangeNode::Ptr> request_to_node;
+  SequencedMap<Request<T>, ExchangeNode::Ptr> request_to_node;
   std::map<ExchangeNode::Ptr, Request<T>*> node_to_request;
-  std::map<Bid<T>*, ExchangeNode::Ptr> bid_to_node;
+  SequencedMap<Bid<T>, ExchangeNode::Ptr> bid_to_node;
   std::map<ExchangeNode::Ptr, Bid<T>*> node_to_bid;
+
+  /// a pure converter's result is identified by the converter and the offer's
+  /// quality (see ConvertedQuality) and quantity
+  typedef std::pair<const void*, std::pair<std::pair<int, int>, double> >
+      ConverterKey;
+
+  /// unit capacities of pure converters computed so far in this exchange
+  mutable std::map<ConverterKey, double> unit_caps;
 };
 
 }  // namespace cyclus
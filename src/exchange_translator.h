@@ -1,7 +1,10 @@
 #ifndef CYCLUS_SRC_EXCHANGE_TRANSLATOR_H_
 #define CYCLUS_SRC_EXCHANGE_TRANSLATOR_H_
 
+#include <map>
+#include <set>
 #include <sstream>
+#include <utility>
 
 #include "bid.h"
 #include "bid_portfolio.h"
@@ -9,6 +12,7 @@
 #include "exchange_graph.h"
 #include "exchange_translation_context.h"
 #include "logger.h"
+#include "material.h"
 #include "request.h"
 #include "request_portfolio.h"
 #include "trade.h"
@@ -64,8 +68,8 @@ class ExchangeTranslator {
       graph->AddSupplyGroup(ns);
 
       // add each request-bid arc
-      const std::set<Bid<T>*>& bids = (*bp_it)->bids();
-      typename std::set<Bid<T>*>::const_iterator b_it;
+      const typename BidPortfolio<T>::bid_set& bids = (*bp_it)->bids();
+      typename BidPortfolio<T>::bid_set::const_iterator b_it;
       for (b_it = bids.begin(); b_it != bids.end(); ++b_it) {
         Bid<T>* bid = *b_it;
         Request<T>* req = bid->request();
@@ -191,7 +195,7 @@ ExchangeNodeGroup::Ptr TranslateBidPortfolio(
 
   std::map<typename T::Ptr, std::vector<ExchangeNode::Ptr> > excl_bid_grps;
 
-  typename std::set<Bid<T>*>::const_iterator b_it;
+  typename BidPortfolio<T>::bid_set::const_iterator b_it;
   for (b_it = bp->bids().begin();
        b_it != bp->bids().end();
        ++b_it) {
@@ -273,8 +277,23 @@ Trade<T> BackTranslateMatch(const ExchangeTranslationContext<T>&
   return t;
 }
 
+/// @return the quality of a resource as a converter sees it. Under lazy
+/// decay, a material's qual_id() names the composition it was last decayed
+/// to, and comp() decays it to the current time, so materials are also told
+/// apart by the time of their last decay. The resource is not modified.
+/// @{
+inline std::pair<int, int> ConvertedQuality(Resource::Ptr r) {
+  return std::make_pair(r->qual_id(), 0);
+}
+
+inline std::pair<int, int> ConvertedQuality(Material::Ptr m) {
+  return std::make_pair(m->qual_id(), m->prev_decay_time());
+}
+/// @}
+
 /// @brief updates a node's unit capacities given, a target resource and
-/// constraints
+/// constraints. The unit capacities of pure converters are memoized in the
+/// translation context.
 template<typename T>
 void TranslateCapacities(
     typename T::Ptr offer,
@@ -282,12 +301,25 @@ void TranslateCapacities(
     ExchangeNode::Ptr n,
     const Arc& a,
     const ExchangeTranslationContext<T>& ctx) {
+  typedef typename ExchangeTranslationContext<T>::ConverterKey Key;
   typename std::set< CapacityConstraint<T> >::const_iterator it;
   for (it = constr.begin(); it != constr.end(); ++it) {
-    CLOG(cyclus::LEV_DEBUG1) << "Additing unit capacity: "
-                             << it->convert(offer, &a, &ctx) / offer->quantity();
-    n->unit_capacities[a].push_back(it->convert(offer, &a, &ctx) /
-                                    offer->quantity());
+    const Converter<T>* conv = it->converter().get();
+    double ucap;
+    if (conv->pure()) {
+      Key key(conv, std::make_pair(ConvertedQuality(offer), offer->quantity()));
+      typename std::map<Key, double>::iterator found = ctx.unit_caps.find(key);
+      if (found == ctx.unit_caps.end()) {
+        ucap = it->convert(offer, &a, &ctx) / offer->quantity();
+        ctx.unit_caps.insert(std::make_pair(key, ucap));
+      } else {
+        ucap = found->second;
+      }
+    } else {
+      ucap = it->convert(offer, &a, &ctx) / offer->quantity();
+    }
+    CLOG(cyclus::LEV_DEBUG1) << "Additing unit capacity: " << ucap;
+    n->unit_capacities[a].push_back(ucap);
   }
 }
 
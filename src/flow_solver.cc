@@ -0,0 +1,228 @@
+#include "flow_solver.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <map>
+#include <queue>
+#include <utility>
+
+#include "cyc_limits.h"
+#include "exchange_graph.h"
+#include "greedy_solver.h"
+#include "logger.h"
+
+namespace cyclus {
+
+// the largest request quantity the ProgTranslator admits (see XlateGrp_)
+static const double kMaxDemand = 1e15;
+
+// @return true if every unit capacity of node n for arc a is one and there is
+// one per group capacity
+static bool HasUnitCaps(ExchangeNode::Ptr n, const Arc& a) {
+  int ncaps = n->group->capacities().size();
+  std::map<Arc, std::vector<double> >::iterator it = n->unit_capacities.find(a);
+  if (it == n->unit_capacities.end())
+    return ncaps == 0;
+
+  std::vector<double>& ucaps = it->second;
+  if (ucaps.size() != ncaps)
+    return false;
+  for (int i = 0; i != ucaps.size(); i++) {
+    if (ucaps[i] != 1.0)
+      return false;
+  }
+  return true;
+}
+
+FlowSolver::FlowSolver()
+    : fallback_(new GreedySolver(kDefaultExclusive)),
+      ExchangeSolver(kDefaultExclusive) {}
+
+FlowSolver::FlowSolver(bool exclusive_orders)
+    : fallback_(new GreedySolver(exclusive_orders)),
+      ExchangeSolver(exclusive_orders) {}
+
+FlowSolver::FlowSolver(bool exclusive_orders, ExchangeSolver* fallback)
+    : fallback_(fallback),
+      ExchangeSolver(exclusive_orders) {
+  if (fallback_ == NULL)
+    fallback_ = new GreedySolver(exclusive_orders);
+}
+
+FlowSolver::~FlowSolver() {
+  delete fallback_;
+}
+
+bool FlowSolver::IsFlowGraph(ExchangeGraph* g) const {
+  std::vector<RequestGroup::Ptr>& rgs = g->request_groups();
+  for (int i = 0; i != rgs.size(); i++) {
+    if (rgs[i]->HasArcs() && rgs[i]->capacities().size() != 1)
+      return false;
+  }
+
+  std::vector<ExchangeNodeGroup::Ptr>& sgs = g->supply_groups();
+  for (int i = 0; i != sgs.size(); i++) {
+    if (sgs[i]->capacities().size() > 1)
+      return false;
+  }
+
+  std::vector<Arc>& arcs = g->arcs();
+  for (int i = 0; i != arcs.size(); i++) {
+    const Arc& a = arcs[i];
+    if (exclusive_orders_ && a.exclusive())
+      return false;
+    ExchangeNode::Ptr u = a.unode();
+    ExchangeNode::Ptr v = a.vnode();
+    if (u->group == NULL || v->group == NULL)
+      return false;
+    if (!HasUnitCaps(u, a) || !HasUnitCaps(v, a))
+      return false;
+  }
+  return true;
+}
+
+double FlowSolver::SolveGraph() {
+  if (!IsFlowGraph(graph_)) {
+    CLOG(LEV_DEBUG1) << "Exchange is not a transportation problem, "
+                     << "deferring to the fallback solver.";
+    fallback_->sim_ctx(sim_ctx_);
+    return fallback_->Solve(graph_);
+  }
+
+  double pseudo_cost = PseudoCost();  // from ExchangeSolver API
+  double inf = std::numeric_limits<double>::max();
+  std::vector<ExchangeNodeGroup::Ptr>& sgs = graph_->supply_groups();
+  std::vector<RequestGroup::Ptr>& rgs = graph_->request_groups();
+  std::vector<Arc>& arcs = graph_->arcs();
+
+  // network nodes are the source, each supply group, each request group, and
+  // the sink, in that order
+  std::map<ExchangeNodeGroup*, int> idx;
+  int n = 1;
+  for (int i = 0; i != sgs.size(); i++)
+    idx[sgs[i].get()] = n++;
+  for (int i = 0; i != rgs.size(); i++)
+    idx[rgs[i].get()] = n++;
+  int src = 0;
+  int sink = n++;
+  Init_(n);
+
+  for (int i = 0; i != sgs.size(); i++) {
+    std::vector<double>& caps = sgs[i]->capacities();
+    AddEdge_(src, idx[sgs[i].get()], caps.empty() ? inf : caps[0], 0);
+  }
+
+  std::vector<int> arc_edges(arcs.size());
+  for (int i = 0; i != arcs.size(); i++) {
+    const Arc& a = arcs[i];
+    ExchangeNode::Ptr u = a.unode();
+    int to = idx[u->group];
+    double cost = ArcCost(a) - pseudo_cost;
+    arc_edges[i] = AddEdge_(idx[a.vnode()->group], to, u->qty, cost);
+    pot_[to] = std::min(pot_[to], cost);
+  }
+
+  // a request group's demand that is not routed to the sink is unmet
+  std::vector<int> dem_edges(rgs.size(), -1);
+  std::vector<double> dems(rgs.size(), 0);
+  for (int i = 0; i != rgs.size(); i++) {
+    if (!rgs[i]->HasArcs())
+      continue;
+    int from = idx[rgs[i].get()];
+    dems[i] = std::min(rgs[i]->capacities()[0], kMaxDemand);
+    dem_edges[i] = AddEdge_(from, sink, dems[i], 0);
+    pot_[sink] = std::min(pot_[sink], pot_[from]);
+  }
+
+  int n_paths = 0;
+  while (Augment_(src, sink))
+    ++n_paths;
+  CLOG(LEV_DEBUG1) << "Flow solver found " << n_paths << " augmenting paths.";
+
+  // back translate; the flow on an edge is its reverse edge's capacity
+  double obj = 0;
+  for (int i = 0; i != arcs.size(); i++) {
+    double flow = edges_[arc_edges[i] ^ 1].cap;
+    if (flow > eps()) {
+      graph_->AddMatch(arcs[i], flow);
+      obj += ArcCost(arcs[i]) * flow;
+    }
+  }
+  for (int i = 0; i != rgs.size(); i++) {
+    if (dem_edges[i] >= 0)
+      obj += pseudo_cost * std::max(0.0, dems[i] - edges_[dem_edges[i] ^ 1].cap);
+  }
+  return obj;
+}
+
+void FlowSolver::Init_(int n_nodes) {
+  edges_.clear();
+  adj_.assign(n_nodes, std::vector<int>());
+  pot_.assign(n_nodes, 0);
+  dist_.resize(n_nodes);
+  prev_.resize(n_nodes);
+}
+
+int FlowSolver::AddEdge_(int from, int to, double cap, double cost) {
+  int id = edges_.size();
+  edges_.push_back(Edge(to, cap, cost));
+  edges_.push_back(Edge(from, 0, -cost));
+  adj_[from].push_back(id);
+  adj_[to].push_back(id + 1);
+  return id;
+}
+
+bool FlowSolver::Augment_(int src, int sink) {
+  // Dijkstra by reduced cost, which the potentials keep nonnegative
+  typedef std::pair<double, int> Item;
+  double inf = std::numeric_limits<double>::max();
+  std::fill(dist_.begin(), dist_.end(), inf);
+  std::fill(prev_.begin(), prev_.end(), -1);
+  std::priority_queue<Item, std::vector<Item>, std::greater<Item> > q;
+  dist_[src] = 0;
+  q.push(Item(0, src));
+  while (!q.empty()) {
+    Item it = q.top();
+    q.pop();
+    int from = it.second;
+    if (it.first > dist_[from])
+      continue;
+    std::vector<int>& out = adj_[from];
+    for (int i = 0; i != out.size(); i++) {
+      Edge& e = edges_[out[i]];
+      if (e.cap <= eps())
+        continue;
+      double rc = std::max(0.0, e.cost + pot_[from] - pot_[e.to]);
+      double d = dist_[from] + rc;
+      if (d < dist_[e.to]) {
+        dist_[e.to] = d;
+        prev_[e.to] = out[i];
+        q.push(Item(d, e.to));
+      }
+    }
+  }
+
+  if (dist_[sink] == inf)
+    return false;
+
+  // only paths that lower the total cost are worth taking
+  double cost = dist_[sink] + pot_[sink] - pot_[src];
+  for (int i = 0; i != pot_.size(); i++) {
+    if (dist_[i] < inf)
+      pot_[i] += dist_[i];
+  }
+  if (cost >= 0)
+    return false;
+
+  double flow = inf;
+  for (int v = sink; v != src; v = edges_[prev_[v] ^ 1].to)
+    flow = std::min(flow, edges_[prev_[v]].cap);
+  for (int v = sink; v != src; v = edges_[prev_[v] ^ 1].to) {
+    edges_[prev_[v]].cap -= flow;
+    edges_[prev_[v] ^ 1].cap += flow;
+  }
+  return true;
+}
+
+}  // namespace cyclus
@@ -0,0 +1,90 @@
+#ifndef CYCLUS_SRC_FLOW_SOLVER_H_
+#define CYCLUS_SRC_FLOW_SOLVER_H_
+
+#include <vector>
+
+#include "exchange_solver.h"
+
+namespace cyclus {
+
+class ExchangeGraph;
+
+/// @brief The FlowSolver solves resource exchanges that are transportation
+/// problems exactly, as a min-cost network flow.
+///
+/// An exchange graph is a transportation problem when
+///   1) every request group with arcs has exactly one capacity,
+///   2) every supply group has at most one capacity,
+///   3) every arc's unit capacities are one (i.e., the constraints come from
+///      trivial, quantity-based converters), and
+///   4) no arc is exclusive (or exclusive orders are not enforced).
+///
+/// Such a graph is solved by successive shortest paths on the network
+/// source -> supply groups -> request groups -> sink, where each arc costs its
+/// ExchangeSolver::Cost() less the pseudo cost of unmet demand. The result is
+/// the same optimum the ProgSolver finds for the linear program, without
+/// building or solving one.
+///
+/// Any other graph is handed to a fallback solver.
+///
+/// @warning the FlowSolver is responsible for deleting its fallback solver!
+class FlowSolver: public ExchangeSolver {
+ public:
+  /// FlowSolver constructor
+  /// @param exclusive_orders a flag for enforcing integral, quantized orders
+  /// @param fallback the solver to use for graphs that are not transportation
+  /// problems; if NULL, a GreedySolver is used
+  /// @{
+  FlowSolver();
+  explicit FlowSolver(bool exclusive_orders);
+  FlowSolver(bool exclusive_orders, ExchangeSolver* fallback);
+  /// @}
+
+  virtual ~FlowSolver();
+
+  /// @return true if the graph is a transportation problem that this solver
+  /// solves directly
+  bool IsFlowGraph(ExchangeGraph* g) const;
+
+  /// @return the fallback solver
+  inline ExchangeSolver* fallback() const { return fallback_; }
+
+ protected:
+  /// @brief the flow solver solves transportation problems directly and
+  /// defers all others to its fallback
+  /// @return the objective value of the solution, including the pseudo cost
+  /// of unmet demand
+  virtual double SolveGraph();
+
+ private:
+  /// an edge of the residual network; edges are stored in pairs such that
+  /// edge i ^ 1 is the reverse of edge i
+  struct Edge {
+    Edge(int to, double cap, double cost) : to(to), cap(cap), cost(cost) {}
+    int to;
+    double cap;
+    double cost;
+  };
+
+  /// adds an edge and its zero-capacity reverse edge
+  /// @return the index of the forward edge
+  int AddEdge_(int from, int to, double cap, double cost);
+
+  /// finds a shortest path from src to sink by reduced cost and augments
+  /// flow along it if its true cost is negative
+  /// @return false if no such path exists
+  bool Augment_(int src, int sink);
+
+  void Init_(int n_nodes);
+
+  std::vector<Edge> edges_;
+  std::vector< std::vector<int> > adj_;
+  std::vector<double> pot_;
+  std::vector<double> dist_;
+  std::vector<int> prev_;
+  ExchangeSolver* fallback_;
+};
+
+}  // namespace cyclus
+
+#endif  // CYCLUS_SRC_FLOW_SOLVER_H_
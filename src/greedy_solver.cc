@@ -3,6 +3,10 @@
 #include <algorithm>
 #include <cassert>
 #include <functional>
+#include <limits>
+#include <map>
+#include <queue>
+#include <utility>
 #include <vector>
 #include <boost/math/special_functions/next.hpp>
 
@@ -17,19 +21,22 @@ void Capacity(boost::shared_ptr<cyclus::ExchangeNode>, cyclus::Arc const&,
               double) {};
 
 GreedySolver::GreedySolver(bool exclusive_orders, GreedyPreconditioner* c)
-    : conditioner_(c),
-      ExchangeSolver(exclusive_orders) {}
+    : ExchangeSolver(exclusive_orders),
+      conditioner_(c),
+      best_first_(false) {}
 
 GreedySolver::GreedySolver(bool exclusive_orders)
-    : ExchangeSolver(exclusive_orders) {
+    : ExchangeSolver(exclusive_orders),
+      best_first_(false) {
   conditioner_ = new cyclus::GreedyPreconditioner();  
 }
 
 GreedySolver::GreedySolver(GreedyPreconditioner* c)
-    : conditioner_(c),
-      ExchangeSolver(true) {}
+    : ExchangeSolver(true),
+      conditioner_(c),
+      best_first_(false) {}
 
-GreedySolver::GreedySolver() : ExchangeSolver(true) {
+GreedySolver::GreedySolver() : ExchangeSolver(true), best_first_(false) {
   conditioner_ = new cyclus::GreedyPreconditioner();  
 }
 
@@ -59,11 +66,17 @@ void GreedySolver::Init() {
 
 double GreedySolver::SolveGraph() {
   double pseudo_cost = PseudoCost(); // from ExchangeSolver API
-  Condition();
   obj_ = 0;
   unmatched_ = 0;
   n_qty_.clear();
-  
+
+  if (best_first_) {
+    SolveBestFirst();
+    obj_ += unmatched_ * pseudo_cost;
+    return obj_;
+  }
+
+  Condition();
   Init();
  
   std::for_each(graph_->request_groups().begin(),
@@ -145,10 +158,9 @@ void GreedySolver::GreedilySatisfySet(RequestGroup::Ptr prs) {
   double target = prs->qty();
   double match = 0;
 
-  ExchangeNode::Ptr u, v;
   std::vector<Arc>::const_iterator arc_it;
   std::vector<Arc> sorted;
-  double remain, tomatch, excl_val;
+  double remain, tomatch;
 
   CLOG(LEV_DEBUG1) << "Greedy Solving for " << target
                    << " amount of a resource.";
@@ -165,37 +177,10 @@ void GreedySolver::GreedilySatisfySet(RequestGroup::Ptr prs) {
 
       while ((match <= target) && (arc_it != sorted.end())) {
         remain = target - match;
-        const Arc& a = *arc_it;
-        u = a.unode();
-        v = a.vnode();
-        // capacity adjustment
-        tomatch = std::min(remain, Capacity(a, n_qty_[u], n_qty_[v]));
-
-        // exclusivity adjustment
-        if (arc_it->exclusive()) {
-          excl_val = a.excl_val();
-
-          // this careful float comparison is vital for preventing false positive
-          // constraint violations w.r.t. exclusivity-related capacity.
-          double dist = boost::math::float_distance(tomatch, excl_val);
-          if (dist >= float_ulp_eq ) {
-            tomatch = 0;
-          } else {
-            tomatch = excl_val;
-          }
-        }
-
+        tomatch = ToMatch(*arc_it, remain);
         if (tomatch > eps()) {
-          CLOG(LEV_DEBUG1) << "Greedy Solver is matching " << tomatch
-                           << " amount of a resource.";
-          UpdateCapacity(u, a, tomatch);
-          UpdateCapacity(v, a, tomatch);
-          n_qty_[u] += tomatch;
-          n_qty_[v] += tomatch;
-          graph_->AddMatch(a, tomatch);
-
+          Match(*arc_it, tomatch);
           match += tomatch;
-          UpdateObj(tomatch, u->prefs[a]);
         }
         ++arc_it;
       }  // while( (match =< target) && (arc_it != arcs.end()) )
@@ -206,6 +191,177 @@ void GreedySolver::GreedilySatisfySet(RequestGroup::Ptr prs) {
   unmatched_ += target - match;
 }
 
+double GreedySolver::ToMatch(const Arc& a, double remain) {
+  ExchangeNode::Ptr u = a.unode();
+  ExchangeNode::Ptr v = a.vnode();
+  // capacity adjustment
+  double tomatch = std::min(remain, Capacity(a, n_qty_[u], n_qty_[v]));
+  return ExclusiveQty(a, tomatch);
+}
+
+double GreedySolver::ExclusiveQty(const Arc& a, double tomatch) {
+  if (a.exclusive()) {
+    double excl_val = a.excl_val();
+
+    // this careful float comparison is vital for preventing false positive
+    // constraint violations w.r.t. exclusivity-related capacity.
+    double dist = boost::math::float_distance(tomatch, excl_val);
+    if (dist >= float_ulp_eq ) {
+      tomatch = 0;
+    } else {
+      tomatch = excl_val;
+    }
+  }
+  return tomatch;
+}
+
+void GreedySolver::Match(const Arc& a, double qty) {
+  ExchangeNode::Ptr u = a.unode();
+  ExchangeNode::Ptr v = a.vnode();
+  CLOG(LEV_DEBUG1) << "Greedy Solver is matching " << qty
+                   << " amount of a resource.";
+  UpdateCapacity(u, a, qty);
+  UpdateCapacity(v, a, qty);
+  n_qty_[u] += qty;
+  n_qty_[v] += qty;
+  graph_->AddMatch(a, qty);
+  UpdateObj(qty, u->prefs[a]);
+}
+
+namespace {
+
+/// the indices of an arc's nodes and their groups in the flat arrays of the
+/// best-first engine, and the unit capacities of its nodes
+struct BestFirstArc {
+  int node[2];
+  int grp[2];
+  const std::vector<double>* unit_caps[2];
+  double pref;
+};
+
+/// @return the capacity of a node given the remaining capacities of its group
+/// and its remaining quantity (see GreedySolver::Capacity())
+double NodeCap(const std::vector<double>& unit_caps, const double* grp_caps,
+               double node_qty, bool min_cap) {
+  if (unit_caps.size() == 0)
+    return node_qty;
+
+  double max = std::numeric_limits<double>::max();
+  double cap = min_cap ? max : -max;
+  for (int i = 0; i < unit_caps.size(); i++) {
+    // special case for unlimited capacities
+    double c = grp_caps[i] == max ? max : grp_caps[i] / unit_caps[i];
+    cap = min_cap ? std::min(cap, c) : std::max(cap, c);
+  }
+  return std::min(cap, node_qty);
+}
+
+}  // namespace
+
+void GreedySolver::SolveBestFirst() {
+  // index every group and node once, so that matching an arc only reads and
+  // updates flat arrays of remaining capacities and quantities; request
+  // groups come first, so a request group's index is also its index in remain
+  std::vector<RequestGroup::Ptr>& rgs = graph_->request_groups();
+  std::vector<ExchangeNodeGroup::Ptr>& sgs = graph_->supply_groups();
+  std::vector<ExchangeNodeGroup*> grps;
+  for (int i = 0; i != rgs.size(); i++)
+    grps.push_back(rgs[i].get());
+  for (int i = 0; i != sgs.size(); i++)
+    grps.push_back(sgs[i].get());
+
+  std::map<ExchangeNodeGroup*, int> grp_idx;
+  std::vector<int> grp_off;  // offset of each group's capacities in grp_caps
+  std::vector<double> grp_caps;
+  for (int g = 0; g != grps.size(); g++) {
+    grp_idx[grps[g]] = g;
+    grp_off.push_back(grp_caps.size());
+    const std::vector<double>& caps = grps[g]->capacities();
+    grp_caps.insert(grp_caps.end(), caps.begin(), caps.end());
+  }
+
+  std::vector<double> remain;
+  for (int i = 0; i != rgs.size(); i++)
+    remain.push_back(rgs[i]->qty());
+
+  std::vector<Arc>& arcs = graph_->arcs();
+  std::map<ExchangeNode*, int> node_idx;
+  std::vector<double> node_qty;
+  std::vector<BestFirstArc> idx(arcs.size());
+  for (int i = 0; i != arcs.size(); i++) {
+    const Arc& a = arcs[i];
+    ExchangeNode::Ptr n[2] = {a.unode(), a.vnode()};
+    for (int k = 0; k != 2; k++) {
+      std::map<ExchangeNodeGroup*, int>::iterator git =
+          grp_idx.find(n[k]->group);
+      if (git == grp_idx.end()) {
+        throw cyclus::StateError(
+            "An notion of node capacity requires a nodegroup.");
+      }
+      std::map<ExchangeNode*, int>::iterator nit = node_idx.find(n[k].get());
+      if (nit == node_idx.end()) {
+        nit = node_idx.insert(std::make_pair(n[k].get(),
+                                             node_qty.size())).first;
+        node_qty.push_back(n[k]->qty);
+      }
+      idx[i].node[k] = nit->second;
+      idx[i].grp[k] = git->second;
+      idx[i].unit_caps[k] = &n[k]->unit_capacities[a];
+      assert(idx[i].unit_caps[k]->size() == 0 ||
+             idx[i].unit_caps[k]->size() ==
+             n[k]->group->capacities().size());
+    }
+    idx[i].pref = n[0]->prefs[a];
+  }
+
+  // cheapest arc first, ties broken by the arcs' order in the graph
+  typedef std::pair<double, int> Item;
+  std::vector<Item> items;
+  items.reserve(arcs.size());
+  for (int i = 0; i != arcs.size(); i++)
+    items.push_back(Item(ArcCost(arcs[i]), i));
+  std::priority_queue<Item, std::vector<Item>, std::greater<Item> >
+      q(std::greater<Item>(), items);
+
+  double max = std::numeric_limits<double>::max();
+  while (!q.empty()) {
+    int i = q.top().second;
+    q.pop();
+    const BestFirstArc& b = idx[i];
+    double& r = remain[b.grp[0]];
+    if (r <= eps())
+      continue;
+
+    bool min = true;
+    double cap = std::min(
+        NodeCap(*b.unit_caps[0], &grp_caps[grp_off[b.grp[0]]],
+                node_qty[b.node[0]], !min),
+        NodeCap(*b.unit_caps[1], &grp_caps[grp_off[b.grp[1]]],
+                node_qty[b.node[1]], min));
+    double tomatch = ExclusiveQty(arcs[i], std::min(r, cap));
+    if (tomatch <= eps())
+      continue;
+
+    CheckQty(arcs[i].unode(), tomatch);
+    CheckQty(arcs[i].vnode(), tomatch);
+    for (int k = 0; k != 2; k++) {
+      node_qty[b.node[k]] -= tomatch;
+      const std::vector<double>& unit_caps = *b.unit_caps[k];
+      double* caps = &grp_caps[grp_off[b.grp[k]]];
+      for (int j = 0; j < unit_caps.size(); j++) {
+        if (caps[j] != max)
+          caps[j] -= tomatch * unit_caps[j];
+      }
+    }
+    r -= tomatch;
+    graph_->AddMatch(arcs[i], tomatch);
+    UpdateObj(tomatch, b.pref);
+  }
+
+  for (int i = 0; i != rgs.size(); i++)
+    unmatched_ += std::max(0.0, remain[i]);
+}
+
 void GreedySolver::UpdateObj(double qty, double pref) {
   // updates minimizing object (i.e., 1/pref is a cost and the objective is cost
   // * flow)
@@ -214,9 +370,6 @@ void GreedySolver::UpdateObj(double qty, double pref) {
 
 void GreedySolver::UpdateCapacity(ExchangeNode::Ptr n, const Arc& a,
                                   double qty) {
-  using cyclus::IsNegative;
-  using cyclus::ValueError;
-
   std::vector<double>& unit_caps = n->unit_capacities[a];
   std::vector<double>& caps = grp_caps_[n->group];
   assert(unit_caps.size() == caps.size());
@@ -232,6 +385,13 @@ void GreedySolver::UpdateCapacity(ExchangeNode::Ptr n, const Arc& a,
                              << caps[i];
   }
 
+  CheckQty(n, qty);
+}
+
+void GreedySolver::CheckQty(const ExchangeNode::Ptr& n, double qty) {
+  using cyclus::IsNegative;
+  using cyclus::ValueError;
+
   if (IsNegative(n->qty - qty)) {
     std::stringstream ss;
     ss << "A bid for " << n->commod << " was set at " << n->qty
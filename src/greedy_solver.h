@@ -87,6 +87,25 @@ class GreedySolver: public ExchangeSolver {
   /// Initialize member values based on the given graph.
   void Init();
 
+  /// @brief use the best-first matching engine
+  ///
+  /// Rather than satisfying request groups one at a time, the best-first
+  /// engine keeps all arcs of the graph in one priority queue keyed by
+  /// ExchangeSolver::ArcCost() and matches the cheapest remaining arc first,
+  /// across all request groups. Capacities only decrease during a solve, so
+  /// an arc that is popped and cannot be matched (because its request group is
+  /// satisfied or a node has no capacity left) is simply dropped. Each arc is
+  /// considered once, so a solve takes O(arcs log arcs) time rather than
+  /// sorting each request node's arcs in turn. The remaining capacities of
+  /// all nodes and groups are indexed into flat arrays once per solve and
+  /// decremented on each match, rather than recomputed for every arc. The
+  /// preconditioner is not used.
+  /// Default false.
+  /// @{
+  inline void best_first(bool b) { best_first_ = b; }
+  inline bool best_first() const { return best_first_; }
+  /// @}
+
   /// @brief the capacity of the arc
   ///
   /// @throws StateError if either ExchangeNode does not have a ExchangeNodeGroup
@@ -143,7 +162,25 @@ class GreedySolver: public ExchangeSolver {
   /// @param qty the quantity for the node to update
   void GetCaps(ExchangeNodeGroup::Ptr prs);
   void GreedilySatisfySet(RequestGroup::Ptr prs);
+
+  /// @brief the best-first engine (see best_first())
+  void SolveBestFirst();
+
+  /// @return the quantity that can be matched on an arc, given the quantity
+  /// remaining in its request group and its exclusivity
+  double ToMatch(const Arc& a, double remain);
+
+  /// @return the quantity that can be matched on an arc given the quantity
+  /// its capacities allow, which is 0 for an exclusive arc that cannot be
+  /// matched in full
+  double ExclusiveQty(const Arc& a, double tomatch);
+
+  /// @brief matches qty on an arc, updating capacities and the objective
+  void Match(const Arc& a, double qty);
   void UpdateCapacity(ExchangeNode::Ptr n, const Arc& a, double qty);
+
+  /// @throws ValueError if qty exceeds the quantity of a node
+  void CheckQty(const ExchangeNode::Ptr& n, double qty);
   void UpdateObj(double qty, double pref);
   
   GreedyPreconditioner* conditioner_;
@@ -151,6 +188,7 @@ class GreedySolver: public ExchangeSolver {
   std::map<ExchangeNodeGroup*, std::vector<double> > grp_caps_;
   double obj_;
   double unmatched_;
+  bool best_first_;
 };
 
 }  // namespace cyclus
@@ -1738,7 +1738,7 @@ def main_fill_buf():
         write_to_buf = FuncCall(name=Var(name="WriteToBuf"),
                                 targs=[Raw(code=node.db)],
                                 args=[Raw(code="buf+offset"),
-                                      Raw(code="shapes[col]"),
+                                      Raw(code="shape"),
                                       Raw(code="a"), Raw(code="sizes[col]")])
         case_body = ExprStmt(child=write_to_buf)
         output += CPPGEN.visit(case_template(node, case_body))
@@ -1748,21 +1748,15 @@ def main_fill_buf():
 vl_write_vl_string = """hasher_.Clear();
 hasher_.Update({var});
 Digest {key} = hasher_.digest();
-hid_t {keysds} = VLDataset({t.db}, true);
-hid_t {valsds} = VLDataset({t.db}, false);
-if (vlkeys_[{t.db}].count({key}) != 1) {{
-  AppendVLKey({keysds}, {t.db}, {key});
-  InsertVLVal({valsds}, {t.db}, {key}, {var});
+if (!VLHasKey({t.db}, {key})) {{
+  AppendVLVal({t.db}, {key}, {var});
 }}\n"""
 
 vl_write_blob = """hasher_.Clear();
 hasher_.Update({var});
 Digest {key} = hasher_.digest();
-hid_t {keysds} = VLDataset({t.db}, true);
-hid_t {valsds} = VLDataset({t.db}, false);
-if (vlkeys_[{t.db}].count({key}) != 1) {{
-  AppendVLKey({keysds}, {t.db}, {key});
-  InsertVLVal({valsds}, {t.db}, {key}, ({var}).str());
+if (!VLHasKey({t.db}, {key})) {{
+  AppendVLVal({t.db}, {key}, ({var}).str());
 }}\n"""
 
 VL_SPECIAL_TYPES = {"VL_STRING": vl_write_vl_string,
@@ -1772,8 +1766,6 @@ def vl_write(t, variable, depth=0, prefix="", pointer=False):
     """HDF5 Write: Return code previously found in VLWrite."""
     buf_variable = get_variable("buf", depth=depth, prefix=prefix)
     key_variable = get_variable("key", depth=depth, prefix=prefix)
-    keysds_variable = get_variable("keysds", depth=depth, prefix=prefix)
-    valsds_variable = get_variable("valsds", depth=depth, prefix=prefix)
     if pointer:
         variable = "*" + variable
     node_str = ""
@@ -1783,17 +1775,12 @@ def vl_write(t, variable, depth=0, prefix="", pointer=False):
         node_str = """hasher_.Clear();
 hasher_.Update({var});
 Digest {key} = hasher_.digest();
-hid_t {keysds} = VLDataset({t.db}, true);
-hid_t {valsds} = VLDataset({t.db}, false);
-if (vlkeys_[{t.db}].count({key}) != 1) {{
+if (!VLHasKey({t.db}, {key})) {{
   hvl_t {buf} = VLValToBuf({var});
-  AppendVLKey({keysds}, {t.db}, {key});
-  InsertVLVal({valsds}, {t.db}, {key}, {buf});
+  AppendVLVal({t.db}, {key}, {buf});
 }}\n"""
     node = Raw(code=node_str.format(var=variable, no_p_var=variable.strip("*"),
-                                    key=key_variable,
-                                    keysds=keysds_variable, t=t,
-                                    valsds=valsds_variable,
+                                    key=key_variable, t=t,
                                     buf=buf_variable))
     return node
 
@@ -0,0 +1,7 @@
+#include "id_blocks.h"
+
+namespace cyclus {
+
+thread_local IdBlocks* IdBlocks::bound_ = NULL;
+
+}  // namespace cyclus
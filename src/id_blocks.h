@@ -0,0 +1,73 @@
+#ifndef CYCLUS_SRC_ID_BLOCKS_H_
+#define CYCLUS_SRC_ID_BLOCKS_H_
+
+#include <atomic>
+#include <cstddef>
+
+namespace cyclus {
+
+/// @class IdBlocks
+///
+/// @brief IdBlocks are the ranges of resource state, resource object, and
+/// composition ids reserved for one task of a parallel batch (see Timer).
+///
+/// While a task's IdBlocks are bound to the thread running it, new ids are
+/// taken from its ranges rather than from the shared counters, so the ids a
+/// task gets only depend on where its ranges start and not on the order in
+/// which the threads run the tasks. Once a range is used up, further ids come
+/// from the shared counter.
+class IdBlocks {
+ public:
+  /// the id counters that are reserved from
+  enum Counter { STATE, OBJ, COMP, N_COUNTERS };
+
+  IdBlocks() {
+    for (int c = 0; c < N_COUNTERS; ++c) {
+      next_[c] = 0;
+      size_[c] = 0;
+      used_[c] = 0;
+    }
+  }
+
+  /// @brief reserves the n ids from first on for counter c
+  void Reserve(Counter c, int first, int n) {
+    next_[c] = first;
+    size_[c] = n;
+    used_[c] = 0;
+  }
+
+  /// @return the number of ids of counter c taken while these blocks were
+  /// bound, including those taken past the end of the range
+  int used(Counter c) const { return used_[c]; }
+
+  /// @return whether more ids of counter c were taken than were reserved
+  bool overflowed(Counter c) const { return used_[c] > size_[c]; }
+
+  /// @return the next id of counter c, from the blocks bound to the calling
+  /// thread if there are any and from the shared counter otherwise
+  static int Next(Counter c, std::atomic<int>* shared) {
+    IdBlocks* b = bound_;
+    if (b == NULL) {
+      return (*shared)++;
+    }
+    if (b->used_[c]++ < b->size_[c]) {
+      return b->next_[c]++;
+    }
+    return (*shared)++;
+  }
+
+  /// @brief binds b to the calling thread, or unbinds the calling thread's
+  /// blocks if b is NULL
+  static void Bind(IdBlocks* b) { bound_ = b; }
+
+ private:
+  int next_[N_COUNTERS];
+  int size_[N_COUNTERS];
+  int used_[N_COUNTERS];
+
+  static thread_local IdBlocks* bound_;
+};
+
+}  // namespace cyclus
+
+#endif  // CYCLUS_SRC_ID_BLOCKS_H_
@@ -7,23 +7,28 @@
 #include "decayer.h"
 #include "error.h"
 #include "logger.h"
+#include "mem_stats.h"
 
 namespace cyclus {
 
 const ResourceType Material::kType = "Material";
+const int Material::kTag;
 
-Material::~Material() {}
+Material::~Material() {
+  MemStats::Remove(MemStats::MATERIAL, sizeof(Material));
+}
 
 Material::Ptr Material::Create(Agent* creator, double quantity,
                                Composition::Ptr c) {
-  Material::Ptr m(new Material(creator->context(), quantity, c));
+  Material::Ptr m =
+      PoolShared(new Material(creator->context(), quantity, c));
   m->tracker_.Create(creator);
   return m;
 }
 
 Material::Ptr Material::CreateUntracked(double quantity,
                                         Composition::Ptr c) {
-  Material::Ptr m(new Material(NULL, quantity, c));
+  Material::Ptr m = PoolShared(new Material(NULL, quantity, c));
   return m;
 }
 
@@ -37,7 +42,8 @@ const ResourceType Material::type() const {
 
 Resource::Ptr Material::Clone() const {
   Material* m = new Material(*this);
-  Resource::Ptr c(m);
+  MemStats::Add(MemStats::MATERIAL, sizeof(Material));
+  Resource::Ptr c = PoolShared(m);
   m->tracker_.DontTrack();
   return c;
 }
@@ -88,7 +94,7 @@ Material::Ptr Material::ExtractComp(double qty, Composition::Ptr c,
 
   qty_ -= qty;
 
-  Material::Ptr other(new Material(ctx_, qty, c));
+  Material::Ptr other = PoolShared(new Material(ctx_, qty, c));
 
   // Decay called on the extracted material should have the same dt as for
   // this material regardless of composition.
@@ -219,11 +225,13 @@ Composition::Ptr Material::comp() {
 }
 
 Material::Material(Context* ctx, double quantity, Composition::Ptr c)
-    : qty_(quantity),
+    : Resource(kTag),
+      qty_(quantity),
       comp_(c),
       tracker_(ctx, this),
       ctx_(ctx),
       prev_decay_time_(0) {
+  MemStats::Add(MemStats::MATERIAL, sizeof(Material));
   if (ctx != NULL) {
     prev_decay_time_ = ctx->time();
   } else {
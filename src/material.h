@@ -4,6 +4,7 @@
 #include <list>
 #include <boost/shared_ptr.hpp>
 
+#include "block_pool.h"
 #include "composition.h"
 #include "cyc_limits.h"
 #include "resource.h"
@@ -68,12 +69,14 @@ const double ug = kg* .000000001;
 ///   Material::Ptr mox = bucket.ExtractComp(qty, comp);
 ///   @endcode
 ///
-class Material: public Resource {
+class Material final : public Resource, public Pooled<Material> {
   friend class SimInit;
 
  public:
   typedef boost::shared_ptr<Material> Ptr;
   static const ResourceType kType;
+  /// Material is final, so a matching tag means the resource is a Material.
+  static const int kTag = 1;
 
   virtual ~Material();
 
@@ -0,0 +1,95 @@
+#include "mem_stats.h"
+
+#include "context.h"
+#include "recorder.h"
+
+namespace cyclus {
+
+bool MemStats::enabled_ = false;
+std::atomic<long> MemStats::counts_[MemStats::NKINDS];
+std::atomic<long> MemStats::peaks_[MemStats::NKINDS];
+std::atomic<long> MemStats::bytes_[MemStats::NKINDS];
+
+void MemStats::Enable(bool on) {
+  if (on && !enabled_) {
+    for (int k = 0; k < NKINDS; ++k) {
+      counts_[k].store(0, std::memory_order_relaxed);
+      bytes_[k].store(0, std::memory_order_relaxed);
+      peaks_[k].store(0, std::memory_order_relaxed);
+    }
+  }
+  enabled_ = on;
+}
+
+void MemStats::AddExisting(Kind k, long n, long bytes) {
+  if (!enabled_) {
+    return;
+  }
+  long c = counts_[k].fetch_add(n, std::memory_order_relaxed) + n;
+  bytes_[k].fetch_add(n * bytes, std::memory_order_relaxed);
+  if (c > peaks_[k].load(std::memory_order_relaxed)) {
+    peaks_[k].store(c, std::memory_order_relaxed);
+  }
+}
+
+void MemStats::ResetPeaks() {
+  for (int k = 0; k < NKINDS; ++k) {
+    peaks_[k].store(counts_[k].load(std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+  }
+}
+
+std::string MemStats::Name(Kind k) {
+  switch (k) {
+    case COMPOSITION:
+      return "Composition";
+    case MATERIAL:
+      return "Material";
+    case PRODUCT:
+      return "Product";
+    case DATUM:
+      return "Datum";
+    case EXCHANGE_NODE:
+      return "ExchangeNode";
+    case ARC:
+      return "Arc";
+    case DECAY_CHAIN:
+      return "DecayChain";
+    default:
+      return "";
+  }
+}
+
+void MemStats::Record(Context* ctx, Recorder* rec) {
+  // sample everything before recording, which creates Datum objects
+  long counts[NKINDS];
+  long peaks[NKINDS];
+  long bytes[NKINDS];
+  for (int k = 0; k < NKINDS; ++k) {
+    counts[k] = count(static_cast<Kind>(k));
+    peaks[k] = peak(static_cast<Kind>(k));
+    bytes[k] = MemStats::bytes(static_cast<Kind>(k));
+  }
+  int nbuf = rec->buffered();
+  long nbufbytes = rec->buffer_bytes();
+
+  for (int k = 0; k < NKINDS; ++k) {
+    ctx->NewDatum("MemoryStats")
+        ->AddVal("Time", ctx->time())
+        ->AddVal("Object", Name(static_cast<Kind>(k)))
+        ->AddVal("Count", static_cast<int>(counts[k]))
+        ->AddVal("HighWater", static_cast<int>(peaks[k]))
+        ->AddVal("Bytes", static_cast<double>(bytes[k]))
+        ->Record();
+  }
+  ctx->NewDatum("MemoryStats")
+      ->AddVal("Time", ctx->time())
+      ->AddVal("Object", std::string("RecorderBuffer"))
+      ->AddVal("Count", nbuf)
+      ->AddVal("HighWater", nbuf)
+      ->AddVal("Bytes", static_cast<double>(nbufbytes))
+      ->Record();
+  ResetPeaks();
+}
+
+}  // namespace cyclus
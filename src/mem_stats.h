@@ -0,0 +1,117 @@
+#ifndef CYCLUS_SRC_MEM_STATS_H_
+#define CYCLUS_SRC_MEM_STATS_H_
+
+#include <atomic>
+#include <string>
+
+namespace cyclus {
+
+class Context;
+class Recorder;
+
+/// Counts the live objects of the kinds that make up most of the memory of a
+/// simulation, and the bytes they hold. Nothing is counted unless stats are
+/// enabled, which SimInfo::memory_stats does for a simulation, so that the
+/// object lifecycle hooks cost a single branch otherwise. The counts are then
+/// recorded at the end of every timestep in the MemoryStats table, with the
+/// high-water mark of each count during the timestep.
+///
+/// Counts start when stats are enabled: they are the objects created, less
+/// the objects destroyed, since then. Objects that already existed are not
+/// counted, and destroying them while enabled lowers the counts, which may
+/// then drop below zero. Enable stats before the objects of interest are
+/// created, e.g., before a simulation is initialized.
+///
+/// Bytes are estimates: the size of the objects and of the nodes of their
+/// maps, not including allocator overhead.
+///
+/// The recorder's reusable Datum objects are created with the recorder,
+/// usually before stats are enabled, so Timer::Initialize counts them with
+/// AddExisting. Datum counts then include both that buffer and the datums
+/// deferred by parallel agents, while the RecorderBuffer object reports only
+/// the datums buffered for the backends.
+class MemStats {
+ public:
+  /// The kinds of objects that are counted.
+  enum Kind {
+    COMPOSITION = 0,
+    MATERIAL,
+    PRODUCT,
+    DATUM,
+    EXCHANGE_NODE,
+    ARC,
+    DECAY_CHAIN,  ///< compositions cached in decay chains
+    NKINDS,
+  };
+
+  /// Enables or disables counting. Enabling resets the counts, bytes, and
+  /// high-water marks to zero. It must not race with Add or Remove, e.g., it
+  /// must not be called while agents run in parallel.
+  static void Enable(bool on);
+
+  /// @return whether objects are counted
+  static inline bool enabled() { return enabled_; }
+
+  /// Counts a new object of the given kind that holds bytes.
+  static inline void Add(Kind k, long bytes) {
+    if (!enabled_) {
+      return;
+    }
+    long n = counts_[k].fetch_add(1, std::memory_order_relaxed) + 1;
+    bytes_[k].fetch_add(bytes, std::memory_order_relaxed);
+    long peak = peaks_[k].load(std::memory_order_relaxed);
+    while (n > peak && !peaks_[k].compare_exchange_weak(
+                           peak, n, std::memory_order_relaxed)) {}
+  }
+
+  /// Counts n objects of the given kind that hold bytes each and were created
+  /// before counting was enabled, so that destroying them does not drive the
+  /// count below zero.
+  static void AddExisting(Kind k, long n, long bytes);
+
+  /// Uncounts an object of the given kind that held bytes.
+  static inline void Remove(Kind k, long bytes) {
+    if (!enabled_) {
+      return;
+    }
+    counts_[k].fetch_sub(1, std::memory_order_relaxed);
+    bytes_[k].fetch_sub(bytes, std::memory_order_relaxed);
+  }
+
+  /// @return the number of live objects of a kind
+  static inline long count(Kind k) {
+    return counts_[k].load(std::memory_order_relaxed);
+  }
+
+  /// @return the bytes held by the live objects of a kind
+  static inline long bytes(Kind k) {
+    return bytes_[k].load(std::memory_order_relaxed);
+  }
+
+  /// @return the largest count of a kind since the last call to Record (or
+  /// ResetPeaks)
+  static inline long peak(Kind k) {
+    return peaks_[k].load(std::memory_order_relaxed);
+  }
+
+  /// Sets the high-water marks to the current counts.
+  static void ResetPeaks();
+
+  /// @return the name of a kind, as recorded in the Object column
+  static std::string Name(Kind k);
+
+  /// Records the counts, high-water marks, and bytes of every kind, and of
+  /// the buffer of rec, in the MemoryStats table for the current time, and
+  /// then resets the high-water marks.
+  static void Record(Context* ctx, Recorder* rec);
+
+ private:
+  static bool enabled_;
+  static std::atomic<long> counts_[NKINDS];
+  static std::atomic<long> peaks_[NKINDS];
+  static std::atomic<long> bytes_[NKINDS];
+};
+
+}  // namespace cyclus
+
+#endif  // CYCLUS_SRC_MEM_STATS_H_
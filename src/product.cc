@@ -2,10 +2,12 @@
 
 #include "error.h"
 #include "logger.h"
+#include "mem_stats.h"
 
 namespace cyclus {
 
 const ResourceType Product::kType = "Product";
+const int Product::kTag;
 
 std::map<std::string, int> Product::qualids_;
 int Product::next_qualid_ = 1;
@@ -22,7 +24,8 @@ Product::Ptr Product::Create(Agent* creator, double quantity,
   }
 
   // the next lines must come after qual id setting
-  Product::Ptr r(new Product(creator->context(), quantity, quality));
+  Product::Ptr r =
+      PoolShared(new Product(creator->context(), quantity, quality));
   r->tracker_.Create(creator);
   return r;
 }
@@ -30,7 +33,7 @@ Product::Ptr Product::Create(Agent* creator, double quantity,
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Product::Ptr Product::CreateUntracked(double quantity,
                                       std::string quality) {
-  Product::Ptr r(new Product(NULL, quantity, quality));
+  Product::Ptr r = PoolShared(new Product(NULL, quantity, quality));
   r->tracker_.DontTrack();
   return r;
 }
@@ -38,7 +41,8 @@ Product::Ptr Product::CreateUntracked(double quantity,
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Resource::Ptr Product::Clone() const {
   Product* g = new Product(*this);
-  Resource::Ptr c = Resource::Ptr(g);
+  MemStats::Add(MemStats::PRODUCT, sizeof(Product));
+  Resource::Ptr c = PoolShared(g);
   g->tracker_.DontTrack();
   return c;
 }
@@ -62,7 +66,7 @@ Product::Ptr Product::Extract(double quantity) {
 
   quantity_ -= quantity;
 
-  Product::Ptr other(new Product(ctx_, quantity, quality_));
+  Product::Ptr other = PoolShared(new Product(ctx_, quantity, quality_));
   tracker_.Extract(&other->tracker_);
   return other;
 }
@@ -74,9 +78,16 @@ Resource::Ptr Product::ExtractRes(double qty) {
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Product::Product(Context* ctx, double quantity, std::string quality)
-    : quality_(quality),
+    : Resource(kTag),
+      quality_(quality),
       quantity_(quantity),
       tracker_(ctx, this),
-      ctx_(ctx) {}
+      ctx_(ctx) {
+  MemStats::Add(MemStats::PRODUCT, sizeof(Product));
+}
+
+Product::~Product() {
+  MemStats::Remove(MemStats::PRODUCT, sizeof(Product));
+}
 
 }  // namespace cyclus
@@ -3,6 +3,7 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include "block_pool.h"
 #include "context.h"
 #include "resource.h"
 #include "res_tracker.h"
@@ -15,7 +16,7 @@ namespace cyclus {
 /// and is a catch-all for non-standard resources.  It implements the Resource
 /// class interface in a simple way usable for things such as: bananas,
 /// man-hours, water, buying power, etc.
-class Product : public Resource {
+class Product final : public Resource, public Pooled<Product> {
   friend class SimInit;
   friend class ::SimInitTest;
 
@@ -23,6 +24,10 @@ class Product : public Resource {
   typedef
   boost::shared_ptr<Product> Ptr;
   static const ResourceType kType;
+  /// Product is final, so a matching tag means the resource is a Product.
+  static const int kTag = 2;
+
+  virtual ~Product();
 
   /// Creates a new product that is "live" and tracked. creator is a
   /// pointer to the agent creating the resource (usually will be the caller's
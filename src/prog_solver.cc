@@ -1,6 +1,9 @@
 #include "prog_solver.h"
 
+#include <algorithm>
+#include <iostream>
 #include <sstream>
+#include <vector>
 
 #include "context.h"
 #include "prog_translator.h"
@@ -9,6 +12,9 @@
 
 namespace cyclus {
 
+const double ProgSolver::kDefaultTimePerInt = 0.01;
+const double ProgSolver::kMinBudget = 1;
+
 void Report(OsiSolverInterface* iface) {
   std::cout << iface->getNumCols() << " total variables, "
             << iface->getNumIntegers() << " integer.\n";
@@ -16,33 +22,45 @@ void Report(OsiSolverInterface* iface) {
 }
 
 ProgSolver::ProgSolver(std::string solver_t)
-    : solver_t_(solver_t),
+    : ExchangeSolver(false),
+      solver_t_(solver_t),
       tmax_(ProgSolver::kDefaultTimeout),
+      time_per_int_(ProgSolver::kDefaultTimePerInt),
       verbose_(false),
       mps_(false),
-      ExchangeSolver(false) {}
+      warm_start_(false),
+      adaptive_(false) {}
 
 ProgSolver::ProgSolver(std::string solver_t, bool exclusive_orders)
-    : solver_t_(solver_t),
+    : ExchangeSolver(exclusive_orders),
+      solver_t_(solver_t),
       tmax_(ProgSolver::kDefaultTimeout),
+      time_per_int_(ProgSolver::kDefaultTimePerInt),
       verbose_(false),
       mps_(false),
-      ExchangeSolver(exclusive_orders) {}
+      warm_start_(false),
+      adaptive_(false) {}
 
 ProgSolver::ProgSolver(std::string solver_t, double tmax)
-    : solver_t_(solver_t),
+    : ExchangeSolver(false),
+      solver_t_(solver_t),
       tmax_(tmax),
+      time_per_int_(ProgSolver::kDefaultTimePerInt),
       verbose_(false),
       mps_(false),
-      ExchangeSolver(false) {}
+      warm_start_(false),
+      adaptive_(false) {}
 
 ProgSolver::ProgSolver(std::string solver_t, double tmax, bool exclusive_orders,
                        bool verbose, bool mps)
-    : solver_t_(solver_t),
+    : ExchangeSolver(exclusive_orders),
+      solver_t_(solver_t),
       tmax_(tmax),
+      time_per_int_(ProgSolver::kDefaultTimePerInt),
       verbose_(verbose),
       mps_(mps),
-      ExchangeSolver(exclusive_orders) {}
+      warm_start_(false),
+      adaptive_(false) {}
 
 ProgSolver::~ProgSolver() {}
 
@@ -52,18 +70,42 @@ void ProgSolver::WriteMPS() {
   iface_->writeMps(ss.str().c_str());
 }
 
+double ProgSolver::Budget(int n_int) const {
+  return std::min(tmax_, std::max(kMinBudget, time_per_int_ * n_int));
+}
+
+void ProgSolver::RecordStep(int n_int, double budget, double greedy_obj,
+                            double prog_obj) {
+  if (sim_ctx_ == NULL)
+    return;
+  sim_ctx_->NewDatum("ProgSolverSteps")
+      ->AddVal("Time", sim_ctx_->time())
+      ->AddVal("NumCols", iface_->getNumCols())
+      ->AddVal("NumInts", n_int)
+      ->AddVal("Budget", budget)
+      ->AddVal("Path", path_)
+      ->AddVal("GreedyObj", greedy_obj)
+      ->AddVal("ProgObj", prog_obj)
+      ->Record();
+}
+
 double ProgSolver::SolveGraph() {
   SolverFactory sf(solver_t_, tmax_);
   iface_ = sf.get();
+  double ret;
   try {
     // get greedy solution
     GreedySolver greedy(exclusive_orders_);
     double greedy_obj = greedy.Solve(graph_);
+    std::vector<Match> greedy_matches;
+    if (adaptive_)
+      greedy_matches = graph_->matches();
     graph_->ClearMatches();
 
     // translate graph to iface_ instance
     double pseudo_cost = PseudoCost(); // from ExchangeSolver API
     ProgTranslator xlator(graph_, iface_, exclusive_orders_, pseudo_cost);
+    xlator.keys(warm_start_);
     xlator.ToProg();
     if (mps_)
       WriteMPS();
@@ -81,15 +123,59 @@ double ProgSolver::SolveGraph() {
                 << iface_->messageHandler()->logLevel() << "\n";
     }
 
-    // solve and back translate
-    SolveProg(iface_, greedy_obj, verbose_);
+    // map the previous solution onto this program
+    std::vector<double> start;
+    int nmapped = warm_start_ ? ws_.Apply(iface_, xlator.ctx(), &start) : 0;
+    if (verbose_ && warm_start_) {
+      std::cout << "Warm start mapped " << nmapped << " of "
+                << iface_->getNumCols() << " columns\n";
+    }
+
+    // solve, within budget in adaptive mode
+    int n_int = iface_->getNumIntegers();
+    double budget = adaptive_ && n_int > 0 ? Budget(n_int) : -1;
+    bool found = SolveProg(iface_, greedy_obj, verbose_,
+                           nmapped > 0 ? &start[0] : NULL, budget);
+
+    // the prog's objective, as the interface may not have evaluated it
+    double prog_obj = iface_->getInfinity();
+    if (found) {
+      const double* objs = iface_->getObjCoefficients();
+      const double* sol = iface_->getColSolution();
+      prog_obj = 0;
+      for (int i = 0; i != iface_->getNumCols(); i++)
+        prog_obj += objs[i] * sol[i];
+    }
 
-    xlator.FromProg();
+    if (n_int == 0) {
+      path_ = "lp";
+    } else if (adaptive_ && !(found && prog_obj < greedy_obj)) {
+      path_ = "greedy";
+    } else {
+      path_ = "milp";
+    }
+    if (verbose_)
+      std::cout << "Taking the " << path_ << " solution\n";
+
+    // back translate
+    if (path_ == "greedy") {
+      for (int i = 0; i != greedy_matches.size(); i++)
+        graph_->AddMatch(greedy_matches[i].first, greedy_matches[i].second);
+      ret = greedy_obj;
+    } else {
+      xlator.FromProg();
+      if (warm_start_) {
+        int t = sim_ctx_ != NULL ? sim_ctx_->time() : 0;
+        ws_.Store(iface_, xlator.ctx(), t, n_int == 0);
+      }
+      ret = iface_->getObjValue();
+    }
+    if (adaptive_)
+      RecordStep(n_int, budget, greedy_obj, prog_obj);
   } catch(...) {
     delete iface_;
     throw;
   }
-  double ret = iface_->getObjValue();
   delete iface_;
   return ret;
 }
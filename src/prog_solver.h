@@ -9,6 +9,7 @@
 
 #include "exchange_graph.h"
 #include "exchange_solver.h"
+#include "prog_warm_start.h"
 
 namespace cyclus {
 
@@ -19,6 +20,8 @@ class ExchangeGraph;
 class ProgSolver: public ExchangeSolver {
  public:
   static const int kDefaultTimeout = 5 * 60; // 5 * 60 s/min == 5 minutes
+  static const double kDefaultTimePerInt;  // 0.01 s per integer variable
+  static const double kMinBudget;  // 1 s
 
   /// @param solver_t the solver type, either "cbc" or "clp"
   /// @param tmax the maximum solution time, default kDefaultTimeout
@@ -35,6 +38,47 @@ class ProgSolver: public ExchangeSolver {
   /// @}
   virtual ~ProgSolver();
 
+  /// @brief reuse the previous exchange's solution as a starting point
+  ///
+  /// If set, the solution of each solve, and its basis if the program was an
+  /// LP, are kept and mapped onto the next exchange's program by request and
+  /// bid identity (see ProgKey).
+  /// The mapped basis warm starts the LP relaxation and the mapped solution is
+  /// offered to cbc as an initial incumbent. Default false.
+  /// @{
+  inline void warm_start(bool w) {
+    warm_start_ = w;
+    if (!w)
+      ws_.Clear();
+  }
+  inline bool warm_start() const { return warm_start_; }
+  /// @}
+
+  /// @brief cap each exchange's solution time by its difficulty
+  ///
+  /// If set, a program with integer variables may use at most
+  /// max(kMinBudget, time_per_int * (number of integer variables)) seconds,
+  /// and never more than tmax. The greedy solution, which is computed first
+  /// regardless, is kept unless the MILP solver finds a better one in that
+  /// time. The path each solve takes is recorded in the ProgSolverSteps
+  /// table. Default false.
+  /// @{
+  inline void adaptive(bool a) { adaptive_ = a; }
+  inline bool adaptive() const { return adaptive_; }
+  /// @}
+
+  /// @brief the seconds of solution time allowed per integer variable in
+  /// adaptive mode, default kDefaultTimePerInt
+  /// @{
+  inline void time_per_int(double t) { time_per_int_ = t; }
+  inline double time_per_int() const { return time_per_int_; }
+  /// @}
+
+  /// @return the path the last solve took: "lp" if the program had no integer
+  /// variables, "milp" if the MILP solution was used, and "greedy" if the
+  /// greedy solution was kept
+  inline const std::string& path() const { return path_; }
+
  protected:
   /// @brief the ProgSolver solves an ExchangeGraph...
   virtual double SolveGraph();
@@ -42,10 +86,20 @@ class ProgSolver: public ExchangeSolver {
  private:
   void WriteMPS();
 
+  /// @return the time limit of a program with n_int integer variables
+  double Budget(int n_int) const;
+
+  /// records the path taken by the last solve
+  void RecordStep(int n_int, double budget, double greedy_obj,
+                  double prog_obj);
+
   std::string solver_t_;
+  std::string path_;
   double tmax_;
-  bool verbose_, mps_;
+  double time_per_int_;
+  bool verbose_, mps_, warm_start_, adaptive_;
   OsiSolverInterface* iface_;
+  ProgWarmStart ws_;
 };
 
 }  // namespace cyclus
@@ -2,7 +2,6 @@
 
 #include <algorithm>
 
-#include "CoinPackedVector.hpp"
 #include "OsiSolverInterface.hpp"
 
 #include "cyc_limits.h"
@@ -13,11 +12,40 @@
 
 namespace cyclus {
 
+bool operator<(const ProgKey& lhs, const ProgKey& rhs) {
+  if (lhs.kind != rhs.kind)
+    return lhs.kind < rhs.kind;
+  if (lhs.u != rhs.u)
+    return lhs.u < rhs.u;
+  if (lhs.v != rhs.v)
+    return lhs.v < rhs.v;
+  if (lhs.index != rhs.index)
+    return lhs.index < rhs.index;
+  if (lhs.ordinal != rhs.ordinal)
+    return lhs.ordinal < rhs.ordinal;
+  return lhs.commod < rhs.commod;
+}
+
+bool operator==(const ProgKey& lhs, const ProgKey& rhs) {
+  return lhs.kind == rhs.kind && lhs.u == rhs.u && lhs.v == rhs.v &&
+         lhs.index == rhs.index && lhs.ordinal == rhs.ordinal &&
+         lhs.commod == rhs.commod;
+}
+
+std::size_t ProgKeyHash::operator()(const ProgKey& k) const {
+  std::size_t h = std::hash<std::string>()(k.commod);
+  int vals[] = {k.kind, k.u, k.v, k.index, k.ordinal};
+  for (int i = 0; i != 5; i++)
+    h = h * 31 + std::hash<int>()(vals[i]);
+  return h;
+}
+
 ProgTranslator::ProgTranslator(ExchangeGraph* g, OsiSolverInterface* iface)
     : g_(g),
       iface_(iface),
       excl_(false),
-      pseudo_cost_(std::numeric_limits<double>::max()) {
+      pseudo_cost_(std::numeric_limits<double>::max()),
+      keys_(false) {
   Init();
 }
 
@@ -26,7 +54,8 @@ ProgTranslator::ProgTranslator(ExchangeGraph* g, OsiSolverInterface* iface,
     : g_(g),
       iface_(iface),
       excl_(exclusive),
-      pseudo_cost_(std::numeric_limits<double>::max()) {
+      pseudo_cost_(std::numeric_limits<double>::max()),
+      keys_(false) {
   Init();
 }
 
@@ -35,7 +64,8 @@ ProgTranslator::ProgTranslator(ExchangeGraph* g, OsiSolverInterface* iface,
     : g_(g),
       iface_(iface),
       excl_(false),
-      pseudo_cost_(pseudo_cost) {
+      pseudo_cost_(pseudo_cost),
+      keys_(false) {
   Init();
 }
 
@@ -44,7 +74,8 @@ ProgTranslator::ProgTranslator(ExchangeGraph* g, OsiSolverInterface* iface,
     : g_(g),
       iface_(iface),
       excl_(exclusive),
-      pseudo_cost_(pseudo_cost) {
+      pseudo_cost_(pseudo_cost),
+      keys_(false) {
   Init();
 }
 
@@ -54,7 +85,14 @@ void ProgTranslator::Init() {
   ctx_.obj_coeffs.resize(n_cols);
   ctx_.col_ubs.resize(n_cols);
   ctx_.col_lbs.resize(n_cols);
-  ctx_.m = CoinPackedMatrix(false, 0, 0);
+  ctx_.m = CoinPackedMatrix(true, 0, 0);
+}
+
+ProgKey ProgTranslator::Key_(int kind, int u, int v, const std::string& commod,
+                             int index) {
+  ProgKey k(kind, u, v, commod, index);
+  k.ordinal = key_counts_[k]++;
+  return k;
 }
 
 void ProgTranslator::CheckPref(double pref) {
@@ -76,10 +114,26 @@ void ProgTranslator::Translate() {
   for (int i = 0; i != g_->request_groups().size(); ++i)
     nfalse += rgs[i].get()->HasArcs() ? 1 : 0;
   int n_cols = g_->arcs().size() + nfalse;
-  ctx_.m.setDimensions(0, n_cols);
 
-  bool request;
+  // reserve all row and coefficient storage before filling any of it
   std::vector<ExchangeNodeGroup::Ptr>& sgs = g_->supply_groups();
+  int n_rows = 0;
+  int n_coeffs = 0;
+  for (int i = 0; i != sgs.size(); i++)
+    Count_(sgs[i].get(), false, &n_rows, &n_coeffs);
+  for (int i = 0; i != rgs.size(); i++)
+    Count_(rgs[i].get(), true, &n_rows, &n_coeffs);
+  ctx_.row_lbs.reserve(n_rows);
+  ctx_.row_ubs.reserve(n_rows);
+  if (keys_) {
+    ctx_.col_keys.resize(ctx_.col_lbs.size());
+    ctx_.row_keys.reserve(n_rows);
+  }
+  coeff_rows_.reserve(n_coeffs);
+  coeff_cols_.reserve(n_coeffs);
+  coeff_vals_.reserve(n_coeffs);
+
+  bool request;
   for (int i = 0; i != sgs.size(); i++) {
     request = false;
     XlateGrp_(sgs[i].get(), request);
@@ -90,6 +144,33 @@ void ProgTranslator::Translate() {
     XlateGrp_(rgs[i].get(), request);
   }
 
+  // assemble the column-ordered matrix in one step, which is the layout the
+  // solver uses internally, then release the triplets
+  int n = coeff_vals_.size();
+  if (n > 0) {
+    ctx_.m = CoinPackedMatrix(true, &coeff_rows_[0], &coeff_cols_[0],
+                              &coeff_vals_[0], n);
+  }
+  ctx_.m.setDimensions(ctx_.row_lbs.size(), n_cols);
+  std::vector<int>().swap(coeff_rows_);
+  std::vector<int>().swap(coeff_cols_);
+  std::vector<double>().swap(coeff_vals_);
+  CLOG(LEV_DEBUG1) << "Assembled a " << ctx_.m.getNumRows() << "x"
+                   << ctx_.m.getNumCols() << " constraint matrix with " << n
+                   << " coefficients.";
+
+  // name each arc by its requester, bidder, and commodity (in arc order, which
+  // is deterministic, unlike the node-level maps)
+  if (keys_) {
+    std::vector<Arc>& arcs = g_->arcs();
+    for (int i = 0; i != arcs.size(); i++) {
+      const Arc& a = arcs[i];
+      ExchangeNode::Ptr u = a.unode();
+      ctx_.col_keys[g_->arc_ids()[a]] =
+          Key_(ProgKey::ARC, u->agent_id, a.vnode()->agent_id, u->commod, 0);
+    }
+  }
+
   // add each false arc
   CLOG(LEV_DEBUG1) << "Adding " << arc_offset_ - g_->arcs().size()
                    << " false arcs.";
@@ -132,14 +213,15 @@ void ProgTranslator::XlateGrp_(ExchangeNodeGroup* grp, bool request) {
 
   if (request && !grp->HasArcs())
     return; // no arcs, no reason to add variables/constraints
-  
-  std::vector<CoinPackedVector> cap_rows;
-  std::vector<CoinPackedVector> excl_rows;
-  for (int i = 0; i != caps.size(); i++) {
-    cap_rows.push_back(CoinPackedVector());
-  }
 
+  // capacity constraint j of this group is row row0 + j
+  int row0 = ctx_.row_lbs.size();
   std::vector<ExchangeNode::Ptr>& nodes = grp->nodes();
+  int agent_id = nodes.empty() ? -1 : nodes[0]->agent_id;
+  static const std::string none;
+  const std::string& commod = nodes.empty() ? none : nodes[0]->commod;
+  int u = request ? agent_id : -1;
+  int v = request ? -1 : agent_id;
   for (int i = 0; i != nodes.size(); i++) {
     std::map<Arc, std::vector<double> >& ucap_map = nodes[i]->unit_capacities;
     std::map<Arc, std::vector<double> >::iterator cap_it;
@@ -157,7 +239,7 @@ void ProgTranslator::XlateGrp_(ExchangeNodeGroup* grp, bool request) {
           coeff *= a.excl_val();
         }
 
-        cap_rows[j].insert(arc_id, coeff);
+        AddCoeff_(row0 + j, arc_id, coeff);
       }
 
       if (request) {
@@ -173,12 +255,14 @@ void ProgTranslator::XlateGrp_(ExchangeNodeGroup* grp, bool request) {
   int faux_id;
   if (request) {
     faux_id = arc_offset_++;
+    if (keys_)
+      ctx_.col_keys[faux_id] = Key_(ProgKey::FAUX, u, v, commod, 0);
   }
 
   // add all capacity rows
-  for (int i = 0; i != cap_rows.size(); i++) {
+  for (int i = 0; i != caps.size(); i++) {
     if (request) {
-      cap_rows[i].insert(faux_id, 1.0);  // faux arc
+      AddCoeff_(row0 + i, faux_id, 1.0);  // faux arc
     }
 
     // 1e15 is the largest value that doesn't make the solver fall over
@@ -186,32 +270,66 @@ void ProgTranslator::XlateGrp_(ExchangeNodeGroup* grp, bool request) {
     double rlb = std::min(caps[i], 1e15); 
     ctx_.row_lbs.push_back(request ? rlb : 0);
     ctx_.row_ubs.push_back(request ? inf : caps[i]);
-    ctx_.m.appendRow(cap_rows[i]);
+    if (keys_) {
+      ctx_.row_keys.push_back(
+          Key_(request ? ProgKey::REQ_CAP : ProgKey::SUP_CAP, u, v, commod, i));
+    }
   }
 
   if (excl_) {
-    // add exclusive arcs
+    // add exclusive arcs, one row per group that has any
     std::vector< std::vector<ExchangeNode::Ptr> >& exngs =
         grp->excl_node_groups();
     for (int i = 0; i != exngs.size(); i++) {
-      CoinPackedVector excl_row;
+      int row = ctx_.row_lbs.size();
+      int n = 0;
       std::vector<ExchangeNode::Ptr>& nodes = exngs[i];
       for (int j = 0; j != nodes.size(); j++) {
         std::vector<Arc>& arcs = g_->node_arc_map()[nodes[j]];
-        for (int k = 0; k != arcs.size(); k++) {
-          excl_row.insert(g_->arc_ids()[arcs[k]], 1.0);
+        for (int k = 0; k != arcs.size(); k++, n++) {
+          AddCoeff_(row, g_->arc_ids()[arcs[k]], 1.0);
         }
       }
-      if (excl_row.getNumElements() > 0) {
-        excl_rows.push_back(excl_row);
+      if (n > 0) {
+        ctx_.row_lbs.push_back(0.0);
+        ctx_.row_ubs.push_back(1.0);
+        if (keys_) {
+          ctx_.row_keys.push_back(
+              Key_(request ? ProgKey::REQ_EXCL : ProgKey::SUP_EXCL, u, v,
+                   commod, i));
+        }
       }
     }
+  }
+}
 
-    // add all exclusive rows
-    for (int i = 0; i != excl_rows.size(); i++) {
-      ctx_.row_lbs.push_back(0.0);
-      ctx_.row_ubs.push_back(1.0);
-      ctx_.m.appendRow(excl_rows[i]);
+void ProgTranslator::Count_(ExchangeNodeGroup* grp, bool request, int* n_rows,
+                            int* n_coeffs) {
+  if (request && !grp->HasArcs())
+    return;
+
+  int n_caps = grp->capacities().size();
+  *n_rows += n_caps;
+  *n_coeffs += request ? n_caps : 0;  // faux arc
+
+  std::vector<ExchangeNode::Ptr>& nodes = grp->nodes();
+  for (int i = 0; i != nodes.size(); i++) {
+    std::map<Arc, std::vector<double> >& ucap_map = nodes[i]->unit_capacities;
+    std::map<Arc, std::vector<double> >::iterator cap_it;
+    for (cap_it = ucap_map.begin(); cap_it != ucap_map.end(); ++cap_it) {
+      *n_coeffs += cap_it->second.size();
+    }
+  }
+
+  if (excl_) {
+    // an upper bound; groups without arcs do not get a row
+    std::vector< std::vector<ExchangeNode::Ptr> >& exngs =
+        grp->excl_node_groups();
+    *n_rows += exngs.size();
+    for (int i = 0; i != exngs.size(); i++) {
+      for (int j = 0; j != exngs[i].size(); j++) {
+        *n_coeffs += g_->node_arc_map()[exngs[i][j]].size();
+      }
     }
   }
 }
@@ -3,6 +3,9 @@
 #include "platform.h"
 #if CYCLUS_HAS_COIN
 
+#include <map>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "CoinPackedMatrix.hpp"
@@ -14,6 +17,48 @@ namespace cyclus {
 class ExchangeGraph;
 class ExchangeNodeGroup;
 
+/// @brief a stable identity for a column or row of a translated program
+///
+/// Column and row indices change from exchange to exchange as traders come and
+/// go, but the agents and commodities that generate them usually do not. A
+/// ProgKey names a variable or constraint by the requester (u) and bidder (v)
+/// agent ids, the commodity, and a positional index (e.g., the constraint
+/// number within a group), so that solver state from a previous exchange can be
+/// mapped onto the current one. The ordinal disambiguates otherwise identical
+/// keys in translation order.
+struct ProgKey {
+  enum Kind {
+    ARC,       ///< a request-bid arc
+    FAUX,      ///< the faux (unmet demand) arc of a request group
+    REQ_CAP,   ///< a request group capacity constraint
+    SUP_CAP,   ///< a supply group capacity constraint
+    REQ_EXCL,  ///< a request group exclusivity constraint
+    SUP_EXCL,  ///< a supply group exclusivity constraint
+  };
+
+  ProgKey() : kind(ARC), u(-1), v(-1), index(0), ordinal(0) {}
+  ProgKey(int kind, int u, int v, const std::string& commod, int index)
+      : kind(kind), u(u), v(v), commod(commod), index(index), ordinal(0) {}
+
+  int kind;
+  int u;
+  int v;
+  std::string commod;
+  int index;
+  int ordinal;
+};
+
+/// @brief ProgKey comparison operator, allows usage in ordered containers
+bool operator<(const ProgKey& lhs, const ProgKey& rhs);
+
+/// @brief ProgKey equality operator, allows usage in hashed containers
+bool operator==(const ProgKey& lhs, const ProgKey& rhs);
+
+/// @brief a hash of all fields of a ProgKey
+struct ProgKeyHash {
+  std::size_t operator()(const ProgKey& k) const;
+};
+
 /// @brief struct to hold all problem instance state
 struct ProgTranslatorContext {
   std::vector<double> obj_coeffs;
@@ -21,7 +66,16 @@ struct ProgTranslatorContext {
   std::vector<double> row_lbs;
   std::vector<double> col_ubs;
   std::vector<double> col_lbs;
+  /// the constraint matrix, column-ordered when built by a ProgTranslator
   CoinPackedMatrix m;
+
+  /// stable identities of each column and row, indexed like the vectors
+  /// above, or empty if the translator does not build keys (see
+  /// ProgTranslator::keys())
+  /// @{
+  std::vector<ProgKey> col_keys;
+  std::vector<ProgKey> row_keys;
+  /// @}
 };
 
 /// a helper class to translate a product exchange into a mathematical
@@ -72,6 +126,14 @@ class ProgTranslator {
 
   const ProgTranslatorContext& ctx() const { return ctx_; }
 
+  /// @brief whether Translate() names each column and row by a ProgKey in
+  /// ctx().col_keys and ctx().row_keys, which only a warm start needs.
+  /// Default false, which leaves the key vectors empty.
+  /// @{
+  inline void keys(bool b) { keys_ = b; }
+  inline bool keys() const { return keys_; }
+  /// @}
+
  private:
   void Init();
 
@@ -83,12 +145,37 @@ class ProgTranslator {
   /// @param req a boolean flag, true if grp is a request group
   void XlateGrp_(ExchangeNodeGroup* grp, bool req);
 
+  /// @brief counts the rows and nonzero coefficients XlateGrp_ will add for a
+  /// node group, so that storage can be reserved up front
+  void Count_(ExchangeNodeGroup* grp, bool req, int* n_rows, int* n_coeffs);
+
+  /// @brief adds a constraint matrix coefficient
+  inline void AddCoeff_(int row, int col, double val) {
+    coeff_rows_.push_back(row);
+    coeff_cols_.push_back(col);
+    coeff_vals_.push_back(val);
+  }
+
+  /// @return a key for the given identity, with its ordinal set to the number
+  /// of identical keys already issued by this translator
+  ProgKey Key_(int kind, int u, int v, const std::string& commod, int index);
+
   ExchangeGraph* g_;
   OsiSolverInterface* iface_;
   bool excl_;
   int arc_offset_;
   ProgTranslatorContext ctx_;
   double pseudo_cost_;
+  bool keys_;
+  std::unordered_map<ProgKey, int, ProgKeyHash> key_counts_;
+
+  /// constraint matrix coefficients as (row, column, value) triplets,
+  /// assembled into ctx_.m in one step at the end of Translate()
+  /// @{
+  std::vector<int> coeff_rows_;
+  std::vector<int> coeff_cols_;
+  std::vector<double> coeff_vals_;
+  /// @}
 };
 
 }  // namespace cyclus
@@ -0,0 +1,137 @@
+#include "prog_warm_start.h"
+
+#include <algorithm>
+
+#include "CoinWarmStartBasis.hpp"
+#include "OsiSolverInterface.hpp"
+
+#include "logger.h"
+
+namespace cyclus {
+
+typedef CoinWarmStartBasis::Status Status;
+
+ProgWarmStart::ProgWarmStart() {}
+
+void ProgWarmStart::Clear() {
+  cols_.clear();
+  rows_.clear();
+}
+
+void ProgWarmStart::Store(OsiSolverInterface* iface,
+                          const ProgTranslatorContext& ctx, int time,
+                          bool basis) {
+  int ncols = std::min<int>(iface->getNumCols(), ctx.col_keys.size());
+  int nrows = std::min<int>(iface->getNumRows(), ctx.row_keys.size());
+  const double* sol = iface->getColSolution();
+
+  // the basis is only available (and meaningful) if the last solve was an LP
+  // on iface itself
+  CoinWarmStart* ws = basis ? iface->getWarmStart() : NULL;
+  CoinWarmStartBasis* b = dynamic_cast<CoinWarmStartBasis*>(ws);
+  bool has_basis = b != NULL &&
+                   b->getNumStructural() == iface->getNumCols() &&
+                   b->getNumArtificial() == iface->getNumRows();
+
+  for (int i = 0; i != ncols; i++) {
+    Entry& e = cols_[ctx.col_keys[i]];
+    e.val = sol[i];
+    e.status = has_basis ? b->getStructStatus(i) :
+                           CoinWarmStartBasis::atLowerBound;
+    e.time = time;
+  }
+
+  for (int i = 0; i != nrows; i++) {
+    Entry& e = rows_[ctx.row_keys[i]];
+    e.status = has_basis ? b->getArtifStatus(i) :
+                           CoinWarmStartBasis::basic;
+    e.time = time;
+  }
+
+  delete ws;
+  Prune(time);
+}
+
+int ProgWarmStart::Apply(OsiSolverInterface* iface,
+                         const ProgTranslatorContext& ctx,
+                         std::vector<double>* sol) {
+  int ncols = iface->getNumCols();
+  int nrows = iface->getNumRows();
+  const double* lbs = iface->getColLower();
+  const double* ubs = iface->getColUpper();
+  double inf = iface->getInfinity();
+  sol->assign(lbs, lbs + ncols);
+  if (cols_.empty())
+    return 0;
+
+  CoinWarmStartBasis basis;
+  basis.setSize(ncols, nrows);
+  std::map<ProgKey, Entry>::iterator it;
+  int nmapped = 0;
+  int nbasic = 0;
+
+  for (int i = 0; i != ncols; i++) {
+    Status st = CoinWarmStartBasis::atLowerBound;
+    if (i < ctx.col_keys.size() &&
+        (it = cols_.find(ctx.col_keys[i])) != cols_.end()) {
+      (*sol)[i] = std::max(lbs[i], std::min(ubs[i], it->second.val));
+      st = static_cast<Status>(it->second.status);
+      if (st == CoinWarmStartBasis::atUpperBound && ubs[i] >= inf)
+        st = CoinWarmStartBasis::atLowerBound;
+      ++nmapped;
+    }
+    nbasic += st == CoinWarmStartBasis::basic ? 1 : 0;
+    basis.setStructStatus(i, st);
+  }
+
+  if (nmapped == 0)
+    return 0;
+
+  for (int i = 0; i != nrows; i++) {
+    Status st = CoinWarmStartBasis::basic;
+    if (i < ctx.row_keys.size() &&
+        (it = rows_.find(ctx.row_keys[i])) != rows_.end()) {
+      st = static_cast<Status>(it->second.status);
+    }
+    nbasic += st == CoinWarmStartBasis::basic ? 1 : 0;
+    basis.setArtifStatus(i, st);
+  }
+
+  // a valid basis has exactly one basic variable per row. Columns that left
+  // the program may have taken basic slots with them and new columns may
+  // compete for them, so demote structurals (newest first) or promote slacks
+  // until the count is right.
+  for (int i = ncols - 1; i >= 0 && nbasic > nrows; i--) {
+    if (basis.getStructStatus(i) == CoinWarmStartBasis::basic) {
+      basis.setStructStatus(i, CoinWarmStartBasis::atLowerBound);
+      --nbasic;
+    }
+  }
+  for (int i = 0; i != nrows && nbasic < nrows; i++) {
+    if (basis.getArtifStatus(i) != CoinWarmStartBasis::basic) {
+      basis.setArtifStatus(i, CoinWarmStartBasis::basic);
+      ++nbasic;
+    }
+  }
+
+  iface->setWarmStart(&basis);
+  CLOG(LEV_DEBUG1) << "Warm start mapped " << nmapped << " of " << ncols
+                   << " columns.";
+  return nmapped;
+}
+
+void ProgWarmStart::Prune(int time) {
+  std::map<ProgKey, Entry>* maps[] = {&cols_, &rows_};
+  for (int i = 0; i != 2; i++) {
+    std::map<ProgKey, Entry>::iterator it = maps[i]->begin();
+    while (it != maps[i]->end()) {
+      if (time - it->second.time >= kMaxAge) {
+        maps[i]->erase(it++);
+      } else {
+        ++it;
+      }
+    }
+  }
+}
+
+}  // namespace cyclus
@@ -0,0 +1,84 @@
+#ifndef CYCLUS_SRC_PROG_WARM_START_H_
+#define CYCLUS_SRC_PROG_WARM_START_H_
+#include "platform.h"
+#if CYCLUS_HAS_COIN
+
+#include <map>
+#include <vector>
+
+#include "prog_translator.h"
+
+class OsiSolverInterface;
+
+namespace cyclus {
+
+/// @brief ProgWarmStart carries the solution of one exchange program over to
+/// the next.
+///
+/// After a program is solved, Store() records each column's value and basis
+/// status, and each row's basis status, by the column's or row's ProgKey. When
+/// the next program has been populated, Apply() maps the stored state onto it
+/// by key, installs the mapped basis on the solver interface, and provides the
+/// mapped column values as a candidate starting solution. Columns and rows
+/// without a match start at their lower bound and as slacks, respectively.
+///
+/// Entries that have not been stored for kMaxAge timesteps are dropped, so
+/// that the state for exchanges of different resource types, which are solved
+/// in the same timestep, can be kept in the same object without growing
+/// without bound.
+class ProgWarmStart {
+ public:
+  /// the number of timesteps an entry survives without being refreshed
+  static const int kMaxAge = 4;
+
+  ProgWarmStart();
+
+  /// @brief records the solution state of a solved program
+  /// @param iface the solver interface holding the solution
+  /// @param ctx the translation context used to build the program
+  /// @param time the timestep of the exchange
+  /// @param basis whether iface holds the basis of its solution. A MILP is
+  /// solved by cbc on a copy of the interface, so afterwards the interface
+  /// only holds the solution, and its basis is stale; the columns and rows
+  /// are then stored at their bounds and as slacks, respectively.
+  void Store(OsiSolverInterface* iface, const ProgTranslatorContext& ctx,
+             int time, bool basis);
+
+  /// @brief maps stored state onto a populated (but unsolved) program
+  ///
+  /// @param iface the solver interface holding the program
+  /// @param ctx the translation context used to build the program
+  /// @param sol filled with the mapped column values, one per column
+  /// @return the number of columns that were mapped
+  int Apply(OsiSolverInterface* iface, const ProgTranslatorContext& ctx,
+            std::vector<double>* sol);
+
+  /// @brief forgets all stored state
+  void Clear();
+
+  /// @return the number of stored column entries
+  inline int ncols() const { return cols_.size(); }
+
+  /// @return the number of stored row entries
+  inline int nrows() const { return rows_.size(); }
+
+ private:
+  struct Entry {
+    Entry() : val(0), status(0), time(0) {}
+    double val;
+    int status;
+    /// the timestep the entry was last stored
+    int time;
+  };
+
+  /// drops the entries not stored in the kMaxAge timesteps before time
+  void Prune(int time);
+
+  std::map<ProgKey, Entry> cols_;
+  std::map<ProgKey, Entry> rows_;
+};
+
+}  // namespace cyclus
+
+#endif  // CYCLUS_HAS_COIN
+#endif  // CYCLUS_SRC_PROG_WARM_START_H_
@@ -1,6 +1,10 @@
 #ifndef CYCLUS_SRC_QUERY_BACKEND_H_
 #define CYCLUS_SRC_QUERY_BACKEND_H_
 
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
 #include <climits>
 #include <list>
 #include <map>
@@ -611,7 +615,7 @@ inline bool CmpConds(T* x, std::vector<Cond*>* conds) {
 /// This class is a hack around a language deficiency in C++. You cannot pass
 /// around an array (unsinged int[5]) between function calls. You can only
 /// pass pointers, which would involve lost of new/free and heap shenanigans
-/// that are not needed for a dumb container. Therefore Sha1::Digest() cannot
+/// that are not needed for a dumb container. Therefore Hasher::digest() cannot
 /// return what would be most natural. The second most natural thing would be
 /// a std::array<unsigned int, 5>. However, std::array is a C++11 feature and
 /// we are not yet ready to go down that road.
@@ -683,277 +687,303 @@ class Digest {
   }
 };
 
-class Sha1 {
+/// Computes the content digests of variable length values.
+///
+/// Two algorithms are available. SHA1 is the cryptographic hash that older
+/// databases were keyed with. MURMUR3 is MurmurHash3 (x64, 128 bit), which is
+/// not cryptographic but is many times faster; its 128 bit hash fills the
+/// first four ints of the digest and the length of the hashed data, the last.
+/// Either is well beyond collision range for the number of values a
+/// simulation records.
+class Hasher {
  public:
-  Sha1() { hash_ = boost::uuids::detail::sha1(); }
+  /// The hash algorithms that may compute a digest.
+  enum Algorithm {
+    SHA1 = 0,
+    MURMUR3 = 1
+  };
+
+  Hasher(Algorithm algorithm = SHA1) : algorithm_(algorithm) {
+    hash_ = boost::uuids::detail::sha1();
+    Clear();
+  }
+
+  /// @return the algorithm used by this hasher
+  inline Algorithm algorithm() const { return algorithm_; }
 
   /// Clears the current hash value to its default state.
-  inline void Clear() { hash_.reset(); }
+  inline void Clear() {
+    hash_.reset();
+    h1_ = 0;
+    h2_ = 0;
+    len_ = 0;
+    ntail_ = 0;
+  }
 
   /// Updates the hash value in-place.
   /// \{
   inline void Update(const std::string& s) {
-    hash_.process_bytes(s.c_str(), s.size());
+    Process(s.c_str(), s.size());
   }
 
   inline void Update(const Blob& b) { Update(b.str()); }
 
   inline void Update(const std::vector<int>& x) {
-    hash_.process_bytes(&x[0], x.size() * sizeof(int));
+    Process(&x[0], x.size() * sizeof(int));
   }
 
   inline void Update(const std::vector<float>& x) {
-    hash_.process_bytes(&x[0], x.size() * sizeof(float));
+    Process(&x[0], x.size() * sizeof(float));
   }
 
   inline void Update(const std::vector<double>& x) {
-    hash_.process_bytes(&x[0], x.size() * sizeof(double));
+    Process(&x[0], x.size() * sizeof(double));
   }
 
   inline void Update(const std::vector<std::string>& x) {
     for (unsigned int i = 0; i < x.size(); ++i)
-      hash_.process_bytes(x[i].c_str(), x[i].size());
+      Process(x[i].c_str(), x[i].size());
   }
 
   inline void Update(const std::vector<cyclus::Blob>& x) {
     for (unsigned int i = 0; i < x.size(); ++i)
-      hash_.process_bytes(x[i].str().c_str(), x[i].str().size());
+      Process(x[i].str().c_str(), x[i].str().size());
   }
 
   inline void Update(const std::vector<boost::uuids::uuid>& x) {
     std::vector<boost::uuids::uuid>::const_iterator it = x.begin();
     for (; it != x.end(); ++it)
-      hash_.process_bytes(&(*it), CYCLUS_UUID_SIZE);
+      Process(&(*it), CYCLUS_UUID_SIZE);
   }
 
   inline void Update(const std::set<int>& x) {
     std::set<int>::iterator it = x.begin();
     for (; it != x.end(); ++it)
-      hash_.process_bytes(&(*it), sizeof(int));
+      Process(&(*it), sizeof(int));
   }
 
   inline void Update(const std::set<bool>& x) {
     std::set<bool>::iterator it = x.begin();
     for (; it != x.end(); ++it)
-      hash_.process_bytes(&(*it), sizeof(bool));
+      Process(&(*it), sizeof(bool));
   }
 
   inline void Update(const std::set<double>& x) {
     std::set<double>::iterator it = x.begin();
     for (; it != x.end(); ++it)
-      hash_.process_bytes(&(*it), sizeof(double));
+      Process(&(*it), sizeof(double));
   }
 
   inline void Update(const std::set<float>& x) {
     std::set<float>::iterator it = x.begin();
     for (; it != x.end(); ++it)
-      hash_.process_bytes(&(*it), sizeof(float));
+      Process(&(*it), sizeof(float));
   }
 
   inline void Update(const std::set<cyclus::Blob>& x) {
     std::set<cyclus::Blob>::iterator it = x.begin();
     for (; it != x.end(); ++it)
-      hash_.process_bytes(it->str().c_str(), it->str().size());
+      Process(it->str().c_str(), it->str().size());
   }
 
   inline void Update(const std::set<boost::uuids::uuid>& x) {
     std::set<boost::uuids::uuid>::iterator it = x.begin();
     for (; it != x.end(); ++it)
-      hash_.process_bytes(&(*it), CYCLUS_UUID_SIZE);
+      Process(&(*it), CYCLUS_UUID_SIZE);
   }
 
   inline void Update(const std::set<std::string>& x) {
     std::set<std::string>::iterator it = x.begin();
     for (; it != x.end(); ++it)
-      hash_.process_bytes(it->c_str(), it->size());
+      Process(it->c_str(), it->size());
   }
 
   inline void Update(const std::list<int>& x) {
     std::list<int>::const_iterator it = x.begin();
     for (; it != x.end(); ++it)
-      hash_.process_bytes(&(*it), sizeof(int));
+      Process(&(*it), sizeof(int));
   }
 
   inline void Update(const std::list<bool>& x) {
     std::list<bool>::const_iterator it = x.begin();
     for (; it != x.end(); ++it)
-      hash_.process_bytes(&(*it), sizeof(bool));
+      Process(&(*it), sizeof(bool));
   }
 
   inline void Update(const std::list<double>& x) {
     std::list<double>::const_iterator it = x.begin();
     for (; it != x.end(); ++it)
-      hash_.process_bytes(&(*it), sizeof(double));
+      Process(&(*it), sizeof(double));
   }
 
   inline void Update(const std::list<float>& x) {
     std::list<float>::const_iterator it = x.begin();
     for (; it != x.end(); ++it)
-      hash_.process_bytes(&(*it), sizeof(float));
+      Process(&(*it), sizeof(float));
   }
 
   inline void Update(const std::list<std::string>& x) {
     std::list<std::string>::const_iterator it = x.begin();
     for (; it != x.end(); ++it)
-      hash_.process_bytes(it->c_str(), it->size());
+      Process(it->c_str(), it->size());
   }
 
   inline void Update(const std::list<cyclus::Blob>& x) {
     std::list<cyclus::Blob>::const_iterator it = x.begin();
     for (; it != x.end(); ++it)
-      hash_.process_bytes(it->str().c_str(), it->str().size());
+      Process(it->str().c_str(), it->str().size());
   }
 
   inline void Update(const std::list<boost::uuids::uuid>& x) {
     std::list<boost::uuids::uuid>::const_iterator it = x.begin();
     for (; it != x.end(); ++it)
-      hash_.process_bytes(&(*it), CYCLUS_UUID_SIZE);
+      Process(&(*it), CYCLUS_UUID_SIZE);
   }
 
   inline void Update(const std::pair<int, int>& x) {
-    hash_.process_bytes(&(x.first), sizeof(int));
-    hash_.process_bytes(&(x.second), sizeof(int));
+    Process(&(x.first), sizeof(int));
+    Process(&(x.second), sizeof(int));
   }
 
   inline void Update(const std::pair<int, std::string>& x) {
-    hash_.process_bytes(&(x.first), sizeof(int));
-    hash_.process_bytes(x.second.c_str(), x.second.size());
+    Process(&(x.first), sizeof(int));
+    Process(x.second.c_str(), x.second.size());
   }
 
   inline void Update(const std::map<int, int>& x) {
     std::map<int, int>::const_iterator it = x.begin();
     for (; it != x.end(); ++it) {
-      hash_.process_bytes(&(it->first), sizeof(int));
-      hash_.process_bytes(&(it->second), sizeof(int));
+      Process(&(it->first), sizeof(int));
+      Process(&(it->second), sizeof(int));
     }
   }
 
   inline void Update(const std::map<int, bool>& x) {
     std::map<int, bool>::const_iterator it = x.begin();
     for (; it != x.end(); ++it) {
-      hash_.process_bytes(&(it->first), sizeof(int));
-      hash_.process_bytes(&(it->second), sizeof(bool));
+      Process(&(it->first), sizeof(int));
+      Process(&(it->second), sizeof(bool));
     }
   }
 
   inline void Update(const std::map<int, double>& x) {
     std::map<int, double>::const_iterator it = x.begin();
     for (; it != x.end(); ++it) {
-      hash_.process_bytes(&(it->first), sizeof(int));
-      hash_.process_bytes(&(it->second), sizeof(double));
+      Process(&(it->first), sizeof(int));
+      Process(&(it->second), sizeof(double));
     }
   }
 
   inline void Update(const std::map<int, float>& x) {
     std::map<int, float>::const_iterator it = x.begin();
     for (; it != x.end(); ++it) {
-      hash_.process_bytes(&(it->first), sizeof(int));
-      hash_.process_bytes(&(it->second), sizeof(float));
+      Process(&(it->first), sizeof(int));
+      Process(&(it->second), sizeof(float));
     }
   }
 
   inline void Update(const std::map<int, cyclus::Blob>& x) {
     std::map<int, cyclus::Blob>::const_iterator it = x.begin();
     for (; it != x.end(); ++it) {
-      hash_.process_bytes(&(it->first), sizeof(int));
-      hash_.process_bytes(it->second.str().c_str(), it->second.str().size());
+      Process(&(it->first), sizeof(int));
+      Process(it->second.str().c_str(), it->second.str().size());
     }
   }
 
   inline void Update(const std::map<int, boost::uuids::uuid>& x) {
     std::map<int, boost::uuids::uuid>::const_iterator it = x.begin();
     for (; it != x.end(); ++it) {
-      hash_.process_bytes(&(it->first), sizeof(int));
-      hash_.process_bytes(&(it->second), CYCLUS_UUID_SIZE);
+      Process(&(it->first), sizeof(int));
+      Process(&(it->second), CYCLUS_UUID_SIZE);
     }
   }
 
   inline void Update(const std::map<int, std::string>& x) {
     std::map<int, std::string>::const_iterator it = x.begin();
     for (; it != x.end(); ++it) {
-      hash_.process_bytes(&(it->first), sizeof(int));
-      hash_.process_bytes(it->second.c_str(), it->second.size());
+      Process(&(it->first), sizeof(int));
+      Process(it->second.c_str(), it->second.size());
     }
   }
 
   inline void Update(const std::map<std::string, int>& x) {
     std::map<std::string, int>::const_iterator it = x.begin();
     for (; it != x.end(); ++it) {
-      hash_.process_bytes(it->first.c_str(), it->first.size());
-      hash_.process_bytes(&(it->second), sizeof(int));
+      Process(it->first.c_str(), it->first.size());
+      Process(&(it->second), sizeof(int));
     }
   }
 
   inline void Update(const std::map<std::string, double>& x) {
     std::map<std::string, double>::const_iterator it = x.begin();
     for (; it != x.end(); ++it) {
-      hash_.process_bytes(it->first.c_str(), it->first.size());
-      hash_.process_bytes(&(it->second), sizeof(double));
+      Process(it->first.c_str(), it->first.size());
+      Process(&(it->second), sizeof(double));
     }
   }
 
   inline void Update(const std::map<std::string, float>& x) {
     std::map<std::string, float>::const_iterator it = x.begin();
     for (; it != x.end(); ++it) {
-      hash_.process_bytes(it->first.c_str(), it->first.size());
-      hash_.process_bytes(&(it->second), sizeof(float));
+      Process(it->first.c_str(), it->first.size());
+      Process(&(it->second), sizeof(float));
     }
   }
 
   inline void Update(const std::map<std::string, bool>& x) {
     std::map<std::string, bool>::const_iterator it = x.begin();
     for (; it != x.end(); ++it) {
-      hash_.process_bytes(it->first.c_str(), it->first.size());
-      hash_.process_bytes(&(it->second), sizeof(bool));
+      Process(it->first.c_str(), it->first.size());
+      Process(&(it->second), sizeof(bool));
     }
   }
 
   inline void Update(const std::map<std::string, cyclus::Blob>& x) {
     std::map<std::string, cyclus::Blob>::const_iterator it = x.begin();
     for (; it != x.end(); ++it) {
-      hash_.process_bytes(it->first.c_str(), it->first.size());
-      hash_.process_bytes(it->second.str().c_str(), it->second.str().size());
+      Process(it->first.c_str(), it->first.size());
+      Process(it->second.str().c_str(), it->second.str().size());
     }
   }
 
   inline void Update(const std::map<std::string, boost::uuids::uuid>& x) {
     std::map<std::string, boost::uuids::uuid>::const_iterator it = x.begin();
     for (; it != x.end(); ++it) {
-      hash_.process_bytes(it->first.c_str(), it->first.size());
-      hash_.process_bytes(&(it->second), CYCLUS_UUID_SIZE);
+      Process(it->first.c_str(), it->first.size());
+      Process(&(it->second), CYCLUS_UUID_SIZE);
     }
   }
 
   inline void Update(const std::map<std::string, std::string>& x) {
     std::map<std::string, std::string>::const_iterator it = x.begin();
     for (; it != x.end(); ++it) {
-      hash_.process_bytes(it->first.c_str(), it->first.size());
-      hash_.process_bytes(it->second.c_str(), it->second.size());
+      Process(it->first.c_str(), it->first.size());
+      Process(it->second.c_str(), it->second.size());
     }
   }
 
   inline void Update(const std::map<std::pair<int, std::string>, double>& x) {
     std::map<std::pair<int, std::string>, double>::const_iterator it = x.begin();
     for (; it != x.end(); ++it) {
-      hash_.process_bytes(&(it->first.first), sizeof(int));
-      hash_.process_bytes(it->first.second.c_str(), it->first.second.size());
-      hash_.process_bytes(&(it->second), sizeof(double));
+      Process(&(it->first.first), sizeof(int));
+      Process(it->first.second.c_str(), it->first.second.size());
+      Process(&(it->second), sizeof(double));
     }
   }
 
   inline void Update(const std::map<std::pair<std::string, std::string>, int>& x) {
     std::map<std::pair<std::string, std::string>, int>::const_iterator it = x.begin();
     for (; it != x.end(); ++it) {
-      hash_.process_bytes(it->first.first.c_str(), it->first.first.size());
-      hash_.process_bytes(it->first.second.c_str(), it->first.second.size());
-      hash_.process_bytes(&(it->second), sizeof(int));
+      Process(it->first.first.c_str(), it->first.first.size());
+      Process(it->first.second.c_str(), it->first.second.size());
+      Process(&(it->second), sizeof(int));
     }
   }
 
   inline void Update(const std::map<std::string, std::vector<double>>& x) {
     std::map<std::string, std::vector<double>>::const_iterator it = x.begin();
     for (; it != x.end(); ++it) {
-      hash_.process_bytes(it->first.c_str(), it->first.size());
+      Process(it->first.c_str(), it->first.size());
       Update(it->second);
     }
   }
@@ -961,7 +991,7 @@ class Sha1 {
   inline void Update(const std::map<std::string, std::map<int, double>>& x) {
     std::map<std::string, std::map<int, double>>::const_iterator it = x.begin();
     for (; it != x.end(); ++it) {
-      hash_.process_bytes(it->first.c_str(), it->first.size());
+      Process(it->first.c_str(), it->first.size());
       Update(it->second);
     }
   }
@@ -969,28 +999,28 @@ class Sha1 {
   inline void Update(const std::map<int, std::map<std::string, double>>& x) {
     std::map<int, std::map<std::string, double>>::const_iterator it = x.begin();
     for (; it != x.end(); ++it) {
-      hash_.process_bytes(&(it->first), sizeof(int));
+      Process(&(it->first), sizeof(int));
       Update(it->second);
     }
   }
 
   inline void Update(const std::pair<double, std::map<int, double>>& x) {
-    hash_.process_bytes(&(x.first), sizeof(double));
+    Process(&(x.first), sizeof(double));
     Update(x.second);
   }
 
   inline void Update(const std::map<std::string, std::pair<double, std::map<int, double>>>& x) {
     std::map<std::string, std::pair<double, std::map<int, double>>>::const_iterator it = x.begin();
     for (; it != x.end(); ++it) {
-      hash_.process_bytes(&(it->first), it->first.size());
+      Process(&(it->first), it->first.size());
       Update(it->second);
     }
   }
 
   inline void Update(const std::pair<int, std::pair<std::string, std::string>>& x) {
-    hash_.process_bytes(&(x.first), sizeof(int));
-    hash_.process_bytes(x.second.first.c_str(), x.second.first.size());
-    hash_.process_bytes(x.second.second.c_str(), x.second.second.size());
+    Process(&(x.first), sizeof(int));
+    Process(x.second.first.c_str(), x.second.first.size());
+    Process(x.second.second.c_str(), x.second.second.size());
   }
 
   inline void Update(const std::vector<std::pair<int, std::pair<std::string, std::string>>>& x) {
@@ -1003,7 +1033,7 @@ class Sha1 {
   inline void Update(const std::map<std::string, std::vector<std::pair<int, std::pair<std::string, std::string>>>>& x) {
     std::map<std::string, std::vector<std::pair<int, std::pair<std::string, std::string>>>>::const_iterator it = x.begin();
     for (; it != x.end(); ++it) {
-      hash_.process_bytes(it->first.c_str(), it->first.size());
+      Process(it->first.c_str(), it->first.size());
       Update(it->second);
     }
   }
@@ -1016,14 +1046,14 @@ class Sha1 {
   }
 
   inline void Update(const std::pair<std::string, std::vector<double>>& x) {
-    hash_.process_bytes(x.first.c_str(), x.first.size());
+    Process(x.first.c_str(), x.first.size());
     Update(x.second);
   }
 
   inline void Update(const std::map<std::string, std::pair<std::string, std::vector<double>>>& x) {
     std::map<std::string, std::pair<std::string, std::vector<double>>>::const_iterator it = x.begin();
     for(; it != x.end(); ++it) {
-      hash_.process_bytes(it->first.c_str(), it->first.size());
+      Process(it->first.c_str(), it->first.size());
       Update(it->second);
     }
   }
@@ -1031,14 +1061,14 @@ class Sha1 {
   inline void Update(const std::map<std::string, std::map<std::string, int>>& x) {
     std::map<std::string, std::map<std::string, int>>::const_iterator it = x.begin();
     for(; it != x.end(); ++it) {
-      hash_.process_bytes(it->first.c_str(), it->first.size());
+      Process(it->first.c_str(), it->first.size());
       Update(it->second);
     }
   }
 
   inline void Update(const std::pair<double, double>& x) {
-    hash_.process_bytes(&(x.first), sizeof(double));
-    hash_.process_bytes(&(x.second), sizeof(double));
+    Process(&(x.first), sizeof(double));
+    Process(&(x.second), sizeof(double));
   }
 
   inline void Update(const std::pair<std::pair<double, double>, std::map<std::string, double>>& x) {
@@ -1057,14 +1087,131 @@ class Sha1 {
 
   Digest digest() {
     Digest d;
-    hash_.get_digest(d.val);
+    if (algorithm_ == SHA1) {
+      hash_.get_digest(d.val);
+      return d;
+    }
+
+    // MurmurHash3 tail and finalization, on copies of the state
+    uint64_t h1 = h1_;
+    uint64_t h2 = h2_;
+    unsigned char tail[16] = {0};
+    memcpy(tail, tail_, ntail_);
+    uint64_t k1;
+    uint64_t k2;
+    memcpy(&k1, tail, 8);
+    memcpy(&k2, tail + 8, 8);
+    if (ntail_ > 8) {
+      k2 *= kC2;
+      k2 = Rotl(k2, 33);
+      k2 *= kC1;
+      h2 ^= k2;
+    }
+    if (ntail_ > 0) {
+      k1 *= kC1;
+      k1 = Rotl(k1, 31);
+      k1 *= kC2;
+      h1 ^= k1;
+    }
+    h1 ^= len_;
+    h2 ^= len_;
+    h1 += h2;
+    h2 += h1;
+    h1 = Fmix(h1);
+    h2 = Fmix(h2);
+    h1 += h2;
+    h2 += h1;
+
+    d.val[0] = static_cast<unsigned int>(h1);
+    d.val[1] = static_cast<unsigned int>(h1 >> 32);
+    d.val[2] = static_cast<unsigned int>(h2);
+    d.val[3] = static_cast<unsigned int>(h2 >> 32);
+    d.val[4] = static_cast<unsigned int>(len_);
     return d;
   }
 
  private:
+  static const uint64_t kC1 = 0x87c37b91114253d5ULL;
+  static const uint64_t kC2 = 0x4cf5ad432745937fULL;
+
+  static inline uint64_t Rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+  }
+
+  static inline uint64_t Fmix(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+  }
+
+  /// Mixes a 16 byte block into the MurmurHash3 state.
+  inline void Block(const unsigned char* block) {
+    uint64_t k1;
+    uint64_t k2;
+    memcpy(&k1, block, 8);
+    memcpy(&k2, block + 8, 8);
+
+    k1 *= kC1;
+    k1 = Rotl(k1, 31);
+    k1 *= kC2;
+    h1_ ^= k1;
+    h1_ = Rotl(h1_, 27);
+    h1_ += h2_;
+    h1_ = h1_ * 5 + 0x52dce729;
+
+    k2 *= kC2;
+    k2 = Rotl(k2, 33);
+    k2 *= kC1;
+    h2_ ^= k2;
+    h2_ = Rotl(h2_, 31);
+    h2_ += h1_;
+    h2_ = h2_ * 5 + 0x38495ab5;
+  }
+
+  /// Feeds bytes to the hash.
+  inline void Process(const void* buf, std::size_t n) {
+    if (algorithm_ == SHA1) {
+      hash_.process_bytes(buf, n);
+      return;
+    }
+
+    const unsigned char* p = static_cast<const unsigned char*>(buf);
+    len_ += n;
+    if (ntail_ > 0) {
+      std::size_t m = std::min(n, static_cast<std::size_t>(16 - ntail_));
+      memcpy(tail_ + ntail_, p, m);
+      ntail_ += m;
+      p += m;
+      n -= m;
+      if (ntail_ < 16)
+        return;
+      Block(tail_);
+      ntail_ = 0;
+    }
+    for (; n >= 16; n -= 16, p += 16)
+      Block(p);
+    memcpy(tail_, p, n);
+    ntail_ = n;
+  }
+
+  Algorithm algorithm_;
   boost::uuids::detail::sha1 hash_;
+
+  /// MurmurHash3 state: the running hash, the number of bytes hashed, and
+  /// the bytes that do not yet fill a block.
+  uint64_t h1_;
+  uint64_t h2_;
+  uint64_t len_;
+  unsigned char tail_[16];
+  int ntail_;
 };
 
+/// The name Hasher had before it could use algorithms other than SHA1.
+typedef Hasher Sha1;
+
 }  // namespace cyclus
 
 #endif  // CYCLUS_SRC_QUERY_BACKEND_H_
@@ -10,6 +10,8 @@
 
 namespace cyclus {
 
+thread_local DatumList* Recorder::deferred_ = NULL;
+
 Recorder::Recorder() : index_(0), inject_sim_id_(true) {
   uuid_ = boost::uuids::random_generator()();
   set_dump_count(kDefaultDumpCount);
@@ -67,6 +69,13 @@ void Recorder::set_dump_count(unsigned int count) {
 }
 
 Datum* Recorder::NewDatum(std::string title) {
+  if (deferred_ != NULL) {
+    // the sim id is added when the datum is replayed
+    Datum* d = new Datum(this, title);
+    deferred_->push_back(d);
+    return d;
+  }
+
   Datum* d = data_[index_];
   d->title_ = title;
   if (inject_sim_id_) {
@@ -84,11 +93,48 @@ Datum* Recorder::NewDatum(std::string title) {
 }
 
 void Recorder::AddDatum(Datum* d) {
+  if (deferred_ != NULL) {
+    return;
+  }
   if (index_ >= data_.size()) {
     NotifyBackends();
   }
 }
 
+void Recorder::Defer(DatumList* buf) {
+  deferred_ = buf;
+}
+
+void Recorder::Replay(DatumList* buf) {
+  for (int i = 0; i < buf->size(); ++i) {
+    Datum* src = (*buf)[i];
+    Datum* d = NewDatum(src->title_);
+    d->vals_.insert(d->vals_.end(), src->vals_.begin(), src->vals_.end());
+    d->shapes_.insert(d->shapes_.end(), src->shapes_.begin(),
+                      src->shapes_.end());
+    d->fields_.insert(d->fields_.end(), src->fields_.begin(),
+                      src->fields_.end());
+    d->Record();
+    delete src;
+  }
+  buf->clear();
+}
+
+long Recorder::buffer_bytes() {
+  long n = 0;
+  for (int i = 0; i < index_; ++i) {
+    Datum* d = data_[i];
+    n += sizeof(Datum) + d->title_.capacity() +
+         d->vals_.capacity() * sizeof(Datum::Entry) +
+         d->shapes_.capacity() * sizeof(Datum::Shape) +
+         d->fields_.capacity() * sizeof(std::string);
+    for (int j = 0; j < d->fields_.size(); ++j) {
+      n += d->fields_[j].capacity();
+    }
+  }
+  return n;
+}
+
 void Recorder::Flush() {
   if (index_ == 0)
     return;
@@ -100,6 +100,18 @@ class Recorder {
   /// (e.g. the same table).
   Datum* NewDatum(std::string title);
 
+  /// Routes Datum objects created on the calling thread into buf instead of
+  /// the shared buffer until Defer(NULL) is called on that thread. Deferred
+  /// Datum objects are neither flushed nor seen by backends until they are
+  /// passed to Replay. This is what allows agents to create and record Datum
+  /// objects from worker threads.
+  static void Defer(DatumList* buf);
+
+  /// Records the Datum objects collected by Defer, in order, and then deletes
+  /// them and clears buf. This must be called from the thread that owns the
+  /// recorder.
+  void Replay(DatumList* buf);
+
   /// Registers b to receive Datum notifications for all Datum objects collected
   /// by the Recorder and to receive a flush notification when there
   /// are no more Datum objects.
@@ -107,6 +119,12 @@ class Recorder {
   /// @param b backend to receive Datum objects
   void RegisterBackend(RecBackend* b);
 
+  /// Returns the number of Datum objects buffered since the last flush.
+  inline int buffered() { return index_; }
+
+  /// Returns an estimate of the bytes held by the buffered Datum objects.
+  long buffer_bytes();
+
   /// Flushes all buffered Datum objects and flushes all registered backends.
   void Flush();
 
@@ -120,6 +138,7 @@ class Recorder {
 
   DatumList data_;
   int index_;
+  static thread_local DatumList* deferred_;
   std::list<RecBackend*> backs_;
   unsigned int dump_count_;
   boost::uuids::uuid uuid_;
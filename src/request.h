@@ -8,6 +8,9 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/weak_ptr.hpp>
 
+#include "block_pool.h"
+#include "sequenced.h"
+
 namespace cyclus {
 
 class Material;
@@ -25,8 +28,10 @@ template <class T> class RequestPortfolio;
 /// @brief A Request encapsulates all the information required to communicate
 /// the needs of an agent in the Dynamic Resource Exchange, including the
 /// commodity it needs as well as a resource specification for that commodity.
-/// A Request is templated its resource.
-template <class T> class Request {
+/// A Request is templated its resource. Requests are allocated from a
+/// BlockPool and are numbered in the order of their creation.
+template <class T> class Request : public Pooled<Request<T> >,
+                                   public Sequenced<Request<T> > {
  public:
   typedef std::function<double(boost::shared_ptr<T>)> cost_function_t;
 
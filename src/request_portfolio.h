@@ -10,10 +10,12 @@
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/shared_ptr.hpp>
 
+#include "block_pool.h"
 #include "capacity_constraint.h"
 #include "error.h"
 #include "logger.h"
 #include "request.h"
+#include "sequenced.h"
 
 namespace cyclus {
 
@@ -82,9 +84,14 @@ template <class T> struct QtyCoeffConverter : public Converter<T> {
 /// determine the demand as "met". In this case, the total demand is 9.5, the
 /// MOX order is given a coefficient of 9.5 / 10, and the UOX order is given a
 /// coefficient of 9.5 / 9.
+///
+/// Portfolios are allocated from a BlockPool and are numbered in the order of
+/// their creation.
 template <class T>
 class RequestPortfolio
-    : public boost::enable_shared_from_this<RequestPortfolio<T>> {
+    : public boost::enable_shared_from_this<RequestPortfolio<T>>,
+      public Pooled<RequestPortfolio<T> >,
+      public Sequenced<RequestPortfolio<T> > {
  public:
   typedef boost::shared_ptr<RequestPortfolio<T>> Ptr;
   typedef std::function<double(boost::shared_ptr<T>)> cost_function_t;
@@ -1,10 +1,13 @@
 #ifndef CYCLUS_SRC_RESOURCE_H_
 #define CYCLUS_SRC_RESOURCE_H_
 
+#include <atomic>
 #include <string>
 #include <vector>
 #include <boost/shared_ptr.hpp>
 
+#include "id_blocks.h"
+
 class SimInitTest;
 
 namespace cyclus {
@@ -18,12 +21,23 @@ typedef std::string ResourceType;
 /// represent the lifeblood of a simulation.
 class Resource {
   friend class SimInit;
+  friend class Timer;
   friend class ::SimInitTest;
 
  public:
   typedef boost::shared_ptr<Resource> Ptr;
 
-  Resource() : state_id_(nextstate_id_++), obj_id_(nextobj_id_++) {}
+  /// The type tag of a resource implementation, which lets ResCast check
+  /// the type of a resource without RTTI. Implementations that define their
+  /// own tag must pass it to the Resource constructor and must be declared
+  /// final, since a subclass would inherit the tag and be cast to the wrong
+  /// type. Others keep this one, and are cast with RTTI.
+  static const int kTag = 0;
+
+  Resource()
+      : state_id_(IdBlocks::Next(IdBlocks::STATE, &nextstate_id_)),
+        obj_id_(IdBlocks::Next(IdBlocks::OBJ, &nextobj_id_)),
+        tag_(kTag) {}
 
   virtual ~Resource() {}
 
@@ -55,6 +69,10 @@ class Resource {
   /// A unique type/name for the concrete resource implementation.
   virtual const ResourceType type() const = 0;
 
+  /// Returns the type tag of the concrete resource implementation (see
+  /// kTag).
+  int tag() const { return tag_; }
+
   /// Returns an untracked (not part of the simulation) copy of the resource.
   /// A cloned resource should never record anything in the output database.
   virtual Ptr Clone() const = 0;
@@ -79,29 +97,45 @@ class Resource {
   /// @return a new resource object with same state id and quantity == quantity
   virtual Ptr ExtractRes(double quantity) = 0;
 
+ protected:
+  /// @param tag the type tag of the concrete resource implementation
+  explicit Resource(int tag)
+      : state_id_(IdBlocks::Next(IdBlocks::STATE, &nextstate_id_)),
+        obj_id_(IdBlocks::Next(IdBlocks::OBJ, &nextobj_id_)),
+        tag_(tag) {}
+
  private:
-  static int nextstate_id_;
-  static int nextobj_id_;
+  static std::atomic<int> nextstate_id_;
+  static std::atomic<int> nextobj_id_;
   int state_id_;
   int obj_id_;
+  int tag_;
 };
 
+/// Casts a Resource::Ptr into a pointer of a specific resource type T. The
+/// result is empty if r is not a T. Types with a tag (see Resource::kTag) are
+/// checked by comparing tags rather than with a dynamic cast.
+template <class T>
+typename T::Ptr ResCast(const Resource::Ptr& r) {
+  if (T::kTag == Resource::kTag || !r) {
+    return boost::dynamic_pointer_cast<T>(r);
+  } else if (r->tag() != T::kTag) {
+    return typename T::Ptr();
+  }
+  return boost::static_pointer_cast<T>(r);
+}
+
 /// Casts a vector of Resources into a vector of a specific resource type T.
 template <class T>
-std::vector<typename T::Ptr> ResCast(std::vector<Resource::Ptr> rs) {
+std::vector<typename T::Ptr> ResCast(const std::vector<Resource::Ptr>& rs) {
   std::vector<typename T::Ptr> casted;
+  casted.reserve(rs.size());
   for (int i = 0; i < rs.size(); ++i) {
-    casted.push_back(boost::dynamic_pointer_cast<T>(rs[i]));
+    casted.push_back(ResCast<T>(rs[i]));
   }
   return casted;
 }
 
-/// Casts a Resource::Ptr into a pointer of a specific resource type T.
-template <class T>
-typename T::Ptr ResCast(Resource::Ptr r) {
-  return boost::dynamic_pointer_cast<T>(r);
-}
-
 }  // namespace cyclus
 
 #endif  // CYCLUS_SRC_RESOURCE_H_
@@ -3,7 +3,11 @@
 
 #include <algorithm>
 #include <functional>
+#include <map>
 #include <set>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "bid_portfolio.h"
 #include "context.h"
@@ -11,6 +15,7 @@
 #include "product.h"
 #include "material.h"
 #include "request_portfolio.h"
+#include "sequenced.h"
 #include "trader.h"
 #include "trader_management.h"
 
@@ -32,6 +37,14 @@ inline static void AdjustPrefs(Trader* t, PrefMap<Material>::type& prefs) {
 inline static void AdjustPrefs(Trader* t, PrefMap<Product>::type& prefs) {
   t->AdjustProductPrefs(prefs);
 }
+template<class T>
+inline static void AdjustPrefTable(Agent* m, PrefTable<T>& prefs) {}
+inline static void AdjustPrefTable(Agent* m, PrefTable<Material>& prefs) {
+  m->AdjustMatlPrefTable(prefs);
+}
+inline static void AdjustPrefTable(Agent* m, PrefTable<Product>& prefs) {
+  m->AdjustProductPrefTable(prefs);
+}
 
 /// @class ResourceExchange
 ///
@@ -94,13 +107,14 @@ class ResourceExchange {
   /// @brief adjust preferences for requests given bid responses
   void AdjustAll() {
     InitTraders();
-    std::set<Trader*> traders = ex_ctx_.requesters;
+    std::set<Trader*, TraderCompare> traders = ex_ctx_.requesters;
     std::for_each(
         traders.begin(),
         traders.end(),
         std::bind1st(
             std::mem_fun(&cyclus::ResourceExchange<T>::AdjustPrefs_),
             this));
+    AdjustPrefTables_();
   }
 
   /// return true if this is an empty exchange (i.e., no requests exist,
@@ -110,20 +124,19 @@ class ResourceExchange {
  private:
   void InitTraders() {
     if (traders_.size() == 0) {
-      std::set<Trader*> orig = sim_ctx_->traders();
-      std::set<Trader*>::iterator it;
-      for (it = orig.begin(); it != orig.end(); ++it) {
-        traders_.insert(*it);
-      }
+      const std::set<Trader*>& orig = sim_ctx_->traders();
+      traders_.insert(orig.begin(), orig.end());
     }
   }
 
   /// @brief queries a given facility agent for
   void AddRequests_(Trader* t) {
+    // traders return their portfolios in sets ordered by address
     std::set<typename RequestPortfolio<T>::Ptr> rp = QueryRequests<T>(t);
-    typename std::set<typename RequestPortfolio<T>::Ptr>::iterator it;
-    for (it = rp.begin(); it != rp.end(); ++it) {
-      ex_ctx_.AddRequestPortfolio(*it);
+    std::vector<typename RequestPortfolio<T>::Ptr> ports(rp.begin(), rp.end());
+    std::sort(ports.begin(), ports.end(), SequencedLess<RequestPortfolio<T> >());
+    for (int i = 0; i != ports.size(); ++i) {
+      ex_ctx_.AddRequestPortfolio(ports[i]);
     }
   }
 
@@ -131,9 +144,10 @@ class ResourceExchange {
   void AddBids_(Trader* t) {
     std::set<typename BidPortfolio<T>::Ptr> bp =
         QueryBids<T>(t, ex_ctx_.commod_requests);
-    typename std::set<typename BidPortfolio<T>::Ptr>::iterator it;
-    for (it = bp.begin(); it != bp.end(); ++it) {
-      ex_ctx_.AddBidPortfolio(*it);
+    std::vector<typename BidPortfolio<T>::Ptr> ports(bp.begin(), bp.end());
+    std::sort(ports.begin(), ports.end(), SequencedLess<BidPortfolio<T> >());
+    for (int i = 0; i != ports.size(); ++i) {
+      ex_ctx_.AddBidPortfolio(ports[i]);
     }
   }
 
@@ -149,23 +163,91 @@ class ResourceExchange {
     }
   }
 
-  struct trader_compare {
-    bool operator()(Trader* lhs, Trader* rhs) const {
-      int left = lhs->manager()->id();
-      int right = rhs->manager()->id();
-      if (left != right) {
-        return left < right;
-      } else {
-        return lhs < rhs;
+  /// @brief allows every ancestor of a requester that has registered with
+  /// Agent::UsePrefTables to adjust all of its descendants' preferences at
+  /// once through a PrefTable. Children adjust before their parents.
+  void AdjustPrefTables_() {
+    // each registered ancestor's requesting descendants, in trader order
+    std::vector<Agent*> ancestors;
+    std::map<Agent*, std::vector<Trader*> > descendants;
+    std::set<Trader*, TraderCompare>::iterator t_it;
+    for (t_it = ex_ctx_.requesters.begin(); t_it != ex_ctx_.requesters.end();
+         ++t_it) {
+      for (Agent* m = (*t_it)->manager()->parent(); m != NULL;
+           m = m->parent()) {
+        if (!m->use_pref_tables())
+          continue;
+        if (descendants.count(m) == 0)
+          ancestors.push_back(m);
+        descendants[m].push_back(*t_it);
       }
     }
-  };
+    if (ancestors.empty())
+      return;
+
+    std::vector<std::string> commods;
+    std::map<std::string, int> commod_ids;
+    typename CommodMap<T>::type::iterator c_it;
+    for (c_it = ex_ctx_.commod_requests.begin();
+         c_it != ex_ctx_.commod_requests.end(); ++c_it) {
+      commod_ids[c_it->first] = commods.size();
+      commods.push_back(c_it->first);
+    }
+
+    // deepest ancestors first, otherwise in the order they were found
+    std::vector<std::pair<int, int> > order;
+    for (int i = 0; i != ancestors.size(); i++) {
+      int depth = 0;
+      for (Agent* p = ancestors[i]->parent(); p != NULL; p = p->parent())
+        ++depth;
+      order.push_back(std::make_pair(-depth, i));
+    }
+    std::sort(order.begin(), order.end());
+
+    for (int i = 0; i != order.size(); i++) {
+      Agent* m = ancestors[order[i].second];
+      PrefTable<T> table;
+      table.commods = commods;
+      std::vector<double*> targets;
+      const std::vector<Trader*>& traders = descendants[m];
+      for (int j = 0; j != traders.size(); j++)
+        AddToPrefTable_(traders[j], commod_ids, &table, &targets);
+
+      AdjustPrefTable(m, table);
+      for (int j = 0; j != targets.size(); j++)
+        *targets[j] = table.prefs[j];
+    }
+  }
+
+  /// @brief appends the arcs of a requester to a PrefTable, and pointers to
+  /// their preferences in the exchange context to targets
+  void AddToPrefTable_(Trader* t, const std::map<std::string, int>& commod_ids,
+                       PrefTable<T>* table, std::vector<double*>* targets) {
+    typename PrefMap<T>::type& prefs = ex_ctx_.trader_prefs[t];
+    int requester_id = t->manager()->id();
+    typename PrefMap<T>::type::iterator r_it;
+    for (r_it = prefs.begin(); r_it != prefs.end(); ++r_it) {
+      Request<T>* r = r_it->first;
+      int commod_id = commod_ids.at(r->commodity());
+      typename PrefMap<T>::bid_map::iterator b_it;
+      for (b_it = r_it->second.begin(); b_it != r_it->second.end(); ++b_it) {
+        Bid<T>* b = b_it->first;
+        table->requests.push_back(r);
+        table->bids.push_back(b);
+        table->requester_ids.push_back(requester_id);
+        table->bidder_ids.push_back(b->bidder()->manager()->id());
+        table->commod_ids.push_back(commod_id);
+        table->prefs.push_back(b_it->second);
+        targets->push_back(&b_it->second);
+      }
+    }
+  }
 
   // this sorts traders (and results in iteration...) based on traders'
   // manager id.  Iterating over traders in this order helps increase the
   // determinism of Cyclus overall.  This allows all traders' resource
   // exchange functions are called in a much closer to deterministic order.
-  std::set<Trader*, trader_compare> traders_;
+  std::set<Trader*, TraderCompare> traders_;
 
   Context* sim_ctx_;
   ExchangeContext<T> ex_ctx_;
@@ -0,0 +1,175 @@
+#ifndef CYCLUS_SRC_SEQUENCED_H_
+#define CYCLUS_SRC_SEQUENCED_H_
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+namespace cyclus {
+
+/// @class Sequenced
+///
+/// @brief Deriving T from Sequenced<T> gives every T a sequential id in the
+/// order in which the objects were created. Copies get a new id.
+///
+/// The dynamic resource exchange keys many containers by pointers to
+/// requests, bids, and their portfolios. Ordering those containers by id
+/// rather than by address (see SequencedLess), or hashing them by id (see
+/// SequencedMap), makes the order in which they are iterated, and therefore
+/// the outcome of an exchange, independent of where the allocator happened to
+/// place each object. Ids are drawn from an atomic counter, so objects may be
+/// created on several threads at once.
+template <class T>
+class Sequenced {
+ public:
+  /// @return this object's id, unique among all T's created in this process
+  inline std::size_t id() const { return id_; }
+
+ protected:
+  Sequenced() : id_(next_id_++) {}
+  Sequenced(const Sequenced& other) : id_(next_id_++) {}
+  Sequenced& operator=(const Sequenced& other) { return *this; }
+
+ private:
+  std::size_t id_;
+  static std::atomic<std::size_t> next_id_;
+};
+
+template <class T>
+std::atomic<std::size_t> Sequenced<T>::next_id_(0);
+
+/// @brief A strict weak ordering of pointers to Sequenced objects by id. NULL
+/// pointers come first, and objects with the same id (which can only happen if
+/// the id counter is not shared, e.g., across some shared libraries) are
+/// ordered by address. Containers keyed by such pointers name it as their
+/// comparator explicitly.
+template <class T>
+struct SequencedLess {
+  typedef const T* first_argument_type;
+  typedef const T* second_argument_type;
+  typedef bool result_type;
+
+  bool operator()(const T* lhs, const T* rhs) const {
+    if (lhs == NULL || rhs == NULL)
+      return lhs == NULL && rhs != NULL;
+    if (lhs->id() != rhs->id())
+      return lhs->id() < rhs->id();
+    return std::less<const void*>()(lhs, rhs);
+  }
+
+  bool operator()(const boost::shared_ptr<T>& lhs,
+                  const boost::shared_ptr<T>& rhs) const {
+    return (*this)(lhs.get(), rhs.get());
+  }
+};
+
+/// @class SequencedMap
+///
+/// @brief An associative container from pointers to Sequenced objects to
+/// values. Keys are hashed by id into an open-addressing table with linear
+/// probing, so lookups take constant time on average. Objects created in one
+/// exchange have consecutive ids, which fill the table without collisions.
+/// Entries are stored, and iterated, in the order in which they were
+/// inserted. Entries cannot be erased other than by clearing the map.
+template <class K, class V>
+class SequencedMap {
+ public:
+  typedef K* key_type;
+  typedef V mapped_type;
+  typedef std::pair<K*, V> value_type;
+  typedef typename std::vector<value_type>::iterator iterator;
+  typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+  SequencedMap() {}
+
+  inline iterator begin() { return entries_.begin(); }
+  inline iterator end() { return entries_.end(); }
+  inline const_iterator begin() const { return entries_.begin(); }
+  inline const_iterator end() const { return entries_.end(); }
+
+  inline std::size_t size() const { return entries_.size(); }
+  inline bool empty() const { return entries_.empty(); }
+
+  void clear() {
+    entries_.clear();
+    slots_.clear();
+  }
+
+  /// @return the entry of k, or end() if there is none
+  iterator find(const K* k) {
+    int i = Find(k);
+    return i < 0 ? end() : entries_.begin() + i;
+  }
+
+  const_iterator find(const K* k) const {
+    int i = Find(k);
+    return i < 0 ? end() : entries_.begin() + i;
+  }
+
+  inline std::size_t count(const K* k) const { return Find(k) < 0 ? 0 : 1; }
+
+  /// @return the value of k
+  /// @throws std::out_of_range if k has no entry
+  V& at(const K* k) {
+    int i = Find(k);
+    if (i < 0)
+      throw std::out_of_range("SequencedMap::at");
+    return entries_[i].second;
+  }
+
+  const V& at(const K* k) const {
+    int i = Find(k);
+    if (i < 0)
+      throw std::out_of_range("SequencedMap::at");
+    return entries_[i].second;
+  }
+
+  /// @return the value of k, which is default constructed and appended to the
+  /// entries if k has none
+  V& operator[](K* k) {
+    if (2 * (entries_.size() + 1) > slots_.size())
+      Rehash(slots_.empty() ? 16 : 2 * slots_.size());
+    std::size_t s = Slot(k);
+    if (slots_[s] < 0) {
+      slots_[s] = entries_.size();
+      entries_.push_back(value_type(k, V()));
+    }
+    return entries_[slots_[s]].second;
+  }
+
+ private:
+  /// @return the slot holding the entry of k, or the empty slot where it
+  /// would go
+  std::size_t Slot(const K* k) const {
+    std::size_t mask = slots_.size() - 1;
+    std::size_t s = (k == NULL ? 0 : k->id()) & mask;
+    while (slots_[s] >= 0 && entries_[slots_[s]].first != k)
+      s = (s + 1) & mask;
+    return s;
+  }
+
+  /// @return the index of the entry of k, or -1 if there is none
+  int Find(const K* k) const {
+    return slots_.empty() ? -1 : slots_[Slot(k)];
+  }
+
+  void Rehash(std::size_t n) {
+    slots_.assign(n, -1);
+    for (int i = 0; i != entries_.size(); ++i)
+      slots_[Slot(entries_[i].first)] = i;
+  }
+
+  std::vector<value_type> entries_;
+
+  /// a power of two number of slots, each holding the index of an entry or -1
+  std::vector<int> slots_;
+};
+
+}  // namespace cyclus
+
+#endif  // CYCLUS_SRC_SEQUENCED_H_
@@ -1,5 +1,9 @@
 #include "sim_init.h"
 
+#include <algorithm>
+
+#include "checkpoint_back.h"
+#include "flow_solver.h"
 #include "greedy_preconditioner.h"
 #include "greedy_solver.h"
 #include "platform.h"
@@ -43,7 +47,12 @@ void SimInit::Restart(QueryableBackend* b, boost::uuids::uuid sim_id, int t) {
 
 void SimInit::Branch(QueryableBackend* b, boost::uuids::uuid prev_sim_id,
                      int t, boost::uuids::uuid new_sim_id) {
-  throw Error("simulation branching feature not implemented");
+  rec_ = new Recorder(new_sim_id);
+  InitBase(b, prev_sim_id, t);
+  si_.parent_sim = prev_sim_id;
+  si_.parent_type = "branch";
+  si_.branch_time = t;
+  ctx_->InitSim(si_);  // explicitly force this to show up in the branch's output db
 }
 
 void SimInit::InitBase(QueryableBackend* b, boost::uuids::uuid simid, int t) {
@@ -64,6 +73,7 @@ void SimInit::InitBase(QueryableBackend* b, boost::uuids::uuid simid, int t) {
   LoadInventories();
   LoadBuildSched();
   LoadDecomSched();
+  LoadSleeps();
   LoadNextIds();
 
   // delete all buffered data that we don't want to be re-recorded in the
@@ -86,6 +96,17 @@ void SimInit::Snapshot(Context* ctx) {
     }
   }
 
+  // snapshot the sleeping time listeners
+  std::map<int, std::pair<TimeListener*, int> >& sleepers = ctx->ti_->sleepers_;
+  std::map<int, std::pair<TimeListener*, int> >::iterator s;
+  for (s = sleepers.begin(); s != sleepers.end(); ++s) {
+    ctx->NewDatum("Sleeps")
+        ->AddVal("Time", ctx->time())
+        ->AddVal("AgentId", s->first)
+        ->AddVal("WakeTime", s->second.second)
+        ->Record();
+  }
+
   // snapshot all next ids
   ctx->NewDatum("NextIds")
       ->AddVal("Time", ctx->time())
@@ -100,17 +121,17 @@ void SimInit::Snapshot(Context* ctx) {
   ctx->NewDatum("NextIds")
       ->AddVal("Time", ctx->time())
       ->AddVal("Object", std::string("Composition"))
-      ->AddVal("NextId", Composition::next_id_)
+      ->AddVal("NextId", Composition::next_id_.load())
       ->Record();
   ctx->NewDatum("NextIds")
       ->AddVal("Time", ctx->time())
       ->AddVal("Object", std::string("ResourceState"))
-      ->AddVal("NextId", Resource::nextstate_id_)
+      ->AddVal("NextId", Resource::nextstate_id_.load())
       ->Record();
   ctx->NewDatum("NextIds")
       ->AddVal("Time", ctx->time())
       ->AddVal("Object", std::string("ResourceObj"))
-      ->AddVal("NextId", Resource::nextobj_id_)
+      ->AddVal("NextId", Resource::nextobj_id_.load())
       ->Record();
   ctx->NewDatum("NextIds")
       ->AddVal("Time", ctx->time())
@@ -120,6 +141,51 @@ void SimInit::Snapshot(Context* ctx) {
 }
 
 void SimInit::SnapAgent(Agent* m) {
+  Context* ctx = m->context();
+  if (!ctx->sim_info().delta_snapshots) {
+    RecordAgent(m);
+    return;
+  }
+
+  // record the agent's state only if it differs from the state it last
+  // recorded; SimTime is the only field that always differs
+  DatumList buf;
+  Recorder::Defer(&buf);
+  try {
+    RecordAgent(m);
+  } catch (...) {
+    Recorder::Defer(NULL);
+    for (int i = 0; i < buf.size(); ++i) {
+      delete buf[i];
+    }
+    throw;
+  }
+  Recorder::Defer(NULL);
+
+  Hasher hash(Hasher::MURMUR3);
+  try {
+    hash.Update(CheckpointBack::Pack(buf, "SimTime"));
+  } catch (ValueError err) {
+    // a type that cannot be compared, so always record the state
+    ctx->snap_digests_->erase(m->id());
+    ctx->rec_->Replay(&buf);
+    return;
+  }
+
+  Digest d = hash.digest();
+  std::map<int, Digest>& digests = *ctx->snap_digests_;
+  std::map<int, Digest>::iterator it = digests.find(m->id());
+  if (it != digests.end() && it->second == d) {
+    for (int i = 0; i < buf.size(); ++i) {
+      delete buf[i];
+    }
+    return;
+  }
+  digests[m->id()] = d;
+  ctx->rec_->Replay(&buf);
+}
+
+void SimInit::RecordAgent(Agent* m) {
   // call manually without agent impl injected to keep all Agent state in a
   // single, consolidated db table
   m->Agent::Snapshot(DbInit(m, true));
@@ -168,6 +234,31 @@ void SimInit::LoadInfo() {
   si_.explicit_inventory = qr.GetVal<bool>("RecordInventory");
   si_.explicit_inventory_compact = qr.GetVal<bool>("RecordInventoryCompact");
 
+  // optional to maintain backwards compatibility with older databases
+  if (0 < b_->Tables().count("InfoOptions")) {
+    qr = b_->Query("InfoOptions", NULL);
+    si_.dre_stats = qr.GetVal<bool>("RecordDreStats");
+    si_.threads = qr.GetVal<int>("Threads");
+    si_.delta_snapshots = qr.GetVal<bool>("DeltaSnapshots");
+    si_.checkpoint_interval = qr.GetVal<int>("CheckpointInterval");
+    si_.checkpoint_minutes = qr.GetVal<double>("CheckpointMinutes");
+    si_.memory_stats = qr.GetVal<bool>("RecordMemoryStats");
+    si_.decay_cache_size = qr.GetVal<int>("DecayCacheSize");
+  }
+
+  if (0 < b_->Tables().count("InfoHdf5Storage")) {
+    qr = b_->Query("InfoHdf5Storage", NULL);
+    for (int i = 0; i < qr.rows.size(); ++i) {
+      TableStorageInfo st;
+      st.table = qr.GetVal<std::string>("TableName", i);
+      st.chunk_size = qr.GetVal<int>("ChunkSize", i);
+      st.codec = qr.GetVal<std::string>("Codec", i);
+      st.level = qr.GetVal<int>("Level", i);
+      st.shuffle = qr.GetVal<int>("Shuffle", i);
+      si_.hdf5_storage.push_back(st);
+    }
+  }
+
   ctx_->InitSim(si_);
 }
 
@@ -218,15 +309,20 @@ ExchangeSolver* SimInit::LoadGreedySolver(bool exclusive,
                                           std::set<std::string> tables) {
   using std::set;
   using std::string;
-  ExchangeSolver* solver;
+  GreedySolver* solver;
   void* precon = NULL;
   string precon_name = string("greedy");
+  bool best_first = false;
 
   string solver_info = string("GreedySolverInfo");
   if (0 < tables.count(solver_info)) {
     QueryResult qr = b_->Query(solver_info, NULL);
     if (qr.rows.size() > 0) {
       precon_name = qr.GetVal<string>("Preconditioner");
+      // optional to maintain backwards compatibility with older databases
+      std::vector<std::string>& f = qr.fields;
+      if (std::find(f.begin(), f.end(), "BestFirst") != f.end())
+        best_first = qr.GetVal<bool>("BestFirst");
     }
   }
 
@@ -237,15 +333,20 @@ ExchangeSolver* SimInit::LoadGreedySolver(bool exclusive,
     solver = new GreedySolver(exclusive,
       reinterpret_cast<GreedyPreconditioner*>(precon));
   }
+  solver->best_first(best_first);
   return solver;
 }
 
 ExchangeSolver* SimInit::LoadCoinSolver(bool exclusive,
                                         std::set<std::string> tables) {
 #if CYCLUS_HAS_COIN
-  ExchangeSolver* solver;
-  double timeout;
-  bool verbose, mps;
+  ProgSolver* solver;
+  double timeout = -1;
+  bool verbose = false;
+  bool mps = false;
+  bool warm_start = false;
+  bool adaptive = false;
+  double time_per_int = -1;
 
   std::string solver_info = "CoinSolverInfo";
   if (0 < tables.count(solver_info)) {
@@ -253,17 +354,52 @@ ExchangeSolver* SimInit::LoadCoinSolver(bool exclusive,
     timeout = qr.GetVal<double>("Timeout");
     verbose = qr.GetVal<bool>("Verbose");
     mps = qr.GetVal<bool>("Mps");
+    // optional to maintain backwards compatibility with older databases
+    std::vector<std::string>& f = qr.fields;
+    if (std::find(f.begin(), f.end(), "WarmStart") != f.end())
+      warm_start = qr.GetVal<bool>("WarmStart");
+    if (std::find(f.begin(), f.end(), "Adaptive") != f.end()) {
+      adaptive = qr.GetVal<bool>("Adaptive");
+      time_per_int = qr.GetVal<double>("TimePerInt");
+    }
   }
 
   // set timeout to default if input value is non-positive
   timeout = timeout <= 0 ? ProgSolver::kDefaultTimeout : timeout;
   solver = new ProgSolver("cbc", timeout, exclusive, verbose, mps);
+  solver->warm_start(warm_start);
+  solver->adaptive(adaptive);
+  if (time_per_int > 0)
+    solver->time_per_int(time_per_int);
   return solver;
 #else
   throw cyclus::Error("Cyclus was not compiled with COIN support, cannot load solver.");
 #endif
 }
 
+ExchangeSolver* SimInit::LoadFlowSolver(bool exclusive,
+                                        std::set<std::string> tables) {
+  std::string fallback = "greedy";
+  std::string solver_info = "FlowSolverInfo";
+  if (0 < tables.count(solver_info)) {
+    QueryResult qr = b_->Query(solver_info, NULL);
+    if (qr.rows.size() > 0) {
+      fallback = qr.GetVal<std::string>("Fallback");
+    }
+  }
+
+  ExchangeSolver* fb;
+  if (fallback == "greedy") {
+    fb = LoadGreedySolver(exclusive, tables);
+  } else if (fallback == "coin-or") {
+    fb = LoadCoinSolver(exclusive, tables);
+  } else {
+    throw ValueError("The name of the flow solver's fallback was not "
+                     "recognized, got '" + fallback + "'.");
+  }
+  return new FlowSolver(exclusive, fb);
+}
+
 void SimInit::LoadSolverInfo() {
   using std::set;
   using std::string;
@@ -288,6 +424,8 @@ void SimInit::LoadSolverInfo() {
     solver = LoadGreedySolver(exclusive_orders, tables);
   } else if (solver_name == "coin-or") {
     solver = LoadCoinSolver(exclusive_orders, tables);
+  } else if (solver_name == "flow") {
+    solver = LoadFlowSolver(exclusive_orders, tables);
   } else {
     throw ValueError("The name of the solver was not recognized, "
                      "got '" + solver_name + "'.");
@@ -330,6 +468,20 @@ void SimInit::LoadInitialAgents() {
   // to be done once; remember that we are initializing agents from a
   // simulation that was already started.
 
+  // with delta snapshots, agents' state is the one they last recorded
+  if (si_.delta_snapshots) {
+    std::vector<Cond> conds;
+    conds.push_back(Cond("SimTime", "<=", t_));
+    QueryResult qr = b_->Query("AgentStateAgent", &conds);
+    for (int i = 0; i < qr.rows.size(); ++i) {
+      int id = qr.GetVal<int>("AgentId", i);
+      int t = qr.GetVal<int>("SimTime", i);
+      if (state_times_.count(id) == 0 || state_times_[id] < t) {
+        state_times_[id] = t;
+      }
+    }
+  }
+
   // find all agents that are alive at the current timestep
   std::vector<Cond> conds;
   conds.push_back(Cond("EnterTime", "<=", t_));
@@ -368,7 +520,7 @@ void SimInit::LoadInitialAgents() {
 
     // agent-custom init
     conds.pop_back();
-    conds.push_back(Cond("SimTime", "==", t_));
+    conds.push_back(Cond("SimTime", "==", StateTime(id)));
     CondInjector ci(b_, conds);
     PrefixInjector pi(&ci, "AgentState");
     m->Agent::InitFrom(&pi);
@@ -412,30 +564,54 @@ void SimInit::LoadInitialAgents() {
 }
 
 void SimInit::LoadInventories() {
+  int t0 = t_;
   std::map<int, Agent*>::iterator it;
   for (it = agents_.begin(); it != agents_.end(); ++it) {
-    Agent* m = it->second;
-    std::vector<Cond> conds;
-    conds.push_back(Cond("SimTime", "==", t_));
-    conds.push_back(Cond("AgentId", "==", m->id()));
-    QueryResult qr;
-    try {
-      qr = b_->Query("AgentStateInventories", &conds);
-    } catch (std::exception err) {return;}  // table doesn't exist (okay)
+    t0 = std::min(t0, StateTime(it->first));
+  }
+  std::vector<Cond> conds;
+  conds.push_back(Cond("SimTime", ">=", t0));
+  conds.push_back(Cond("SimTime", "<=", t_));
+  QueryResult qr;
+  try {
+    qr = b_->Query("AgentStateInventories", &conds);
+  } catch (std::exception err) {return;}  // table doesn't exist (okay)
 
-    Inventories invs;
-    for (int i = 0; i < qr.rows.size(); ++i) {
-      std::string inv_name = qr.GetVal<std::string>("InventoryName", i);
-      int state_id = qr.GetVal<int>("ResourceId", i);
-      invs[inv_name].push_back(LoadResource(ctx_, b_, state_id));
+  // the rows recorded with the state of their agent
+  std::vector<int> rows;
+  std::set<int> state_ids;
+  for (int i = 0; i < qr.rows.size(); ++i) {
+    int id = qr.GetVal<int>("AgentId", i);
+    if (qr.GetVal<int>("SimTime", i) == StateTime(id)) {
+      rows.push_back(i);
+      state_ids.insert(qr.GetVal<int>("ResourceId", i));
     }
-    m->InitInv(invs);
   }
+  std::map<int, Resource::Ptr> rs = LoadResources(ctx_, b_, state_ids);
+
+  // std::map<AgentId, Inventories>
+  std::map<int, Inventories> invs;
+  for (int j = 0; j < rows.size(); ++j) {
+    int i = rows[j];
+    int id = qr.GetVal<int>("AgentId", i);
+    std::string inv_name = qr.GetVal<std::string>("InventoryName", i);
+    int state_id = qr.GetVal<int>("ResourceId", i);
+    invs[id][inv_name].push_back(rs[state_id]);
+  }
+
+  for (it = agents_.begin(); it != agents_.end(); ++it) {
+    it->second->InitInv(invs[it->first]);
+  }
+}
+
+int SimInit::StateTime(int agentid) {
+  std::map<int, int>::iterator it = state_times_.find(agentid);
+  return it == state_times_.end() ? t_ : it->second;
 }
 
 void SimInit::LoadBuildSched() {
   std::vector<Cond> conds;
-  conds.push_back(Cond("BuildTime", ">", t_));
+  conds.push_back(Cond("BuildTime", ">=", t_));
   QueryResult qr;
   try {
     qr = b_->Query("BuildSchedule", &conds);
@@ -464,6 +640,27 @@ void SimInit::LoadDecomSched() {
   }
 }
 
+void SimInit::LoadSleeps() {
+  std::vector<Cond> conds;
+  conds.push_back(Cond("Time", "==", t_));
+  QueryResult qr;
+  try {
+    qr = b_->Query("Sleeps", &conds);
+  } catch (std::exception err) {return;}  // table doesn't exist (okay)
+
+  for (int i = 0; i < qr.rows.size(); ++i) {
+    int t = qr.GetVal<int>("WakeTime", i);
+    if (t != -1 && t <= t_) {
+      continue;  // woken before any agent runs at t_
+    }
+    int agentid = qr.GetVal<int>("AgentId", i);
+    TimeListener* tl = dynamic_cast<TimeListener*>(agents_[agentid]);
+    if (tl != NULL) {
+      ctx_->Sleep(tl, t);
+    }
+  }
+}
+
 void SimInit::LoadNextIds() {
   std::vector<Cond> conds;
   conds.push_back(Cond("Time", "==", t_));
@@ -517,48 +714,160 @@ Product::Ptr SimInit::BuildProduct(QueryableBackend* b, int resid) {
 }
 
 Resource::Ptr SimInit::LoadResource(Context* ctx, QueryableBackend* b, int state_id) {
-  std::vector<Cond> conds;
-  conds.push_back(Cond("ResourceId", "==", state_id));
-  QueryResult qr = b->Query("Resources", &conds);
-  ResourceType type = qr.GetVal<ResourceType>("Type");
-  int obj_id = qr.GetVal<int>("ObjId");
-
-  Resource::Ptr r;
-  if (type == Material::kType) {
-    r = LoadMaterial(ctx, b, state_id);
-  } else if (type == Product::kType) {
-    r = LoadProduct(ctx, b, state_id);
-  } else {
-    throw IOError("Invalid resource type in output database: " + type);
+  std::set<int> state_ids;
+  state_ids.insert(state_id);
+  return LoadResources(ctx, b, state_ids)[state_id];
+}
+
+/// The most range queries QueryIds makes for one set of ids.
+static const int kMaxIdRuns = 16;
+
+/// Returns (at least) the rows of table whose col is one of ids. The sorted
+/// ids are split into runs at the (up to kMaxIdRuns - 1) largest gaps between
+/// them, and the rows of each run are fetched with one range query, so that
+/// ids clustered at both ends of a long simulation do not read every row in
+/// between, while the number of queries (each of which may scan the table)
+/// stays bounded. Only gaps wider than the number of ids are split, as
+/// reading the rows in a narrower gap costs less than another query (and
+/// ids are rarely consecutive, e.g., recording a resource takes two state
+/// ids). Rows whose col falls in a gap within a run are returned too.
+static QueryResult QueryIds(QueryableBackend* b, std::string table,
+                            std::string col, const std::set<int>& ids) {
+  std::vector<int> v(ids.begin(), ids.end());
+  std::vector<std::pair<int, int> > gaps;  // (-gap, index of the run's end)
+  for (int i = 0; i + 1 < v.size(); ++i) {
+    if (v[i + 1] - v[i] > v.size()) {
+      gaps.push_back(std::make_pair(v[i] - v[i + 1], i));
+    }
+  }
+  int nsplit = std::min(static_cast<int>(gaps.size()), kMaxIdRuns - 1);
+  std::partial_sort(gaps.begin(), gaps.begin() + nsplit, gaps.end());
+  std::vector<int> ends;
+  for (int i = 0; i < nsplit; ++i) {
+    ends.push_back(gaps[i].second);
   }
+  ends.push_back(v.size() - 1);
+  std::sort(ends.begin(), ends.end());
 
-  r->state_id_ = state_id;
-  r->obj_id_ = obj_id;
-  return r;
+  QueryResult qr;
+  int begin = 0;
+  for (int i = 0; i < ends.size(); ++i) {
+    std::vector<Cond> conds;
+    conds.push_back(Cond(col, ">=", v[begin]));
+    conds.push_back(Cond(col, "<=", v[ends[i]]));
+    QueryResult run = b->Query(table, &conds);
+    if (i == 0) {
+      qr = run;
+    } else {
+      qr.rows.insert(qr.rows.end(), run.rows.begin(), run.rows.end());
+    }
+    begin = ends[i] + 1;
+  }
+  return qr;
 }
 
-Material::Ptr SimInit::LoadMaterial(Context* ctx, QueryableBackend* b, int state_id) {
-  // get special material object state
-  std::vector<Cond> conds;
-  conds.push_back(Cond("ResourceId", "==", state_id));
-  QueryResult qr = b->Query("MaterialInfo", &conds);
-  int prev_decay = qr.GetVal<int>("PrevDecayTime");
-
-  // get general resource object info
-  conds.clear();
-  conds.push_back(Cond("ResourceId", "==", state_id));
-  qr = b->Query("Resources", &conds);
-  double qty = qr.GetVal<double>("Quantity");
-  int stateid = qr.GetVal<int>("QualId");
-
-  // create the composition and material
-  Composition::Ptr comp = LoadComposition(b, stateid);
+std::map<int, Resource::Ptr> SimInit::LoadResources(
+    Context* ctx, QueryableBackend* b, const std::set<int>& state_ids) {
+  std::map<int, Resource::Ptr> rs;
+  if (state_ids.empty()) {
+    return rs;
+  }
+
+  // get general resource object info, std::map<ResourceId, row>
+  QueryResult qres = QueryIds(b, "Resources", "ResourceId", state_ids);
+  std::map<int, int> rows;
+  std::set<int> mat_ids;
+  std::set<int> comp_ids;
+  std::set<int> prod_ids;
+  for (int i = 0; i < qres.rows.size(); ++i) {
+    int state_id = qres.GetVal<int>("ResourceId", i);
+    if (state_ids.count(state_id) == 0) {
+      continue;
+    }
+    rows[state_id] = i;
+    ResourceType type = qres.GetVal<ResourceType>("Type", i);
+    int qualid = qres.GetVal<int>("QualId", i);
+    if (type == Material::kType) {
+      mat_ids.insert(state_id);
+      comp_ids.insert(qualid);
+    } else if (type == Product::kType) {
+      prod_ids.insert(qualid);
+    } else {
+      throw IOError("Invalid resource type in output database: " + type);
+    }
+  }
+  if (rows.size() != state_ids.size()) {
+    throw IOError("Resources missing from the output database");
+  }
+
+  // get special material object state, std::map<ResourceId, PrevDecayTime>
+  std::map<int, int> prev_decay;
+  if (!mat_ids.empty()) {
+    QueryResult qr = QueryIds(b, "MaterialInfo", "ResourceId", mat_ids);
+    for (int i = 0; i < qr.rows.size(); ++i) {
+      prev_decay[qr.GetVal<int>("ResourceId", i)] =
+          qr.GetVal<int>("PrevDecayTime", i);
+    }
+  }
+
+  // get the compositions, which are shared by the materials that refer to
+  // the same one, std::map<QualId, CompMap>
+  std::map<int, CompMap> cms;
+  if (!comp_ids.empty()) {
+    QueryResult qr = QueryIds(b, "Compositions", "QualId", comp_ids);
+    for (int i = 0; i < qr.rows.size(); ++i) {
+      int qualid = qr.GetVal<int>("QualId", i);
+      if (comp_ids.count(qualid) > 0) {
+        int nucid = qr.GetVal<int>("NucId", i);
+        cms[qualid][nucid] = qr.GetVal<double>("MassFrac", i);
+      }
+    }
+  }
+  std::map<int, Composition::Ptr> comps;
+  std::set<int>::const_iterator id;
+  for (id = comp_ids.begin(); id != comp_ids.end(); ++id) {
+    Composition::Ptr c = Composition::CreateFromMass(cms[*id]);
+    c->recorded_ = true;
+    c->id_ = *id;
+    comps[*id] = c;
+  }
+
+  // get special Product internal state, std::map<QualId, Quality>
+  std::map<int, std::string> qualities;
+  if (!prod_ids.empty()) {
+    QueryResult qr = QueryIds(b, "Products", "QualId", prod_ids);
+    for (int i = 0; i < qr.rows.size(); ++i) {
+      qualities[qr.GetVal<int>("QualId", i)] =
+          qr.GetVal<std::string>("Quality", i);
+    }
+  }
+
+  // create the resources
   Agent* dummy = new Dummy(ctx);
-  Material::Ptr mat = Material::Create(dummy, qty, comp);
-  mat->prev_decay_time_ = prev_decay;
+  std::map<int, int>::iterator it;
+  for (it = rows.begin(); it != rows.end(); ++it) {
+    int state_id = it->first;
+    int i = it->second;
+    double qty = qres.GetVal<double>("Quantity", i);
+    int qualid = qres.GetVal<int>("QualId", i);
+
+    Resource::Ptr r;
+    if (mat_ids.count(state_id) > 0) {
+      Material::Ptr mat = Material::Create(dummy, qty, comps[qualid]);
+      mat->prev_decay_time_ = prev_decay[state_id];
+      r = mat;
+    } else {
+      std::string quality = qualities[qualid];
+      // set static quality-stateid map to have same vals as db
+      Product::qualids_[quality] = qualid;
+      r = Product::Create(dummy, qty, quality);
+    }
+    r->state_id_ = state_id;
+    r->obj_id_ = qres.GetVal<int>("ObjId", i);
+    rs[state_id] = r;
+  }
   ctx->DelAgent(dummy);
-
-  return mat;
+  return rs;
 }
 
 Composition::Ptr SimInit::LoadComposition(QueryableBackend* b, int stateid) {
@@ -577,27 +886,4 @@ Composition::Ptr SimInit::LoadComposition(QueryableBackend* b, int stateid) {
   return c;
 }
 
-Product::Ptr SimInit::LoadProduct(Context* ctx, QueryableBackend* b, int state_id) {
-  // get general resource object info
-  std::vector<Cond> conds;
-  conds.push_back(Cond("ResourceId", "==", state_id));
-  QueryResult qr = b->Query("Resources", &conds);
-  double qty = qr.GetVal<double>("Quantity");
-  int stateid = qr.GetVal<int>("QualId");
-
-  // get special Product internal state
-  conds.clear();
-  conds.push_back(Cond("QualId", "==", stateid));
-  qr = b->Query("Products", &conds);
-  std::string quality = qr.GetVal<std::string>("Quality");
-
-  // set static quality-stateid map to have same vals as db
-  Product::qualids_[quality] = stateid;
-
-  Agent* dummy = new Dummy(ctx);
-  Product::Ptr r = Product::Create(dummy, qty, quality);
-  ctx->DelAgent(dummy);
-  return r;
-}
-
 }  // namespace cyclus
@@ -37,20 +37,53 @@ class SimInit {
   /// will run with a new simulation id.
   void Restart(QueryableBackend* b, boost::uuids::uuid sim_id, int t);
 
-  /// NOT IMPLEMENTED. Initializes a simulation branched from prev_sim_id at
-  /// time t with diverging state described in new_sim_id.
+  /// Initializes a simulation branched from prev_sim_id at time t, with data
+  /// from b. The new simulation has the id new_sim_id and records
+  /// prev_sim_id as its parent. Unlike Restart, the new simulation's recorder
+  /// has no backends; register the branch's own backend before running it and
+  /// change its state (e.g. the prototypes or the schedules) as needed.
   ///
-  /// TODO(rwcarlsen): implement
+  /// Branching is a serialize-and-restore round trip, not an in-memory clone
+  /// of a running simulation: the state of the branch is rebuilt from the
+  /// snapshot at t recorded in b, exactly as for Restart, and agents are
+  /// re-initialized from their recorded state with InitFrom(QueryableBackend*)
+  /// rather than copied. Several simulations can be branched from the same
+  /// backend. If it is a CheckpointBack registered with the simulation that
+  /// computed their common prefix, the recorded prefix stays in memory rather
+  /// than being written to and read back from an output file. For example:
+  ///
+  /// @code
+  /// CheckpointBack prefix;
+  /// rec.RegisterBackend(&prefix);
+  /// ... // run the common prefix, killing it at time t
+  /// rec.Flush();
+  /// for (int i = 0; i < n; ++i) {
+  ///   SimInit si;
+  ///   si.Branch(&prefix, rec.sim_id(), t, boost::uuids::random_generator()());
+  ///   si.recorder()->RegisterBackend(backs[i]);
+  ///   ... // apply the parameters of branch i
+  ///   si.timer()->RunSim();
+  ///   si.recorder()->Close();
+  /// }
+  /// @endcode
+  ///
+  /// @warning the next ids of agents, resources, and compositions are global,
+  /// so a branch must be run to completion before the next one is
+  /// initialized in the same process. Branches cannot run concurrently in
+  /// one process.
   void Branch(QueryableBackend* b, boost::uuids::uuid prev_sim_id, int t,
               boost::uuids::uuid new_sim_id);
 
   /// Records a snapshot of the current state of the simulation being managed by
-  /// ctx into the simulation's output database.
+  /// ctx into the simulation's output database. This includes the time
+  /// listeners that are asleep, with the time they wake, in the Sleeps table.
   static void Snapshot(Context* ctx);
 
   /// Records a snapshot of the agent's current internal state into the
   /// simulation's output database.  Note that this should generally not be
-  /// called directly.
+  /// called directly. With SimInfo::delta_snapshots, nothing is recorded if
+  /// the state (including inventories) is the same as the one the agent last
+  /// recorded.
   static void SnapAgent(Agent* m);
 
   /// Returns the initialized context. Note that either Init, Restart, or Branch
@@ -78,6 +111,13 @@ class SimInit {
  private:
   void InitBase(QueryableBackend* b, boost::uuids::uuid simid, int t);
 
+  /// Records the agent's state and inventories unconditionally.
+  static void RecordAgent(Agent* m);
+
+  /// Returns the time of the agent state to restore, which is t_ unless
+  /// snapshots are deltas.
+  int StateTime(int agentid);
+
   void LoadInfo();
   void LoadRecipes();
   void LoadSolverInfo();
@@ -86,19 +126,29 @@ class SimInit {
   void LoadInventories();
   void LoadBuildSched();
   void LoadDecomSched();
+  void LoadSleeps();
   void LoadNextIds();
 
   void* LoadPreconditioner(std::string name);
   ExchangeSolver* LoadGreedySolver(bool exclusive, std::set<std::string> tables);
   ExchangeSolver* LoadCoinSolver(bool exclusive, std::set<std::string> tables);
+  ExchangeSolver* LoadFlowSolver(bool exclusive, std::set<std::string> tables);
   static Resource::Ptr LoadResource(Context* ctx, QueryableBackend* b, int resid);
-  static Material::Ptr LoadMaterial(Context* ctx, QueryableBackend* b, int resid);
-  static Product::Ptr LoadProduct(Context* ctx, QueryableBackend* b, int resid);
+
+  /// Reconstructs the resources with the given state ids, querying each of the
+  /// Resources, MaterialInfo, Compositions, and Products tables at most once.
+  /// Materials with the same composition share one Composition object.
+  static std::map<int, Resource::Ptr> LoadResources(
+      Context* ctx, QueryableBackend* b, const std::set<int>& resids);
   static Composition::Ptr LoadComposition(QueryableBackend* b, int stateid);
 
   // std::map<AgentId, Agent*>
   std::map<int, Agent*> agents_;
 
+  // std::map<AgentId, SimTime> of the agents' last recorded state at or
+  // before t_, with delta snapshots
+  std::map<int, int> state_times_;
+
   Context* ctx_;
   Recorder* rec_;
   Timer ti_;
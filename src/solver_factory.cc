@@ -1,6 +1,8 @@
 #include "solver_factory.h"
 
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include "OsiClpSolverInterface.hpp"
 #include "OsiCbcSolverInterface.hpp"
@@ -119,24 +121,50 @@ void ReportProg(OsiSolverInterface* si) {
   m->dumpMatrix();
 }
 
-void SolveProg(OsiSolverInterface* si, double greedy_obj, bool verbose) {
+double ObjValue(OsiSolverInterface* si, const double* sol) {
+  const double* objs = si->getObjCoefficients();
+  double obj = 0;
+  for (int i = 0; i != si->getNumCols(); i++) {
+    obj += objs[i] * sol[i];
+  }
+  return obj;
+}
+
+bool SolveProg(OsiSolverInterface* si, double greedy_obj, bool verbose,
+               const double* start, double tmax) {
   if (verbose)
     ReportProg(si);
 
   if (HasInt(si)) {
-    const char *argv[] = {"exchng", "-log", "0", "-solve", "-quit"};
-    int argc = 5;
+    std::string secs = std::to_string(tmax);
+    std::vector<const char*> argv;
+    argv.push_back("exchng");
+    argv.push_back("-log");
+    argv.push_back("0");
+    if (tmax > 0) {
+      argv.push_back("-seconds");
+      argv.push_back(secs.c_str());
+    }
+    argv.push_back("-solve");
+    argv.push_back("-quit");
     CbcModel model(*si);
     ObjValueHandler handler(greedy_obj);
     CbcMain0(model);
+    if (start != NULL) {
+      // cbc checks the candidate's feasibility before taking it as incumbent
+      model.setBestSolution(start, si->getNumCols(), ObjValue(si, start),
+                            true);
+    }
     model.passInEventHandler(&handler);
-    CbcMain1(argc, argv, model, CbcCallBack);
-    si->setColSolution(model.getColSolution());
+    CbcMain1(argv.size(), &argv[0], model, CbcCallBack);
     if (verbose) {
       std::cout << "Greedy equivalent time: " << handler.time()
                 << " and obj " << handler.obj()
                 << " and found " << std::boolalpha << handler.found() << "\n";
     }
+    si->setColSolution(model.getColSolution());
+    if (model.bestSolution() == NULL)
+      return false;
   } else {
     // no ints, just solve 'initial lp relaxation'
     si->initialSolve();
@@ -149,6 +177,16 @@ void SolveProg(OsiSolverInterface* si, double greedy_obj, bool verbose) {
                 << " integer: " << std::boolalpha << si->isInteger(i) << "\n";
     }
   }
+  return true;
+}
+
+void SolveProg(OsiSolverInterface* si, double greedy_obj, bool verbose,
+               const double* start) {
+  SolveProg(si, greedy_obj, verbose, start, -1);
+}
+
+void SolveProg(OsiSolverInterface* si, double greedy_obj, bool verbose) {
+  SolveProg(si, greedy_obj, verbose, NULL);
 }
 
 void SolveProg(OsiSolverInterface* si) {
@@ -64,6 +64,30 @@ void SolveProg(OsiSolverInterface* si);
 void SolveProg(OsiSolverInterface* si, bool verbose);
 void SolveProg(OsiSolverInterface* si, double greedy_obj);
 void SolveProg(OsiSolverInterface* si, double greedy_obj, bool verbose);
+
+/// Solves a program, optionally from a starting point.
+///
+/// @param si the solver interface holding the program
+/// @param greedy_obj an objective value to report the time-to-beat for
+/// @param verbose print out a lot to stdout
+/// @param start a candidate solution (one value per column) offered to the MILP
+/// solver as its initial incumbent, or NULL. It is ignored if infeasible. LPs
+/// are warm started through the interface's basis (see setWarmStart) instead.
+void SolveProg(OsiSolverInterface* si, double greedy_obj, bool verbose,
+               const double* start);
+
+/// Solves a program, optionally from a starting point, within a time limit.
+///
+/// @param si the solver interface holding the program
+/// @param greedy_obj an objective value to report the time-to-beat for
+/// @param verbose print out a lot to stdout
+/// @param start a candidate solution offered to the MILP solver, or NULL (see
+/// above)
+/// @param tmax the MILP solver's time limit in seconds, no limit if
+/// non-positive. LPs are not limited.
+/// @return false if the MILP solver found no feasible solution
+bool SolveProg(OsiSolverInterface* si, double greedy_obj, bool verbose,
+               const double* start, double tmax);
 bool HasInt(OsiSolverInterface* si);
 
 }  // namespace cyclus
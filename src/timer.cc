@@ -1,18 +1,74 @@
 // Implements the Timer class
 #include "timer.h"
 
+#include <algorithm>
+#include <exception>
+#include <functional>
 #include <iostream>
+#include <sstream>
 #include <string>
 
 #include "agent.h"
 #include "error.h"
+#include "id_blocks.h"
 #include "logger.h"
+#include "mem_stats.h"
 #include "pyhooks.h"
 #include "sim_init.h"
+#include "work_pool.h"
 
 
 namespace cyclus {
 
+namespace {
+
+/// the fewest ids of each counter reserved for a task of a parallel batch
+const int kMinIdBlock = 16;
+
+/// Runs one of a batch of tasks on a WorkPool. Datum objects and exceptions
+/// are collected per task, and ids are taken from the task's IdBlocks.
+struct TaskWorker {
+  TaskWorker(int n, const std::function<void(int)>& task)
+      : task(task),
+        deferred(n),
+        errors(n),
+        ids(n) {}
+
+  void operator()(int i) {
+    Recorder::Defer(&deferred[i]);
+    IdBlocks::Bind(&ids[i]);
+    try {
+      task(i);
+    } catch (...) {
+      errors[i] = std::current_exception();
+    }
+    IdBlocks::Bind(NULL);
+    Recorder::Defer(NULL);
+  }
+
+  const std::function<void(int)>& task;
+  std::vector<DatumList> deferred;
+  std::vector<std::exception_ptr> errors;
+  std::vector<IdBlocks> ids;
+};
+
+/// Runs one phase of one of a list of time listeners.
+struct PhaseTask {
+  PhaseTask(const std::vector<TimeListener*>& tls,
+            void (TimeListener::*phase)())
+      : tls(tls),
+        phase(phase) {}
+
+  void operator()(int i) const {
+    (tls[i]->*phase)();
+  }
+
+  const std::vector<TimeListener*>& tls;
+  void (TimeListener::*phase)();
+};
+
+}  // namespace
+
 void Timer::RunSim() {
   CLOG(LEV_INFO1) << "Simulation set to run from start="
                   << 0 << " to end=" << si_.duration;
@@ -20,15 +76,22 @@ void Timer::RunSim() {
 
   ExchangeManager<Material> matl_manager(ctx_);
   ExchangeManager<Product> genrsrc_manager(ctx_);
+  last_checkpoint_ = time_;
+  last_checkpoint_clock_ = std::chrono::steady_clock::now();
   while (time_ < si_.duration) {
     CLOG(LEV_INFO1) << "Current time: " << time_;
 
-    if (want_snapshot_) {
+    std::string trigger = CheckpointDue();
+    if (!trigger.empty()) {
+      want_snapshot_ = false;
+      Checkpoint(trigger);
+    } else if (want_snapshot_) {
       want_snapshot_ = false;
       SimInit::Snapshot(ctx_);
     }
 
     // run through phases
+    DoWake();
     DoBuild();
     CLOG(LEV_INFO2) << "Beginning Tick for time: " << time_;
     DoTick();
@@ -38,6 +101,10 @@ void Timer::RunSim() {
     DoTock();
     DoDecom();
 
+    if (si_.memory_stats) {
+      MemStats::Record(ctx_, ctx_->rec_);
+    }
+
 #ifdef CYCLUS_WITH_PYTHON
     EventLoop();
 #endif
@@ -59,7 +126,15 @@ void Timer::RunSim() {
 
 void Timer::DoBuild() {
   // build queued agents
-  std::vector<std::pair<std::string, Agent*> > build_list = build_queue_[time_];
+  std::map<int, std::vector<std::pair<std::string, Agent*> > >::iterator it =
+      build_queue_.find(time_);
+  if (it == build_queue_.end()) {
+    return;
+  }
+
+  // builds can only be scheduled for future timesteps, so this bucket cannot
+  // grow while it is dispatched
+  std::vector<std::pair<std::string, Agent*> >& build_list = it->second;
   for (int i = 0; i < build_list.size(); ++i) {
     Agent* m = ctx_->CreateAgent<Agent>(build_list[i].first);
     Agent* parent = build_list[i].second;
@@ -72,14 +147,11 @@ void Timer::DoBuild() {
       CLOG(LEV_DEBUG1) << "Hey! Listen! Built an Agent without a Parent.";
     }
   }
+  build_queue_.erase(it);
 }
 
 void Timer::DoTick() {
-  for (std::map<int, TimeListener*>::iterator agent = tickers_.begin();
-       agent != tickers_.end();
-       agent++) {
-    agent->second->Tick();
-  }
+  DoPhase(&TimeListener::Tick);
 }
 
 void Timer::DoResEx(ExchangeManager<Material>* matmgr,
@@ -89,11 +161,7 @@ void Timer::DoResEx(ExchangeManager<Material>* matmgr,
 }
 
 void Timer::DoTock() {
-  for (std::map<int, TimeListener*>::iterator agent = tickers_.begin();
-       agent != tickers_.end();
-       agent++) {
-    agent->second->Tock();
-  }
+  DoPhase(&TimeListener::Tock);
 
   if (si_.explicit_inventory || si_.explicit_inventory_compact) {
     std::set<Agent*> ags = ctx_->agent_list_;
@@ -108,6 +176,139 @@ void Timer::DoTock() {
   }
 }
 
+void Timer::DoPhase(void (TimeListener::*phase)()) {
+  // listeners may sleep, wake, or unregister (themselves or others) while
+  // this phase iterates over them. Consecutive thread-safe listeners are
+  // gathered into a batch that is run before the next listener that is not,
+  // and such listeners cannot touch tickers_, so a batch never holds a
+  // listener that was put to sleep or unregistered since it was gathered.
+  std::vector<TimeListener*> par;
+  std::map<int, TimeListener*>::iterator agent = tickers_.begin();
+  while (agent != tickers_.end()) {
+    int id = agent->first;
+    if (si_.threads > 1 && parallel_.count(id) > 0) {
+      par.push_back(agent->second);
+      ++agent;
+      continue;
+    }
+
+    RunParallel(par, phase);
+    par.clear();
+    tickers_changed_ = false;
+    (agent->second->*phase)();
+    if (tickers_changed_) {
+      agent = tickers_.upper_bound(id);
+    } else {
+      ++agent;
+    }
+  }
+  RunParallel(par, phase);
+}
+
+void Timer::RunParallel(const std::vector<TimeListener*>& tls,
+                        void (TimeListener::*phase)()) {
+  if (tls.empty()) {
+    return;
+  }
+  std::vector<int> keys(tls.size());
+  for (int i = 0; i < tls.size(); ++i) {
+    keys[i] = tls[i]->id();
+  }
+  RunBatch(keys, PhaseTask(tls, phase));
+}
+
+void Timer::RunTasks(int n, const std::function<void(int)>& task) {
+  std::vector<int> keys(n);
+  for (int i = 0; i < n; ++i) {
+    keys[i] = -1 - i;
+  }
+  RunBatch(keys, task);
+}
+
+void Timer::RunBatch(const std::vector<int>& keys,
+                     const std::function<void(int)>& task) {
+  // the pool is kept for the rest of the simulation
+  if (pool_ == NULL || pool_->size() != si_.threads) {
+    delete pool_;
+    pool_ = new WorkPool(si_.threads);
+  }
+
+  int n = keys.size();
+  TaskWorker w(n, task);
+  ReserveIds(keys, &w.ids);
+  pool_->Run(n, std::ref(w));
+  ReleaseIds(keys, w.ids);
+
+  for (int i = 0; i < n; ++i) {
+    ctx_->rec_->Replay(&w.deferred[i]);
+  }
+  for (int i = 0; i < n; ++i) {
+    if (w.errors[i]) {
+      std::rethrow_exception(w.errors[i]);
+    }
+  }
+}
+
+void Timer::ReserveIds(const std::vector<int>& keys,
+                       std::vector<IdBlocks>* ids) {
+  std::atomic<int>* counters[] = {&Resource::nextstate_id_,
+                                  &Resource::nextobj_id_,
+                                  &Composition::next_id_};
+  int n = keys.size();
+  std::vector<int> sizes(n);
+  for (int c = 0; c < IdBlocks::N_COUNTERS; ++c) {
+    int total = 0;
+    for (int i = 0; i < n; ++i) {
+      std::map<int, std::vector<int> >::iterator it = id_use_.find(keys[i]);
+      int last = it == id_use_.end() ? 0 : it->second[c];
+      sizes[i] = std::max(kMinIdBlock, 2 * last);
+      total += sizes[i];
+    }
+    int first = counters[c]->fetch_add(total);
+    for (int i = 0; i < n; ++i) {
+      (*ids)[i].Reserve(static_cast<IdBlocks::Counter>(c), first, sizes[i]);
+      first += sizes[i];
+    }
+  }
+}
+
+void Timer::ReleaseIds(const std::vector<int>& keys,
+                       const std::vector<IdBlocks>& ids) {
+  bool overflowed = false;
+  for (int i = 0; i < keys.size(); ++i) {
+    std::vector<int>& use = id_use_[keys[i]];
+    use.resize(IdBlocks::N_COUNTERS);
+    for (int c = 0; c < IdBlocks::N_COUNTERS; ++c) {
+      IdBlocks::Counter cnt = static_cast<IdBlocks::Counter>(c);
+      use[c] = ids[i].used(cnt);
+      overflowed = overflowed || ids[i].overflowed(cnt);
+    }
+  }
+  if (overflowed) {
+    std::stringstream ss;
+    ss << "a thread-safe agent created more resources or compositions at "
+       << "time " << time_ << " than were reserved for it, so some of their "
+       << "ids depend on thread scheduling";
+    Warn<VALUE_WARNING>(ss.str());
+  }
+}
+
+bool Timer::IsParallel(TimeListener* tl) {
+  Agent* a = dynamic_cast<Agent*>(tl);
+  if (a == NULL) {
+    return false;
+  }
+
+  // annotations are parsed once per archetype
+  std::map<std::string, bool>::iterator it = parallel_specs_.find(a->spec());
+  if (it != parallel_specs_.end()) {
+    return it->second;
+  }
+  Json::Value par = a->annotations()["parallel"];
+  bool p = par.isBool() && par.asBool();
+  parallel_specs_[a->spec()] = p;
+  return p;
+}
 
 void Timer::RecordInventories(Agent* a) {
   Inventories invs = a->SnapshotInv();
@@ -158,22 +359,93 @@ void Timer::RecordInventory(Agent* a, std::string name, Material::Ptr m) {
 
 void Timer::DoDecom() {
   // decommission queued agents
-  std::vector<Agent*> decom_list = decom_queue_[time_];
+  std::map<int, std::vector<Agent*> >::iterator it = decom_queue_.find(time_);
+  if (it == decom_queue_.end()) {
+    return;
+  }
+
+  // agents may be scheduled for decommissioning at the current time while
+  // this bucket is dispatched, so it is indexed (map nodes are never
+  // invalidated by insertion) rather than iterated
+  std::vector<Agent*>& decom_list = it->second;
   for (int i = 0; i < decom_list.size(); ++i) {
     Agent* m = decom_list[i];
+    if (m == NULL) {
+      continue;  // rescheduled
+    }
+    decom_index_.erase(m);
     if (m->parent() != NULL) {
       m->parent()->DecomNotify(m);
     }
     m->Decommission();
   }
+  decom_queue_.erase(it);
+}
+
+void Timer::DoWake() {
+  std::map<int, std::vector<int> >::iterator it = wake_queue_.find(time_);
+  if (it == wake_queue_.end()) {
+    return;
+  }
+
+  std::vector<int>& ids = it->second;
+  for (int i = 0; i < ids.size(); ++i) {
+    std::map<int, std::pair<TimeListener*, int> >::iterator s =
+        sleepers_.find(ids[i]);
+    // skip listeners that were woken early or put back to sleep since
+    if (s != sleepers_.end() && s->second.second == time_) {
+      Wake(ids[i]);
+    }
+  }
+  wake_queue_.erase(it);
 }
 
 void Timer::RegisterTimeListener(TimeListener* agent) {
+  sleepers_.erase(agent->id());
   tickers_[agent->id()] = agent;
+  tickers_changed_ = true;
+  if (IsParallel(agent)) {
+    parallel_.insert(agent->id());
+  }
 }
 
 void Timer::UnregisterTimeListener(TimeListener* tl) {
   tickers_.erase(tl->id());
+  tickers_changed_ = true;
+  sleepers_.erase(tl->id());
+  parallel_.erase(tl->id());
+  id_use_.erase(tl->id());
+}
+
+void Timer::Sleep(TimeListener* tl, int t) {
+  if (t != -1 && t <= time_) {
+    throw ValueError("Cannot sleep until t <= [current-time]");
+  }
+
+  int id = tl->id();
+  std::map<int, TimeListener*>::iterator it = tickers_.find(id);
+  if (it != tickers_.end()) {
+    tickers_.erase(it);
+    tickers_changed_ = true;
+  } else if (sleepers_.count(id) == 0) {
+    throw ValueError("Cannot put an unregistered time listener to sleep");
+  }
+
+  sleepers_[id] = std::make_pair(tl, t);
+  if (t != -1) {
+    wake_queue_[t].push_back(id);
+  }
+}
+
+void Timer::Wake(int id) {
+  std::map<int, std::pair<TimeListener*, int> >::iterator it =
+      sleepers_.find(id);
+  if (it == sleepers_.end()) {
+    return;
+  }
+  tickers_[id] = it->second.first;
+  tickers_changed_ = true;
+  sleepers_.erase(it);
 }
 
 void Timer::SchedBuild(Agent* parent, std::string proto_name, int t) {
@@ -191,38 +463,75 @@ void Timer::SchedDecom(Agent* m, int t) {
   // It is possible that a single agent may be scheduled for decommissioning
   // multiple times. If this happens, we cannot just add it to the queue again
   // - the duplicate entries will result in a double delete attempt and
-  // segfaults and otherwise bad things.  Remove previous decommissionings
+  // segfaults and otherwise bad things.  Cancel the previous decommissioning
   // before scheduling this new one.
-  std::map<int, std::vector<Agent*> >::iterator it;
-  bool done = false;
-  for (it = decom_queue_.begin(); it != decom_queue_.end(); ++it) {
-    int t = it->first;
-    std::vector<Agent*> ags = it->second;
-    for (int i = 0; i < ags.size(); i++) {
-      if (ags[i] == m) {
-        CLOG(LEV_WARN) << "scheduled over previous decommissioning of " << m->id();
-        decom_queue_[t].erase(decom_queue_[t].begin()+i);
-        done = true;
-        break;
-      }
-    }
-    if (done) {
-      break;
-    }
+  std::map<Agent*, std::pair<int, int> >::iterator it = decom_index_.find(m);
+  if (it != decom_index_.end()) {
+    CLOG(LEV_WARN) << "scheduled over previous decommissioning of " << m->id();
+    decom_queue_[it->second.first][it->second.second] = NULL;
   }
 
-  decom_queue_[t].push_back(m);
+  std::vector<Agent*>& decom_list = decom_queue_[t];
+  decom_index_[m] = std::make_pair(t, static_cast<int>(decom_list.size()));
+  decom_list.push_back(m);
 }
 
 int Timer::time() {
   return time_;
 }
 
+std::string Timer::CheckpointDue() {
+  if (time_ == last_checkpoint_) {
+    return "";
+  }
+  if (si_.checkpoint_interval > 0 &&
+      time_ - last_checkpoint_ >= si_.checkpoint_interval) {
+    return "interval";
+  }
+  if (si_.checkpoint_minutes > 0) {
+    std::chrono::duration<double> dt =
+        std::chrono::steady_clock::now() - last_checkpoint_clock_;
+    if (dt.count() >= 60 * si_.checkpoint_minutes) {
+      return "wallclock";
+    }
+  }
+  return "";
+}
+
+void Timer::Checkpoint(std::string trigger) {
+  CLOG(LEV_INFO2) << "Checkpointing at time: " << time_;
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  SimInit::Snapshot(ctx_);
+  ctx_->rec_->Flush();
+  last_checkpoint_ = time_;
+  last_checkpoint_clock_ = std::chrono::steady_clock::now();
+  std::chrono::duration<double> dt = last_checkpoint_clock_ - start;
+
+  // the cost includes the flush, so the row is recorded after it and then
+  // flushed on its own for the checkpoint on disk to include it
+  ctx_->NewDatum("Checkpoints")
+      ->AddVal("Time", time_)
+      ->AddVal("Trigger", trigger)
+      ->AddVal("WallSecs", dt.count())
+      ->Record();
+  ctx_->rec_->Flush();
+}
+
 void Timer::Reset() {
+  delete pool_;
+  pool_ = NULL;
   tickers_.clear();
+  sleepers_.clear();
+  wake_queue_.clear();
+  parallel_.clear();
+  parallel_specs_.clear();
+  id_use_.clear();
   build_queue_.clear();
   decom_queue_.clear();
+  decom_index_.clear();
   si_ = SimInfo(0);
+  Composition::ClearDecayCache();
 }
 
 void Timer::Initialize(Context* ctx, SimInfo si) {
@@ -234,6 +543,11 @@ void Timer::Initialize(Context* ctx, SimInfo si) {
   ctx_ = ctx;
   time_ = 0;
   si_ = si;
+  MemStats::Enable(si.memory_stats);
+  MemStats::AddExisting(MemStats::DATUM, ctx_->rec_->dump_count(),
+                        sizeof(Datum));
+  Composition::ClearDecayCache();
+  Composition::SetDecayCacheSize(si.decay_cache_size);
 
   if (si.branch_time > -1) {
     time_ = si.branch_time;
@@ -244,6 +558,17 @@ int Timer::dur() {
   return si_.duration;
 }
 
-Timer::Timer() : time_(0), si_(0), want_snapshot_(false), want_kill_(false) {}
+Timer::Timer()
+    : time_(0),
+      si_(0),
+      want_snapshot_(false),
+      want_kill_(false),
+      last_checkpoint_(0),
+      tickers_changed_(false),
+      pool_(NULL) {}
+
+Timer::~Timer() {
+  delete pool_;
+}
 
 }  // namespace cyclus
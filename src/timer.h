@@ -1,6 +1,10 @@
 #ifndef CYCLUS_SRC_TIMER_H_
 #define CYCLUS_SRC_TIMER_H_
 
+#include <chrono>
+#include <functional>
+#include <set>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -17,13 +21,71 @@ class SimInitTest;
 namespace cyclus {
 
 class Agent;
+class IdBlocks;
+class WorkPool;
 
 /// Controls simulation timestepping and inter-timestep phases.
+///
+/// Time listeners that are not sleeping are ticked and tocked in order of id.
+/// If SimInfo::threads is greater than 1, the time listeners of agents whose
+/// archetype is annotated as thread-safe, i.e.,
+///
+/// @code
+/// #pragma cyclus note {"parallel": True}
+/// @endcode
+///
+/// are instead ticked (and tocked) concurrently on a persistent work-stealing
+/// pool of that many threads (see WorkPool). Each run of such time listeners
+/// with consecutive ids is a batch that is run in its place in id order, i.e.,
+/// after the time listeners with lower ids and before those with higher ids.
+/// Such agents' Tick and Tock may only touch their own state, including the
+/// resources they hold, and create and record Datum objects. They may create
+/// resources with Material::Create, read, decay, transmute, extract from, and
+/// absorb their own resources, and let resources be freed: the resource and
+/// composition id counters, compositions' lazily evaluated masses, shared
+/// decay chains, and decay cache, and the block pools resources are allocated
+/// from are thread safe. They must not create resources with Product::Create
+/// (the table of product qualities is not thread safe), trade, schedule
+/// builds or decommissionings, or (un)register, sleep, or wake time
+/// listeners. Python archetypes must not be annotated this way.
+///
+/// Datum objects recorded by such agents are replayed in order of agent id
+/// once their batch has run. Before a batch runs, each of its agents is given
+/// a block of resource state, resource object, and composition ids, one after
+/// another in id order. A block holds at least 16 ids and twice as many as
+/// the agent used in its last batch, and the agent's new ids are taken from
+/// it (see IdBlocks). The ids of the resources the agents create therefore do
+/// not depend on thread scheduling, and neither does the output, with two
+/// exceptions:
+///
+///   - if an agent uses up a block, its further ids come from the shared
+///     counter in whatever order the threads get to them, and a warning is
+///     issued; its next block is sized to fit.
+///   - if agents of one batch decay compositions that share a decay chain
+///     (e.g., materials made from the same recipe), which agent computes and
+///     names a decayed composition, and so its id and the place its
+///     Compositions rows are recorded, depends on thread scheduling.
+///
+/// In either case the output of a run is not reproducible. Unused ids of
+/// each block are skipped.
+///
+/// If SimInfo::checkpoint_interval or SimInfo::checkpoint_minutes is set, the
+/// Timer also takes a snapshot at the beginning of a timestep once that many
+/// timesteps or wall-clock minutes have passed since the last automatic
+/// snapshot (or the start of the run), and flushes the recorder so that the
+/// snapshot reaches the backends. The wall-clock seconds each such checkpoint
+/// took are recorded in the Checkpoints table.
+///
+/// If SimInfo::memory_stats is set, the Timer records MemStats at the end of
+/// every timestep.
 class Timer {
   friend class ::SimInitTest;
+  friend class SimInit;
  public:
   Timer();
 
+  ~Timer();
+
   /// Sets intial time-related parameters for the simulation.
   ///
   /// @param ctx simulation context
@@ -43,6 +105,15 @@ class Timer {
   /// Agents should unregister from their Decommission method.
   void UnregisterTimeListener(TimeListener* tl);
 
+  /// Stops sending tick/tock notifications to a registered time listener
+  /// until timestep t (if t is not -1) or until it is woken (see
+  /// Context::Sleep).
+  void Sleep(TimeListener* tl, int t = -1);
+
+  /// Resumes sending tick/tock notifications to the time listener with the
+  /// given id, if it is sleeping.
+  void Wake(int id);
+
 
   /// Schedules the named prototype to be built for the specified parent at
   /// timestep t.
@@ -59,6 +130,14 @@ class Timer {
   /// Schedules the simulation to be terminated at the end of this timestep.
   void KillSim() { want_kill_ = true; }
 
+  /// Runs task(i) for every i in [0, n) concurrently on SimInfo::threads
+  /// threads, on the same pool as thread-safe time listeners. Each task gets
+  /// its own block of ids, as agents do. Datum objects recorded by the tasks
+  /// are replayed in order of i once all have run, and then the exception
+  /// thrown by the lowest i, if any, is rethrown. Tasks are bound by the same
+  /// rules as the Tick and Tock of thread-safe agents.
+  void RunTasks(int n, const std::function<void(int)>& task);
+
   /// Returns the current time, in months since the simulation started.
   ///
   /// @return the current time
@@ -70,6 +149,9 @@ class Timer {
   int dur();
 
  private:
+  /// wakes all time listeners sleeping until the current timestep.
+  void DoWake();
+
   /// builds all agents queued for the current timestep.
   void DoBuild();
 
@@ -85,12 +167,46 @@ class Timer {
   /// notifications.
   void DoTock();
 
+  /// runs the given phase (Tick or Tock) of all time listeners that are not
+  /// sleeping, in order of id.
+  void DoPhase(void (TimeListener::*phase)());
+
+  /// runs the given phase (Tick or Tock) of a batch of thread-safe time
+  /// listeners on si_.threads threads.
+  void RunParallel(const std::vector<TimeListener*>& tls,
+                   void (TimeListener::*phase)());
+
+  /// runs task(i) for every i in [0, keys.size()) as RunTasks does; the ids
+  /// reserved for task i are sized by the use of the last task with key
+  /// keys[i], i.e., the time listener's id or, for RunTasks, -1 - i.
+  void RunBatch(const std::vector<int>& keys,
+                const std::function<void(int)>& task);
+
+  /// reserves the id blocks of a batch, in order of the tasks
+  void ReserveIds(const std::vector<int>& keys, std::vector<IdBlocks>* ids);
+
+  /// notes the ids each task of a batch used, and warns if any used up a
+  /// block
+  void ReleaseIds(const std::vector<int>& keys,
+                  const std::vector<IdBlocks>& ids);
+
+  /// @return true if tl's agent is annotated as thread-safe
+  bool IsParallel(TimeListener* tl);
+
   void RecordInventories(Agent* a);
   void RecordInventory(Agent* a, std::string name, Material::Ptr m);
 
   /// decommissions all agents queued for the current timestep.
   void DoDecom();
 
+  /// @return why an automatic checkpoint is due at the current timestep
+  /// ("interval" or "wallclock"), or an empty string if none is.
+  std::string CheckpointDue();
+
+  /// Snapshots the simulation, flushes the recorder, and records and flushes
+  /// the cost.
+  void Checkpoint(std::string trigger);
+
   Context* ctx_;
 
   /// The current time, measured in months from when the simulation
@@ -102,14 +218,50 @@ class Timer {
   bool want_snapshot_;
   bool want_kill_;
 
+  /// the timestep and wall-clock time of the last automatic checkpoint, or
+  /// of the start of the run
+  int last_checkpoint_;
+  std::chrono::steady_clock::time_point last_checkpoint_clock_;
+
   /// Concrete agents that desire to receive tick and tock notifications
   std::map<int, TimeListener*> tickers_;
 
+  /// Sleeping time listeners and the time they should be woken (-1 if
+  /// indefinitely). A time listener is in either tickers_ or sleepers_.
+  std::map<int, std::pair<TimeListener*, int> > sleepers_;
+
+  // std::map<time,std::vector<time listener id> >
+  std::map<int, std::vector<int> > wake_queue_;
+
+  /// set whenever tickers_ is modified, so that phases iterating over it
+  /// can tell whether their iterator is still valid
+  bool tickers_changed_;
+
+  /// ids of the time listeners that may be ticked and tocked concurrently
+  std::set<int> parallel_;
+
+  /// whether agents of each archetype (by spec) are thread-safe
+  std::map<std::string, bool> parallel_specs_;
+
+  /// the number of ids of each IdBlocks counter the last parallel task with
+  /// each key used (see RunBatch)
+  std::map<int, std::vector<int> > id_use_;
+
+  /// the threads thread-safe time listeners are run on, created on first use
+  WorkPool* pool_;
+
   // std::map<time,std::vector<std::pair<prototype, parent> > >
   std::map<int, std::vector<std::pair<std::string, Agent*> > > build_queue_;
 
   // std::map<time,std::vector<config> >
+  //
+  // Each time bucket is dispatched in place and then erased. A cancelled
+  // (i.e., rescheduled) decommissioning leaves a NULL in its slot rather than
+  // being erased, so the slots of other agents stay valid.
   std::map<int, std::vector<Agent*> > decom_queue_;
+
+  // std::map<agent,std::pair<time, slot in decom_queue_[time]> >
+  std::map<Agent*, std::pair<int, int> > decom_index_;
 };
 
 }  // namespace cyclus
@@ -1,6 +1,8 @@
 #ifndef CYCLUS_SRC_TRADE_EXECUTOR_H_
 #define CYCLUS_SRC_TRADE_EXECUTOR_H_
 
+#include <algorithm>
+#include <cstddef>
 #include <map>
 #include <set>
 #include <utility>
@@ -16,23 +18,37 @@ namespace cyclus {
 /// @class TradeExecutor::Context
 ///
 /// @brief a holding class for information related to a TradeExecutor
+///
+/// Trades and responses are each kept in one flat buffer, sorted once, and
+/// the trades of a supplier, the responses to a requester, and the responses
+/// from a supplier to a requester are ranges of those buffers.
 template <class T>
 struct TradeExecutionContext {
-  std::set<Trader*> suppliers;
-  std::set<Trader*> requesters;
+  typedef std::pair<Trade<T>, typename T::Ptr> Response;
+
+  /// a [begin, end) range of indices into trades or responses
+  typedef std::pair<int, int> Range;
+
+  std::set<Trader*, TraderCompare> requesters;
+
+  // the trades, grouped by supplier in supplier order, with each supplier's
+  // trades in the order they were given
+  std::vector< Trade<T> > trades;
 
-  // the key is the supplier
-  std::map<Trader*, std::vector< Trade<T> > > trades_by_supplier;
+  // each supplier and its range of trades, in supplier order
+  std::vector< std::pair<Trader*, Range> > by_supplier;
 
-  // the key is the requester, values are a vector of the target Trade with the
-  // associated response resource provided by the supplier
-  std::map<Trader*, std::vector< std::pair<Trade<T>, typename T::Ptr> > >
-      trades_by_requester;
+  // the responses, grouped by requester in requester order, with each
+  // requester's responses ordered by supplier
+  std::vector<Response> responses;
 
-  // by convention, the first trader is the supplier, the second is the
-  // requester
-  std::map<std::pair<Trader*, Trader*>,
-      std::vector< std::pair<Trade<T>, typename T::Ptr> > > all_trades;
+  // each requester and its range of responses, in requester order
+  std::vector< std::pair<Trader*, Range> > by_requester;
+
+  // each supplier-requester pair and its range of responses, in the order of
+  // responses. By convention, the first trader is the supplier, the second is
+  // the requester.
+  std::vector< std::pair<std::pair<Trader*, Trader*>, Range> > by_pair;
 };
 
 /// @class TradeExecutor
@@ -43,6 +59,19 @@ struct TradeExecutionContext {
 ///     #. Collecting responses for the group of trades from each supplier
 ///     #. Grouping all responses by requester (receiver)
 ///     #. Sending all grouped responses to their respective requester
+///
+/// If SimInfo::threads is greater than 1, consecutive suppliers (in supplier
+/// order) whose archetype is annotated with
+///
+/// @code
+/// #pragma cyclus note {"parallel_trades": True}
+/// @endcode
+///
+/// are asked for their responses concurrently (see Context::RunTasks). Their
+/// GetMatlTrades (or GetProductTrades) is bound by the rules for the Tick and
+/// Tock of thread-safe agents (see Timer): it may extract the responses from
+/// resources the supplier holds or create them with Material::Create, but not
+/// create resources with Product::Create.
 template <class T>
 class TradeExecutor {
  public:
@@ -63,39 +92,59 @@ class TradeExecutor {
   /// responses to requesters
   void ExecuteTrades(Context* ctx) {
     GroupTradesBySupplier(trade_ctx_, trades_);
-    GetTradeResponses(trade_ctx_);
+    GetTradeResponses(trade_ctx_, ctx);
     if (ctx != NULL) {
       RecordTrades(ctx);
     }
     SendTradeResources(trade_ctx_);
+    if (ctx != NULL) {
+      WakeRequesters(ctx);
+    }
+  }
+
+  /// @brief wake the (possibly sleeping) agents that received resources, so
+  /// that they are tocked in the current timestep
+  void WakeRequesters(Context* ctx) {
+    std::set<Trader*, TraderCompare>::iterator it;
+    for (it = trade_ctx_.requesters.begin();
+         it != trade_ctx_.requesters.end(); ++it) {
+      if ((*it)->manager() != NULL) {
+        ctx->Wake((*it)->manager());
+      }
+    }
   }
 
   /// @brief Record all trades with the appropriate backends
   ///
+  /// Each trade is one Transactions datum. Trades are recorded in supplier
+  /// and then requester order, so that transaction ids do not depend on the
+  /// requester-first grouping of by_pair.
+  ///
   /// @param ctx the Context through which communication with backends will
   /// occur
   void RecordTrades(Context* ctx) {
-    // record all trades
-    typename std::map<std::pair<Trader*, Trader*>,
-        std::vector< std::pair<Trade<T>, typename T::Ptr> > >::iterator m_it;
-    for (m_it = trade_ctx_.all_trades.begin();
-         m_it != trade_ctx_.all_trades.end(); ++m_it) {
-      Agent* supplier = m_it->first.first->manager();
-      Agent* requester = m_it->first.second->manager();
-      typename std::vector< std::pair<Trade<T>, typename T::Ptr> >&
-          trades = m_it->second;
-      typename std::vector< std::pair<Trade<T>, typename T::Ptr> >::iterator
-          v_it;
-      for (v_it = trades.begin(); v_it != trades.end(); ++v_it) {
-        Trade<T>& trade = v_it->first;
-        typename T::Ptr rsrc =  v_it->second;
-        ctx->NewDatum("Transactions")
+    typedef typename TradeExecutionContext<T>::Range Range;
+    const std::string title("Transactions");
+    int time = ctx->time();
+    std::vector<int> order(trade_ctx_.by_pair.size());
+    for (int p = 0; p != order.size(); ++p) {
+      order[p] = p;
+    }
+    std::sort(order.begin(), order.end(), PairLess(trade_ctx_));
+    for (int k = 0; k != order.size(); ++k) {
+      int p = order[k];
+      int sender_id = trade_ctx_.by_pair[p].first.first->manager()->id();
+      int receiver_id = trade_ctx_.by_pair[p].first.second->manager()->id();
+      const Range& r = trade_ctx_.by_pair[p].second;
+      for (int i = r.first; i != r.second; ++i) {
+        ctx->NewDatum(title)
             ->AddVal("TransactionId", ctx->NextTransactionID())
-            ->AddVal("SenderId", supplier->id())
-            ->AddVal("ReceiverId", requester->id())
-            ->AddVal("ResourceId", rsrc->state_id())
-            ->AddVal("Commodity", trade.request->commodity())
-            ->AddVal("Time", ctx->time())
+            ->AddVal("SenderId", sender_id)
+            ->AddVal("ReceiverId", receiver_id)
+            ->AddVal("ResourceId", trade_ctx_.responses[i].second->state_id())
+            ->AddVal("Commodity",
+                     trade_ctx_.responses[i].first.request->commodity())
+            ->AddVal("Time", time)
             ->Record();
       }
     }
@@ -109,58 +158,226 @@ class TradeExecutor {
   }
 
  private:
+  /// orders indices into by_pair by supplier and then requester
+  struct PairLess {
+    explicit PairLess(const TradeExecutionContext<T>& trade_ctx)
+        : trade_ctx(trade_ctx) {}
+
+    bool operator()(int lhs, int rhs) const {
+      return comp(trade_ctx.by_pair[lhs].first, trade_ctx.by_pair[rhs].first);
+    }
+
+    const TradeExecutionContext<T>& trade_ctx;
+    TraderCompare comp;
+  };
+
   const std::vector< Trade<T> >& trades_;
   TradeExecutionContext<T> trade_ctx_;
 };
 
-/// @brief populates suppliers_, requesters_, and trades_by_supplier_
+/// @brief orders indices into a vector of trades by the trades' suppliers
+template <class T>
+struct TradeSupplierLess {
+  explicit TradeSupplierLess(const std::vector< Trade<T> >& trades)
+      : trades(trades) {}
+
+  bool operator()(int lhs, int rhs) const {
+    return comp(trades[lhs].bid->bidder(), trades[rhs].bid->bidder());
+  }
+
+  const std::vector< Trade<T> >& trades;
+  TraderCompare comp;
+};
+
+/// @brief orders responses by their requesters
+template <class T>
+struct ResponseRequesterLess {
+  bool operator()(const std::pair<Trade<T>, typename T::Ptr>& lhs,
+                  const std::pair<Trade<T>, typename T::Ptr>& rhs) const {
+    return comp(lhs.first.request->requester(),
+                rhs.first.request->requester());
+  }
+
+  TraderCompare comp;
+};
+
+/// @brief collects the responses of a run of consecutive suppliers, each into
+/// its own buffer, as Context::RunTasks tasks
+template <class T>
+struct SupplierResponses {
+  SupplierResponses(const TradeExecutionContext<T>& trade_ctx, int first,
+                    int n)
+      : trade_ctx(trade_ctx),
+        first(first),
+        responses(n) {}
+
+  void operator()(int i) {
+    typedef typename TradeExecutionContext<T>::Range Range;
+    const std::pair<Trader*, Range>& s = trade_ctx.by_supplier[first + i];
+    std::vector< Trade<T> > trades(trade_ctx.trades.begin() + s.second.first,
+                                   trade_ctx.trades.begin() + s.second.second);
+    responses[i].reserve(trades.size());
+    PopulateTradeResponses(s.first, trades, responses[i]);
+  }
+
+  const TradeExecutionContext<T>& trade_ctx;
+  int first;
+  std::vector< std::vector< std::pair<Trade<T>, typename T::Ptr> > >
+      responses;
+};
+
+/// @return whether the agent managing a supplier is annotated as having
+/// thread-safe trade responses. Annotations are parsed once per archetype.
+inline bool ParallelTrades(Trader* supplier,
+                           std::map<std::string, bool>* specs) {
+  Agent* a = supplier->manager();
+  if (a == NULL) {
+    return false;
+  }
+  std::map<std::string, bool>::iterator it = specs->find(a->spec());
+  if (it != specs->end()) {
+    return it->second;
+  }
+  Json::Value par = a->annotations()["parallel_trades"];
+  bool p = par.isBool() && par.asBool();
+  (*specs)[a->spec()] = p;
+  return p;
+}
+
+/// @brief populates requesters, trades, and by_supplier
+///
+/// The trades are sorted by supplier once and copied into a buffer of the
+/// right size, with each supplier's trades in the order they were given.
 template<class T>
 void GroupTradesBySupplier(TradeExecutionContext<T>& trade_ctx,
                            const std::vector< Trade<T> >& trades) {
-  typename std::vector< Trade<T> >::const_iterator it;
-  for (it = trades.begin(); it != trades.end(); ++it) {
-    trade_ctx.trades_by_supplier[it->bid->bidder()].push_back(*it);
-    trade_ctx.suppliers.insert(it->bid->bidder());
-    trade_ctx.requesters.insert(it->request->requester());
+  typedef typename TradeExecutionContext<T>::Range Range;
+  std::vector<int> order(trades.size());
+  for (int i = 0; i != order.size(); ++i) {
+    order[i] = i;
+    trade_ctx.requesters.insert(trades[i].request->requester());
+  }
+  std::stable_sort(order.begin(), order.end(), TradeSupplierLess<T>(trades));
+
+  trade_ctx.trades.clear();
+  trade_ctx.by_supplier.clear();
+  trade_ctx.trades.reserve(trades.size());
+  int i = 0;
+  while (i != order.size()) {
+    Trader* supplier = trades[order[i]].bid->bidder();
+    int begin = i;
+    for (; i != order.size() && trades[order[i]].bid->bidder() == supplier;
+         ++i) {
+      trade_ctx.trades.push_back(trades[order[i]]);
+    }
+    trade_ctx.by_supplier.push_back(
+        std::make_pair(supplier, Range(begin, i)));
   }
 }
 
 /// @brief queries each supplier for the responses to thier matched trade and
-/// populates trades_by_requester_ and all_trades_ with the results
+/// populates responses, by_requester, and by_pair with the results
+///
+/// The responses are collected into one buffer in supplier order and then
+/// grouped by requester with a single stable sort, so that each requester's
+/// responses are ordered by supplier. If ctx is given and SimInfo::threads is
+/// greater than 1, runs of consecutive suppliers with thread-safe trade
+/// responses are queried concurrently (see TradeExecutor).
 template<class T>
-static void GetTradeResponses(TradeExecutionContext<T>& trade_ctx) {
-  std::set<Trader*>::iterator it;
-  for (it = trade_ctx.suppliers.begin(); it != trade_ctx.suppliers.end();
-       ++it) {
-    // get responses
-    Trader* supplier = *it;
-    std::vector< std::pair<Trade<T>, typename T::Ptr> > responses;
-    PopulateTradeResponses(supplier, trade_ctx.trades_by_supplier[supplier],
-                           responses);
-
-    // populate containers
-    typename std::vector< std::pair<Trade<T>, typename T::Ptr> >::iterator r_it;
-    for (r_it = responses.begin(); r_it != responses.end(); ++r_it) {
-      // @todo unsure if this is needed...
-      // Trade<T>& trade = r_it->first;
-      // typename T::Ptr rsrc= r_it->second;
-      // if (rsrc->quantity() != trade.amt) {
-      //   throw ValueError("Trade amt and resource qty must match");
-      // }
-      Trader* requester = r_it->first.request->requester();
-      trade_ctx.trades_by_requester[requester].push_back(*r_it);
-      trade_ctx.all_trades[std::make_pair(supplier, requester)].push_back(*r_it);
+static void GetTradeResponses(TradeExecutionContext<T>& trade_ctx,
+                              Context* ctx = NULL) {
+  typedef std::pair<Trade<T>, typename T::Ptr> Response;
+  typedef typename TradeExecutionContext<T>::Range Range;
+  bool threads = ctx != NULL && ctx->sim_info().threads > 1;
+  std::map<std::string, bool> specs;
+
+  // get responses, in supplier order. Each supplier is handed an empty
+  // buffer, as it may not expect to be appending to others' responses.
+  std::vector<Response>& responses = trade_ctx.responses;
+  std::vector< Trade<T> > trades;
+  std::vector<Response> batch;
+  responses.clear();
+  responses.reserve(trade_ctx.trades.size());
+  int s = 0;
+  while (s != trade_ctx.by_supplier.size()) {
+    int end = s;
+    while (threads && end != trade_ctx.by_supplier.size() &&
+           ParallelTrades(trade_ctx.by_supplier[end].first, &specs)) {
+      ++end;
+    }
+    if (end - s > 1) {
+      SupplierResponses<T> w(trade_ctx, s, end - s);
+      ctx->RunTasks(end - s, std::ref(w));
+      for (int i = 0; i != w.responses.size(); ++i) {
+        responses.insert(responses.end(), w.responses[i].begin(),
+                         w.responses[i].end());
+      }
+      s = end;
+      continue;
     }
+
+    const std::pair<Trader*, Range>& sup = trade_ctx.by_supplier[s];
+    trades.assign(trade_ctx.trades.begin() + sup.second.first,
+                  trade_ctx.trades.begin() + sup.second.second);
+    batch.clear();
+    PopulateTradeResponses(sup.first, trades, batch);
+    responses.insert(responses.end(), batch.begin(), batch.end());
+    ++s;
+  }
+
+  // group by requester and then by supplier
+  std::stable_sort(responses.begin(), responses.end(),
+                   ResponseRequesterLess<T>());
+  trade_ctx.by_requester.clear();
+  trade_ctx.by_pair.clear();
+  int i = 0;
+  while (i != responses.size()) {
+    Trader* requester = responses[i].first.request->requester();
+    int req_begin = i;
+    while (i != responses.size() &&
+           responses[i].first.request->requester() == requester) {
+      Trader* supplier = responses[i].first.bid->bidder();
+      int pair_begin = i;
+      for (; i != responses.size() &&
+             responses[i].first.request->requester() == requester &&
+             responses[i].first.bid->bidder() == supplier;
+           ++i) {}
+      trade_ctx.by_pair.push_back(std::make_pair(
+          std::make_pair(supplier, requester), Range(pair_begin, i)));
+    }
+    trade_ctx.by_requester.push_back(
+        std::make_pair(requester, Range(req_begin, i)));
   }
 }
 
+/// @brief sends each requester its range of responses
+///
+/// AcceptTrades takes a vector, so each range is swapped into a buffer that
+/// is reused for every requester, and swapped back once accepted.
 template <class T>
 static void SendTradeResources(TradeExecutionContext<T>& trade_ctx) {
-  std::set<Trader*>::iterator it;
+  typedef std::pair<Trade<T>, typename T::Ptr> Response;
+  typedef typename TradeExecutionContext<T>::Range Range;
+  std::vector<Response>& responses = trade_ctx.responses;
+  std::vector<Response> accepted;
+  int k = 0;
+  std::set<Trader*, TraderCompare>::iterator it;
   for (it = trade_ctx.requesters.begin(); it != trade_ctx.requesters.end();
        ++it) {
     Trader* requester = *it;
-    AcceptTrades(requester, trade_ctx.trades_by_requester[requester]);
+    if (k == trade_ctx.by_requester.size() ||
+        trade_ctx.by_requester[k].first != requester) {
+      AcceptTrades(requester, std::vector<Response>());
+      continue;
+    }
+
+    const Range& r = trade_ctx.by_requester[k++].second;
+    accepted.resize(r.second - r.first);
+    std::swap_ranges(responses.begin() + r.first,
+                     responses.begin() + r.second, accepted.begin());
+    AcceptTrades(requester, accepted);
+    std::swap_ranges(accepted.begin(), accepted.end(),
+                     responses.begin() + r.first);
   }
 }
 
@@ -0,0 +1,30 @@
+#include "trader.h"
+
+#include <functional>
+
+#include "agent.h"
+
+namespace cyclus {
+
+bool TraderCompare::operator()(Trader* lhs, Trader* rhs) const {
+  if (lhs == NULL || rhs == NULL)
+    return lhs == NULL && rhs != NULL;
+  Agent* lm = lhs->manager();
+  Agent* rm = rhs->manager();
+  int left = lm == NULL ? -1 : lm->id();
+  int right = rm == NULL ? -1 : rm->id();
+  if (left != right)
+    return left < right;
+  return std::less<Trader*>()(lhs, rhs);
+}
+
+bool TraderCompare::operator()(const std::pair<Trader*, Trader*>& lhs,
+                               const std::pair<Trader*, Trader*>& rhs) const {
+  if ((*this)(lhs.first, rhs.first))
+    return true;
+  if ((*this)(rhs.first, lhs.first))
+    return false;
+  return (*this)(lhs.second, rhs.second);
+}
+
+}  // namespace cyclus
@@ -0,0 +1,116 @@
+#include "work_pool.h"
+
+namespace cyclus {
+
+WorkPool::WorkPool(int nthreads)
+    : nranges_(nthreads < 1 ? 1 : nthreads),
+      ranges_(nthreads < 1 ? 1 : nthreads),
+      task_(NULL),
+      batch_(0),
+      busy_(0),
+      stop_(false) {
+  for (int i = 0; i < nranges_; ++i) {
+    ranges_[i].span = 0;
+  }
+  for (int i = 1; i < nranges_; ++i) {
+    threads_.push_back(std::thread(&WorkPool::Loop, this, i));
+  }
+}
+
+WorkPool::~WorkPool() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    stop_ = true;
+  }
+  start_.notify_all();
+  for (int i = 0; i < threads_.size(); ++i) {
+    threads_[i].join();
+  }
+}
+
+void WorkPool::Run(int n, const std::function<void(int)>& task) {
+  if (n <= 0) {
+    return;
+  }
+
+  task_ = &task;
+  for (int i = 0; i < nranges_; ++i) {
+    uint64_t begin = static_cast<uint64_t>(n) * i / nranges_;
+    uint64_t end = static_cast<uint64_t>(n) * (i + 1) / nranges_;
+    ranges_[i].span = begin << 32 | end;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    busy_ = threads_.size();
+    ++batch_;
+  }
+  start_.notify_all();
+
+  Work(0);
+
+  std::unique_lock<std::mutex> lock(mu_);
+  while (busy_ > 0) {
+    done_.wait(lock);
+  }
+  task_ = NULL;
+}
+
+void WorkPool::Loop(int self) {
+  long seen = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      while (!stop_ && batch_ == seen) {
+        start_.wait(lock);
+      }
+      if (stop_) {
+        return;
+      }
+      seen = batch_;
+    }
+
+    Work(self);
+
+    std::lock_guard<std::mutex> lock(mu_);
+    if (--busy_ == 0) {
+      done_.notify_one();
+    }
+  }
+}
+
+void WorkPool::Work(int self) {
+  int i;
+  while (Claim(&ranges_[self], false, &i)) {
+    (*task_)(i);
+  }
+
+  // ranges only shrink once a batch has started, so one pass over the other
+  // threads' ranges leaves no task unclaimed
+  for (int k = 1; k < nranges_; ++k) {
+    Range* victim = &ranges_[(self + k) % nranges_];
+    while (Claim(victim, true, &i)) {
+      (*task_)(i);
+    }
+  }
+}
+
+bool WorkPool::Claim(Range* r, bool steal, int* i) {
+  uint64_t span = r->span.load();
+  while (true) {
+    uint64_t begin = span >> 32;
+    uint64_t end = span & 0xffffffff;
+    if (begin >= end) {
+      return false;
+    }
+
+    uint64_t next = steal ? (begin << 32 | (end - 1))
+                          : ((begin + 1) << 32 | end);
+    if (r->span.compare_exchange_weak(span, next)) {
+      *i = static_cast<int>(steal ? end - 1 : begin);
+      return true;
+    }
+  }
+}
+
+}  // namespace cyclus
@@ -0,0 +1,72 @@
+#ifndef CYCLUS_SRC_WORK_POOL_H_
+#define CYCLUS_SRC_WORK_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+namespace cyclus {
+
+/// @class WorkPool
+///
+/// @brief A WorkPool keeps a fixed set of worker threads alive and runs
+/// batches of tasks on them.
+///
+/// The tasks 0 to n-1 of a batch are split into one contiguous range per
+/// thread (the thread calling Run included). Each thread runs the tasks of
+/// its own range from the front and, once its range is empty, steals tasks
+/// from the back of the other ranges, so that threads that finish early take
+/// over the remaining work. Claiming a task is a single compare-and-swap, and
+/// the threads sleep between batches, so a pool can be reused for every
+/// phase of every timestep.
+class WorkPool {
+ public:
+  /// Creates a pool that runs batches on nthreads threads, including the
+  /// thread calling Run, i.e., nthreads - 1 worker threads are started.
+  explicit WorkPool(int nthreads);
+
+  /// Stops and joins the worker threads.
+  ~WorkPool();
+
+  /// @return the number of threads batches run on
+  int size() const { return nranges_; }
+
+  /// Runs task(i) for every i in [0, n) and returns once all have run. task
+  /// must not throw. Only one thread may call Run at a time.
+  void Run(int n, const std::function<void(int)>& task);
+
+ private:
+  /// the unclaimed tasks of one thread, packed as begin << 32 | end
+  struct Range {
+    std::atomic<uint64_t> span;
+  };
+
+  /// the main loop of worker thread self
+  void Loop(int self);
+
+  /// runs tasks as thread self until there are none left to claim
+  void Work(int self);
+
+  /// claims the first (or, if steal, the last) task of range r
+  bool Claim(Range* r, bool steal, int* i);
+
+  int nranges_;
+  std::vector<Range> ranges_;
+  std::vector<std::thread> threads_;
+  const std::function<void(int)>* task_;
+
+  std::mutex mu_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+  long batch_;
+  int busy_;
+  bool stop_;
+};
+
+}  // namespace cyclus
+
+#endif  // CYCLUS_SRC_WORK_POOL_H_
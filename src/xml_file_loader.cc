@@ -157,6 +157,23 @@ Composition::Ptr ReadRecipe(InfileTree* qe) {
   }
 }
 
+std::vector<TableStorageInfo> LoadHdf5Storage(InfileTree* qe) {
+  std::vector<TableStorageInfo> tables;
+  for (int i = 0; i < qe->NMatches("table"); ++i) {
+    InfileTree* tqe = qe->SubTree("table", i);
+    TableStorageInfo st;
+    st.table = OptionalQuery<std::string>(tqe, "name", "");
+    st.chunk_size = OptionalQuery<int>(tqe, "chunk_size", -1);
+    st.codec = OptionalQuery<std::string>(tqe, "codec", "");
+    st.level = OptionalQuery<int>(tqe, "level", -1);
+    if (tqe->NMatches("shuffle") > 0) {
+      st.shuffle = OptionalQuery<bool>(tqe, "shuffle", false) ? 1 : 0;
+    }
+    tables.push_back(st);
+  }
+  return tables;
+}
+
 XMLFileLoader::XMLFileLoader(Recorder* r,
                              QueryableBackend* b,
                              std::string schema_file,
@@ -232,6 +249,7 @@ void XMLFileLoader::LoadSolver() {
   string config = "config";
   string greedy = "greedy";
   string coinor = "coin-or";
+  string flow = "flow";
   string solver_name = greedy;
   bool exclusive = ExchangeSolver::kDefaultExclusive;
   if (xqe.NMatches("/*/control/solver") == 1) {
@@ -269,8 +287,11 @@ void XMLFileLoader::LoadSolver() {
   if (solver_name == greedy) {
     query = string("/*/control/solver/config/greedy/preconditioner");
     string precon_name = cyclus::OptionalQuery<string>(&xqe, query, greedy);
+    query = string("/*/control/solver/config/greedy/best_first");
+    bool best_first = cyclus::OptionalQuery<bool>(&xqe, query, false);
     ctx_->NewDatum("GreedySolverInfo")
       ->AddVal("Preconditioner", precon_name)
+      ->AddVal("BestFirst", best_first)
       ->Record();
   } else if (solver_name == coinor) {
     query = string("/*/control/solver/config/coin-or/timeout");
@@ -279,10 +300,27 @@ void XMLFileLoader::LoadSolver() {
     bool verbose = cyclus::OptionalQuery<bool>(&xqe, query, false);
     query = string("/*/control/solver/config/coin-or/mps");
     bool mps = cyclus::OptionalQuery<bool>(&xqe, query, false);
+    query = string("/*/control/solver/config/coin-or/warm_start");
+    bool warm_start = cyclus::OptionalQuery<bool>(&xqe, query, false);
+    query = string("/*/control/solver/config/coin-or/adaptive");
+    bool adaptive = cyclus::OptionalQuery<bool>(&xqe, query, false);
+    query = string("/*/control/solver/config/coin-or/time_per_int");
+    double time_per_int = cyclus::OptionalQuery<double>(&xqe, query, -1);
     ctx_->NewDatum("CoinSolverInfo")
       ->AddVal("Timeout", timeout)
       ->AddVal("Verbose", verbose)
       ->AddVal("Mps", mps)
+      ->AddVal("WarmStart", warm_start)
+      ->AddVal("Adaptive", adaptive)
+      ->AddVal("TimePerInt", time_per_int)
+      ->Record();
+  } else if (solver_name == flow) {
+    query = string("/*/control/solver/config/flow/fallback");
+    string fallback = cyclus::OptionalQuery<string>(&xqe, query, greedy);
+    if (fallback != greedy && fallback != coinor)
+      throw ValueError("unknown flow solver fallback: " + fallback);
+    ctx_->NewDatum("FlowSolverInfo")
+      ->AddVal("Fallback", fallback)
       ->Record();
   } else {
     throw ValueError("unknown solver name: " + solver_name);
@@ -439,6 +477,18 @@ void XMLFileLoader::LoadControlParams() {
 
   si.explicit_inventory = OptionalQuery<bool>(qe, "explicit_inventory", false);
   si.explicit_inventory_compact = OptionalQuery<bool>(qe, "explicit_inventory_compact", false);
+  si.dre_stats = OptionalQuery<bool>(qe, "dre_stats", false);
+  si.threads = OptionalQuery<int>(qe, "threads", 1);
+  si.delta_snapshots = OptionalQuery<bool>(qe, "delta_snapshots", false);
+  si.checkpoint_interval = OptionalQuery<int>(qe, "checkpoint_interval", 0);
+  si.checkpoint_minutes = OptionalQuery<double>(qe, "checkpoint_minutes", 0);
+  si.memory_stats = OptionalQuery<bool>(qe, "memory_stats", false);
+  si.decay_cache_size = OptionalQuery<int>(qe, "decay_cache_size",
+                                           Composition::kDefaultDecayCacheSize);
+
+  if (qe->NMatches("hdf5") > 0) {
+    si.hdf5_storage = LoadHdf5Storage(qe->SubTree("hdf5"));
+  }
 
   // get time step duration
   si.dt = OptionalQuery<int>(qe, "dt", kDefaultTimeStepDur);
@@ -16,6 +16,7 @@
 namespace cyclus {
 
 class Context;
+struct TableStorageInfo;
 
 /// Reads the given file path into the passed stream without modification.
 void LoadRawStringstreamFromFile(std::stringstream& stream, std::string file);
@@ -42,6 +43,10 @@ std::string BuildMasterSchema(std::string schema_path, std::string infile,
 /// Creates a composition from the recipe in the query engine.
 Composition::Ptr ReadRecipe(InfileTree* qe);
 
+/// Returns the storage settings of the table entries of an hdf5 control
+/// element in the query engine.
+std::vector<TableStorageInfo> LoadHdf5Storage(InfileTree* qe);
+
 /// Handles initialization of a database with information from
 /// a cyclus xml input file.
 ///
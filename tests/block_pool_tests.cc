@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <boost/weak_ptr.hpp>
+
+#include "block_pool.h"
+#include "request_portfolio.h"
+#include "resource_helpers.h"
+#include "test_context.h"
+
+using cyclus::BlockPool;
+using cyclus::Material;
+using cyclus::Pooled;
+using cyclus::Request;
+using cyclus::RequestPortfolio;
+
+struct PooledThing : public Pooled<PooledThing> {
+  double vals[3];
+};
+
+struct BiggerThing : public PooledThing {
+  double more[5];
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(BlockPoolTests, Reuse) {
+  typedef BlockPool<40> Pool;
+  std::size_t n0 = Pool::n_allocated();
+  std::vector<void*> blocks;
+  std::set<void*> uniq;
+  for (int i = 0; i != Pool::kBlocksPerChunk + 1; i++) {
+    blocks.push_back(Pool::Allocate());
+    uniq.insert(blocks.back());
+  }
+  EXPECT_EQ(blocks.size(), uniq.size());
+  EXPECT_EQ(n0 + blocks.size(), Pool::n_allocated());
+  std::size_t reserved = Pool::n_reserved();
+  EXPECT_LE(Pool::n_allocated(), reserved);
+
+  // freed blocks are handed out again without growing the pool
+  for (int i = 0; i != blocks.size(); i++)
+    Pool::Free(blocks[i]);
+  EXPECT_EQ(n0, Pool::n_allocated());
+  for (int i = 0; i != blocks.size(); i++) {
+    void* p = Pool::Allocate();
+    EXPECT_EQ(1, uniq.count(p));
+    blocks[i] = p;
+  }
+  EXPECT_EQ(reserved, Pool::n_reserved());
+  for (int i = 0; i != blocks.size(); i++)
+    Pool::Free(blocks[i]);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void AllocateBlocks(std::vector<void*>* blocks) {
+  for (int i = 0; i != blocks->size(); i++)
+    (*blocks)[i] = BlockPool<48>::Allocate();
+}
+
+TEST(BlockPoolTests, Threads) {
+  typedef BlockPool<48> Pool;
+  std::size_t n0 = Pool::n_allocated();
+  std::size_t reserved = Pool::n_reserved();
+
+  // blocks allocated on another thread do not come from this thread's pool,
+  // but can be freed here and are then reused by this thread
+  std::vector<void*> blocks(Pool::kBlocksPerChunk);
+  std::thread t(AllocateBlocks, &blocks);
+  t.join();
+  EXPECT_EQ(n0, Pool::n_allocated());
+  std::set<void*> uniq(blocks.begin(), blocks.end());
+  EXPECT_EQ(blocks.size(), uniq.size());
+
+  for (int i = 0; i != blocks.size(); i++)
+    Pool::Free(blocks[i]);
+  for (int i = 0; i != blocks.size(); i++) {
+    void* p = Pool::Allocate();
+    EXPECT_EQ(1, uniq.count(p));
+    blocks[i] = p;
+  }
+  EXPECT_EQ(reserved, Pool::n_reserved());
+  EXPECT_EQ(n0, Pool::n_allocated());
+  for (int i = 0; i != blocks.size(); i++)
+    Pool::Free(blocks[i]);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void FreeBlocks(std::vector<void*>* blocks) {
+  for (int i = 0; i != blocks->size(); i++)
+    BlockPool<56>::Free((*blocks)[i]);
+  EXPECT_GE(BlockPool<56>::kMaxCached, BlockPool<56>::n_cached());
+}
+
+TEST(BlockPoolTests, CrossThreadFree) {
+  typedef BlockPool<56> Pool;
+  std::size_t reserved = Pool::n_reserved();
+
+  // blocks allocated here and freed on other threads, as resources traded on
+  // the main thread and absorbed by agents ticking in parallel are, come back
+  // to this thread through the shared list, so the pool stops growing
+  int nblocks = 3 * Pool::kBlocksPerChunk;
+  std::vector<void*> blocks(nblocks);
+  for (int round = 0; round != 20; round++) {
+    for (int i = 0; i != nblocks; i++)
+      blocks[i] = Pool::Allocate();
+    std::thread t(FreeBlocks, &blocks);
+    t.join();
+  }
+  EXPECT_GE(reserved + nblocks + Pool::kBlocksPerChunk, Pool::n_reserved());
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(BlockPoolTests, Pooled) {
+  typedef BlockPool<sizeof(PooledThing)> Pool;
+  std::size_t n0 = Pool::n_allocated();
+  PooledThing* t = new PooledThing();
+  EXPECT_EQ(n0 + 1, Pool::n_allocated());
+  delete t;
+  EXPECT_EQ(n0, Pool::n_allocated());
+
+  // larger derived classes use the global allocator
+  BiggerThing* b = new BiggerThing();
+  EXPECT_EQ(n0, Pool::n_allocated());
+  delete b;
+  EXPECT_EQ(n0, Pool::n_allocated());
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(BlockPoolTests, PoolShared) {
+  boost::shared_ptr<PooledThing> t = cyclus::PoolShared(new PooledThing());
+  boost::weak_ptr<PooledThing> w = t;
+  boost::shared_ptr<PooledThing> u = t;
+  t.reset();
+  EXPECT_FALSE(w.expired());
+  u.reset();
+  EXPECT_TRUE(w.expired());
+
+  // materials come from a pool
+  typedef BlockPool<sizeof(Material)> MatPool;
+  std::size_t nmat = MatPool::n_allocated();
+  {
+    Material::Ptr m = test_helpers::get_mat();
+    cyclus::Resource::Ptr c = m->Clone();
+    EXPECT_EQ(nmat + 2, MatPool::n_allocated());
+  }
+  EXPECT_EQ(nmat, MatPool::n_allocated());
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(BlockPoolTests, PoolAllocator) {
+  typedef BlockPool<sizeof(double)> Pool;
+  std::size_t n0 = Pool::n_allocated();
+  cyclus::PoolAllocator<double> a;
+  double* d = a.allocate(1);
+  EXPECT_EQ(n0 + 1, Pool::n_allocated());
+  a.deallocate(d, 1);
+  EXPECT_EQ(n0, Pool::n_allocated());
+
+  // arrays use the global allocator
+  d = a.allocate(3);
+  EXPECT_EQ(n0, Pool::n_allocated());
+  a.deallocate(d, 3);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(BlockPoolTests, Portfolio) {
+  typedef BlockPool<sizeof(Request<Material>)> ReqPool;
+  typedef BlockPool<sizeof(RequestPortfolio<Material>)> PortPool;
+  cyclus::TestContext tc;
+  std::size_t nreq = ReqPool::n_allocated();
+  std::size_t nport = PortPool::n_allocated();
+  {
+    RequestPortfolio<Material>::Ptr rp(new RequestPortfolio<Material>());
+    rp->AddRequest(test_helpers::get_mat(), tc.trader());
+    rp->AddRequest(test_helpers::get_mat(), tc.trader());
+    EXPECT_LT(nport, PortPool::n_allocated());
+    EXPECT_LE(nreq + 2, ReqPool::n_allocated());
+  }
+  EXPECT_EQ(nport, PortPool::n_allocated());
+  EXPECT_EQ(nreq, ReqPool::n_allocated());
+}
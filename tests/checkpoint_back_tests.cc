@@ -0,0 +1,271 @@
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/uuid/uuid_generators.hpp>
+#include <gtest/gtest.h>
+
+#include "blob.h"
+#include "checkpoint_back.h"
+#include "error.h"
+#include "recorder.h"
+
+using cyclus::CheckpointBack;
+using cyclus::Cond;
+using cyclus::QueryResult;
+using cyclus::Recorder;
+
+static std::string const prefix = "checkpointtest";
+
+class CheckpointBackTests : public ::testing::Test {
+ public:
+  virtual void SetUp() {
+    b = new CheckpointBack(prefix);
+    r.RegisterBackend(b);
+  }
+
+  virtual void TearDown() {
+    r.Close();
+    delete b;
+    remove(CheckpointBack::Path(prefix, 1).c_str());
+    remove(CheckpointBack::Path(prefix, 2).c_str());
+  }
+
+  void Snapshot(int t) {
+    r.NewDatum("Snapshots")->AddVal("Time", t)->Record();
+    r.NewDatum("NextIds")
+        ->AddVal("Time", t)
+        ->AddVal("Object", std::string("Agent"))
+        ->AddVal("NextId", 10 + t)
+        ->Record();
+  }
+
+  void Inventory(int t, int agent, int rsrc) {
+    r.NewDatum("AgentStateInventories")
+        ->AddVal("AgentId", agent)
+        ->AddVal("SimTime", t)
+        ->AddVal("InventoryName", std::string("inv"))
+        ->AddVal("ResourceId", rsrc)
+        ->Record();
+  }
+
+  void Resource(int rsrc, int qual) {
+    r.NewDatum("Resources")
+        ->AddVal("ResourceId", rsrc)
+        ->AddVal("Type", std::string("Material"))
+        ->AddVal("QualId", qual)
+        ->Record();
+  }
+
+  void Comp(int qual) {
+    r.NewDatum("Compositions")
+        ->AddVal("QualId", qual)
+        ->AddVal("NucId", 922350000)
+        ->AddVal("MassFrac", 1.0)
+        ->Record();
+  }
+
+  CheckpointBack* b;
+  Recorder r;
+};
+
+TEST_F(CheckpointBackTests, IgnoresOutputTables) {
+  r.NewDatum("Transactions")->AddVal("TransactionId", 1)->Record();
+  r.NewDatum("Info")->AddVal("Duration", 10)->Record();
+  r.NewDatum("InfoOptions")->AddVal("Threads", 2)->Record();
+  r.NewDatum("InfoNewOption")->AddVal("Value", 1)->Record();
+  r.Flush();
+
+  // every simulation settings table is kept, including ones added later
+  std::set<std::string> tables = b->Tables();
+  EXPECT_EQ(1, tables.count("Info"));
+  EXPECT_EQ(1, tables.count("InfoOptions"));
+  EXPECT_EQ(1, tables.count("InfoNewOption"));
+  EXPECT_EQ(0, tables.count("Transactions"));
+  EXPECT_THROW(b->Query("Transactions", NULL), cyclus::ValueError);
+}
+
+TEST_F(CheckpointBackTests, RoundTrip) {
+  typedef std::map<std::string, std::vector<double> > Foo;
+  Foo f;
+  f["a"].push_back(1.5);
+  f["b"].push_back(2.5);
+  boost::uuids::uuid u = boost::uuids::random_generator()();
+
+  r.NewDatum("Info")
+      ->AddVal("Handle", std::string("monty"))
+      ->AddVal("Duration", 10)
+      ->AddVal("DecayInterval", 0.5)
+      ->AddVal("Blob", cyclus::Blob("python"))
+      ->AddVal("ParentSimId", u)
+      ->AddVal("Foo", f)
+      ->Record();
+  Snapshot(1);
+  r.Flush();
+  b->Save(CheckpointBack::Path(prefix, 1), 1);
+
+  CheckpointBack c;
+  EXPECT_EQ(-1, c.time());
+  c.Load(CheckpointBack::Path(prefix, 1));
+  EXPECT_EQ(1, c.time());
+
+  QueryResult qr = c.Query("Info", NULL);
+  ASSERT_EQ(1, qr.rows.size());
+  EXPECT_EQ("monty", qr.GetVal<std::string>("Handle"));
+  EXPECT_EQ(10, qr.GetVal<int>("Duration"));
+  EXPECT_DOUBLE_EQ(0.5, qr.GetVal<double>("DecayInterval"));
+  EXPECT_EQ("python", qr.GetVal<cyclus::Blob>("Blob").str());
+  EXPECT_EQ(u, qr.GetVal<boost::uuids::uuid>("ParentSimId"));
+  EXPECT_EQ(f, qr.GetVal<Foo>("Foo"));
+  EXPECT_EQ(b->Schema("Info").size(), c.Schema("Info").size());
+  EXPECT_EQ(cyclus::MAP_STRING_VECTOR_DOUBLE, c.ColumnTypes("Info")["Foo"]);
+}
+
+TEST_F(CheckpointBackTests, BadFile) {
+  CheckpointBack c;
+  EXPECT_THROW(c.Load(CheckpointBack::Path(prefix, 1)), cyclus::IOError);
+
+  FILE* f = fopen(CheckpointBack::Path(prefix, 1).c_str(), "w");
+  fputs("not a checkpoint", f);
+  fclose(f);
+  EXPECT_THROW(c.Load(CheckpointBack::Path(prefix, 1)), cyclus::IOError);
+}
+
+TEST_F(CheckpointBackTests, Snapshots) {
+  Resource(1, 100);
+  Resource(2, 200);
+  Snapshot(1);
+  Inventory(1, 7, 1);
+  Resource(3, 300);
+  Snapshot(2);  // writes the checkpoint at 1
+  Inventory(2, 7, 3);
+  r.Close();  // writes the checkpoint at 2
+
+  CheckpointBack c;
+  c.Load(CheckpointBack::Path(prefix, 1));
+  QueryResult qr = c.Query("NextIds", NULL);
+  ASSERT_EQ(1, qr.rows.size());
+  EXPECT_EQ(11, qr.GetVal<int>("NextId"));
+  qr = c.Query("Resources", NULL);
+  ASSERT_EQ(1, qr.rows.size());
+  EXPECT_EQ(1, qr.GetVal<int>("ResourceId"));
+
+  c.Load(CheckpointBack::Path(prefix, 2));
+  EXPECT_EQ(2, c.time());
+  std::vector<Cond> conds;
+  conds.push_back(Cond("Time", "==", 2));
+  qr = c.Query("NextIds", &conds);
+  ASSERT_EQ(1, qr.rows.size());
+  EXPECT_EQ(12, qr.GetVal<int>("NextId"));
+  qr = c.Query("Resources", NULL);
+  ASSERT_EQ(1, qr.rows.size());
+  EXPECT_EQ(3, qr.GetVal<int>("ResourceId"));
+
+  conds.clear();
+  conds.push_back(Cond("AgentId", "==", 7));
+  conds.push_back(Cond("SimTime", "<=", 2));
+  qr = c.Query("AgentStateInventories", &conds);
+  ASSERT_EQ(1, qr.rows.size());
+  EXPECT_EQ(3, qr.GetVal<int>("ResourceId"));
+  conds[0] = Cond("AgentId", "==", 8);
+  EXPECT_EQ(0, c.Query("AgentStateInventories", &conds).rows.size());
+}
+
+TEST_F(CheckpointBackTests, Pack) {
+  cyclus::Datum* d1 = r.NewDatum("AgentStateFoo");
+  d1->AddVal("AgentId", 7)->AddVal("SimTime", 1)->AddVal("x", 2.5);
+  cyclus::Datum* d2 = r.NewDatum("AgentStateFoo");
+  d2->AddVal("AgentId", 7)->AddVal("SimTime", 2)->AddVal("x", 2.5);
+  std::string p1 = CheckpointBack::Pack(d1, "SimTime");
+  std::string p2 = CheckpointBack::Pack(d2, "SimTime");
+  EXPECT_EQ(p1, p2);
+  EXPECT_NE(CheckpointBack::Pack(d1), CheckpointBack::Pack(d2));
+  d2->AddVal("y", 1);
+  EXPECT_NE(p1, CheckpointBack::Pack(d2, "SimTime"));
+
+  // a batch packs to its datums' packs, one after another
+  cyclus::DatumList batch;
+  batch.push_back(d1);
+  batch.push_back(d2);
+  EXPECT_EQ(p1 + CheckpointBack::Pack(d2, "SimTime"),
+            CheckpointBack::Pack(batch, "SimTime"));
+}
+
+TEST_F(CheckpointBackTests, DeltaSnapshots) {
+  Resource(1, 100);
+  Resource(2, 200);
+  Snapshot(1);
+  r.NewDatum("AgentStateAgent")->AddVal("AgentId", 7)->AddVal("SimTime", 1)
+      ->Record();
+  Inventory(1, 7, 1);
+  r.NewDatum("AgentStateAgent")->AddVal("AgentId", 8)->AddVal("SimTime", 1)
+      ->Record();
+  Inventory(1, 8, 2);
+  Resource(3, 300);
+  Snapshot(2);  // writes the checkpoint at 1, agent 7 is unchanged at 2
+  r.NewDatum("AgentStateAgent")->AddVal("AgentId", 8)->AddVal("SimTime", 2)
+      ->Record();
+  Inventory(2, 8, 3);
+  Snapshot(3);  // writes the checkpoint at 2, neither agent changed at 3
+  r.Close();  // writes the checkpoint at 3
+
+  for (int t = 2; t <= 3; ++t) {
+    CheckpointBack c;
+    c.Load(CheckpointBack::Path(prefix, t));
+    QueryResult qr = c.Query("AgentStateAgent", NULL);
+    ASSERT_EQ(2, qr.rows.size());
+    QueryResult inv = c.Query("AgentStateInventories", NULL);
+    ASSERT_EQ(2, inv.rows.size());
+    std::map<int, int> rsrcs;
+    for (int i = 0; i < inv.rows.size(); ++i) {
+      rsrcs[inv.GetVal<int>("AgentId", i)] = inv.GetVal<int>("ResourceId", i);
+    }
+    EXPECT_EQ(1, rsrcs[7]);
+    EXPECT_EQ(3, rsrcs[8]);
+    EXPECT_EQ(2, c.Query("Resources", NULL).rows.size());
+  }
+  remove(CheckpointBack::Path(prefix, 3).c_str());
+}
+
+TEST_F(CheckpointBackTests, SavesOnce) {
+  std::string path = CheckpointBack::Path(prefix, 1);
+  Snapshot(1);
+  r.Flush();  // writes the checkpoint at 1
+  FILE* f = fopen(path.c_str(), "r");
+  ASSERT_TRUE(f != NULL);
+  fclose(f);
+  remove(path.c_str());
+
+  Resource(1, 100);
+  r.Flush();
+  Snapshot(2);
+  r.Flush();
+  f = fopen(path.c_str(), "r");
+  EXPECT_TRUE(f == NULL);
+  if (f != NULL) {
+    fclose(f);
+  }
+}
+
+TEST_F(CheckpointBackTests, PrunesCompositions) {
+  Resource(1, 100);
+  Resource(2, 200);
+  Comp(100);
+  Comp(200);
+  r.NewDatum("Products")
+      ->AddVal("QualId", 1)
+      ->AddVal("Quality", std::string("bananas"))
+      ->Record();
+  Snapshot(1);
+  Inventory(1, 7, 1);
+  Comp(300);
+  Snapshot(2);  // resource 2 and its composition are no longer needed
+  r.Flush();
+
+  QueryResult qr = b->Query("Compositions", NULL);
+  ASSERT_EQ(2, qr.rows.size());
+  EXPECT_EQ(100, qr.GetVal<int>("QualId", 0));
+  EXPECT_EQ(300, qr.GetVal<int>("QualId", 1));
+  EXPECT_EQ(1, b->Query("Products", NULL).rows.size());
+}
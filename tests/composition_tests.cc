@@ -1,4 +1,6 @@
+#include <functional>
 #include <map>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -6,7 +8,9 @@
 #include "composition.h"
 #include "comp_math.h"
 #include "env.h"
+#include "error.h"
 #include "pyne.h"
+#include "work_pool.h"
 
 using cyclus::Composition;
 using cyclus::CompMap;
@@ -15,8 +19,13 @@ using pyne::nucname::id;
 class TestComp : public Composition {
  public:
   TestComp() {}
-  Composition::Chain DecayLine() {
-    return *decay_line_.get();
+  std::map<int, Composition::Ptr> DecayLine() {
+    std::map<int, Composition::Ptr> chain;
+    Composition::Chain::iterator it;
+    for (it = decay_line_->begin(); it != decay_line_->end(); ++it) {
+      chain[it->first] = it->second.lock();
+    }
+    return chain;
   }
 };
 
@@ -72,6 +81,70 @@ TEST(CompositionTests, lineage) {
   EXPECT_EQ(dec4, dec5);
 }
 
+TEST(CompositionTests, decay_cache) {
+  cyclus::Env::SetNucDataPath();
+
+  int size = Composition::decay_cache_size();
+  Composition::SetDecayCacheSize(2);
+
+  TestComp c;
+  Composition::Ptr dec1 = c.Decay(1);
+  int id2 = c.Decay(2)->id();
+  int id3 = c.Decay(3)->id();
+  EXPECT_EQ(3, c.DecayLine().size());
+
+  // held by the cache and dec1
+  EXPECT_EQ(id3, c.Decay(3)->id());
+  EXPECT_EQ(id2, c.Decay(2)->id());
+  std::vector<int> cached = Composition::CachedIds();
+  ASSERT_EQ(2, cached.size());
+  EXPECT_EQ(id2, cached[0]);  // most recently used first
+  EXPECT_EQ(id3, cached[1]);
+
+  // evicts 3, which no material holds, while dec1 stays alive and reused
+  int id4 = c.Decay(4)->id();
+  std::map<int, Composition::Ptr> chain = c.DecayLine();
+  EXPECT_EQ(3, chain.size());
+  EXPECT_EQ(0, chain.count(3));
+  EXPECT_EQ(dec1, c.Decay(1));
+  EXPECT_NE(id3, c.Decay(3)->id());
+
+  // clearing drops the compositions no material holds
+  Composition::ClearDecayCache();
+  EXPECT_EQ(0, Composition::CachedIds().size());
+  chain.clear();
+  EXPECT_EQ(1, c.DecayLine().size());
+  EXPECT_EQ(dec1, c.Decay(1));
+  EXPECT_EQ(1, Composition::CachedIds().size());
+
+  Composition::SetDecayCacheSize(0);
+  chain.clear();
+  EXPECT_EQ(1, c.DecayLine().size());
+  EXPECT_THROW(Composition::SetDecayCacheSize(-1), cyclus::ValueError);
+  Composition::SetDecayCacheSize(size);
+}
+
+struct DecayTask {
+  DecayTask(Composition::Ptr c, int n) : c(c), ids(n) {}
+  void operator()(int i) { ids[i] = c->Decay(i % 10 + 1)->id(); }
+  Composition::Ptr c;
+  std::vector<int> ids;
+};
+
+TEST(CompositionTests, concurrent_decay) {
+  cyclus::Env::SetNucDataPath();
+
+  // decays of the same composition on many threads share one decay chain
+  Composition::Ptr c(new TestComp());
+  DecayTask d(c, 1000);
+  cyclus::WorkPool pool(4);
+  pool.Run(1000, std::ref(d));
+  for (int i = 10; i < 1000; ++i) {
+    EXPECT_EQ(d.ids[i % 10], d.ids[i]);
+  }
+  EXPECT_EQ(10, static_cast<TestComp*>(c.get())->DecayLine().size());
+}
+
 TEST(CompositionTests, decay) {
   cyclus::Env::SetNucDataPath();
 
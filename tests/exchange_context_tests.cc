@@ -1,5 +1,7 @@
+#include <map>
 #include <string>
 #include <set>
+#include <stdexcept>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -28,6 +30,7 @@ using cyclus::RequestPortfolio;
 using cyclus::Resource;
 using cyclus::TestContext;
 using cyclus::Trader;
+using cyclus::TraderCompare;
 using test_helpers::get_mat;
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -86,7 +89,7 @@ TEST_F(ExchangeContextTests, AddRequest1) {
   EXPECT_EQ(vr, context.commod_requests[commod1]);
 
   EXPECT_EQ(1, context.requesters.size());
-  std::set<Trader*> requesters;
+  std::set<Trader*, TraderCompare> requesters;
   requesters.insert(fac1);
   EXPECT_EQ(requesters, context.requesters);
 }
@@ -156,7 +159,7 @@ TEST_F(ExchangeContextTests, AddBid1) {
   EXPECT_EQ(vr, context.bids_by_request[req1]);
 
   EXPECT_EQ(1, context.bidders.size());
-  std::set<Trader*> bidders;
+  std::set<Trader*, TraderCompare> bidders;
   bidders.insert(fac1);
   EXPECT_EQ(bidders, context.bidders);
 
@@ -219,8 +222,87 @@ TEST_F(ExchangeContextTests, AddBid2) {
   EXPECT_EQ(vreq2, context.bids_by_request[req2]);
 
   EXPECT_EQ(2, context.bidders.size());
-  std::set<Trader*> bidders;
+  std::set<Trader*, TraderCompare> bidders;
   bidders.insert(fac1);
   bidders.insert(fac2);
   EXPECT_EQ(bidders, context.bidders);
 }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(ExchangeContextTests, CreationOrder) {
+  // containers are iterated in the order in which their elements were created,
+  // regardless of where they were allocated
+  std::vector<Request<Resource>*> reqs;
+  reqs.push_back(req1);
+  for (int i = 0; i != 10; i++)
+    reqs.push_back(rp1->AddRequest(get_mat(), fac1, commod1));
+
+  BidPortfolio<Resource>::Ptr bp(new BidPortfolio<Resource>());
+  std::vector<Bid<Resource>*> bids;
+  for (int i = reqs.size() - 1; i >= 0; i--)
+    bids.push_back(bp->AddBid(reqs[i], get_mat(), fac2));
+  for (int i = 1; i != bids.size(); i++)
+    EXPECT_LT(bids[i - 1]->id(), bids[i]->id());
+  EXPECT_EQ(bids, std::vector<Bid<Resource>*>(bp->bids().begin(),
+                                              bp->bids().end()));
+
+  ExchangeContext<Resource> context;
+  context.AddRequestPortfolio(rp2);
+  context.AddRequestPortfolio(rp1);
+  context.AddBidPortfolio(bp);
+
+  // requests are first bid on in the order of their bids
+  std::vector<Request<Resource>*> obs;
+  cyclus::SequencedMap<Request<Resource>, std::vector<Bid<Resource>*> >::
+      iterator it;
+  for (it = context.bids_by_request.begin();
+       it != context.bids_by_request.end(); ++it) {
+    obs.push_back(it->first);
+  }
+  EXPECT_EQ(std::vector<Request<Resource>*>(reqs.rbegin(), reqs.rend()), obs);
+
+  PrefMap<Resource>::type& prefs = context.trader_prefs[fac1];
+  obs.clear();
+  PrefMap<Resource>::type::iterator p_it;
+  for (p_it = prefs.begin(); p_it != prefs.end(); ++p_it)
+    obs.push_back(p_it->first);
+  EXPECT_EQ(reqs, obs);
+
+  std::vector<Trader*> traders(context.requesters.begin(),
+                               context.requesters.end());
+  ASSERT_EQ(2, traders.size());
+  EXPECT_EQ(fac1, traders[0]);
+  EXPECT_EQ(fac2, traders[1]);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(ExchangeContextTests, SequencedMap) {
+  // lookups survive rehashing, and entries keep their insertion order
+  std::vector<Request<Resource>*> reqs;
+  for (int i = 0; i != 40; i++)
+    reqs.push_back(rp1->AddRequest(get_mat(), fac1, commod1));
+
+  cyclus::SequencedMap<Request<Resource>, int> m;
+  EXPECT_TRUE(m.empty());
+  EXPECT_TRUE(m.find(reqs[0]) == m.end());
+  EXPECT_THROW(m.at(reqs[0]), std::out_of_range);
+  for (int i = reqs.size() - 1; i >= 0; i--)
+    m[reqs[i]] = i;
+
+  ASSERT_EQ(reqs.size(), m.size());
+  for (int i = 0; i != reqs.size(); i++) {
+    EXPECT_EQ(1, m.count(reqs[i]));
+    EXPECT_EQ(i, m.at(reqs[i]));
+    EXPECT_EQ(reqs[i], m.find(reqs[i])->first);
+  }
+  EXPECT_EQ(0, m.count(req1));
+
+  int i = reqs.size() - 1;
+  cyclus::SequencedMap<Request<Resource>, int>::iterator it;
+  for (it = m.begin(); it != m.end(); ++it, --i)
+    EXPECT_EQ(reqs[i], it->first);
+
+  m.clear();
+  EXPECT_TRUE(m.empty());
+  EXPECT_EQ(0, m.count(reqs[0]));
+}
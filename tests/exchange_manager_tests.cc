@@ -3,6 +3,7 @@
 #include "exchange_manager.h"
 #include "greedy_solver.h"
 #include "material.h"
+#include "rec_backend.h"
 #include "test_context.h"
 
 using cyclus::ExchangeManager;
@@ -18,3 +19,50 @@ TEST(ExManagerTests, NullTest) {
 
   EXPECT_NO_THROW(manager.Execute());
 }
+
+class StatsBack : public cyclus::RecBackend {
+ public:
+  virtual void Notify(cyclus::DatumList data) {
+    for (int i = 0; i != data.size(); i++) {
+      if (data[i]->title() == "DreStats")
+        stats.push_back(data[i]->vals());
+    }
+  }
+  virtual std::string Name() { return "StatsBack"; }
+  virtual void Flush() {}
+  virtual void Close() {}
+
+  std::vector<cyclus::Datum::Vals> stats;
+};
+
+TEST(ExManagerTests, Stats) {
+  StatsBack back;  // outlives the context's recorder
+  TestContext tc;
+  tc.recorder()->RegisterBackend(&back);
+  GreedySolver* solver = new GreedySolver();
+  tc.get()->solver(solver);
+
+  ExchangeManager<Material> manager(tc.get());
+  EXPECT_FALSE(manager.record_stats());
+  manager.Execute();
+  tc.recorder()->Flush();
+  EXPECT_EQ(0, back.stats.size());
+
+  manager.record_stats(true);
+  manager.Execute();
+  tc.recorder()->Flush();
+  ASSERT_EQ(1, back.stats.size());
+
+  // an empty exchange is still timed and counted
+  const cyclus::Datum::Vals& v = back.stats[0];
+  ASSERT_EQ(16, v.size());  // including the SimId
+  EXPECT_STREQ("Time", v[1].first);
+  EXPECT_EQ(0, v[1].second.cast<int>());
+  EXPECT_STREQ("ResourceType", v[2].first);
+  EXPECT_EQ(Material::kType, v[2].second.cast<std::string>());
+  EXPECT_LE(0, v[3].second.cast<double>());
+  EXPECT_STREQ("NRequestPortfolios", v[9].first);
+  EXPECT_EQ(0, v[9].second.cast<int>());
+  EXPECT_STREQ("NMatches", v[15].first);
+  EXPECT_EQ(0, v[15].second.cast<int>());
+}
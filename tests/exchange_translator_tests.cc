@@ -4,6 +4,7 @@
 #include "bid_portfolio.h"
 #include "capacity_constraint.h"
 #include "composition.h"
+#include "env.h"
 #include "error.h"
 #include "exchange_context.h"
 #include "exchange_graph.h"
@@ -77,6 +78,44 @@ struct MatConverter2 : public Converter<Material> {
   }
 };
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+struct CountingConverter : public Converter<Material> {
+  explicit CountingConverter(bool pure) : pure_(pure), calls(0) {}
+  virtual ~CountingConverter() {}
+
+  virtual double convert(
+      Material::Ptr r,
+      Arc const * a = NULL,
+      ExchangeTranslationContext<Material> const *  ctx = NULL) const {
+    ++calls;
+    return r->comp()->mass().find(u235)->second * fraction;
+  }
+
+  virtual bool pure() const { return pure_; }
+
+  bool pure_;
+  mutable int calls;
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+struct NucConverter : public Converter<Material> {
+  explicit NucConverter(int nuc) : nuc(nuc), calls(0) {}
+  virtual ~NucConverter() {}
+
+  virtual double convert(
+      Material::Ptr r,
+      Arc const * a = NULL,
+      ExchangeTranslationContext<Material> const *  ctx = NULL) const {
+    ++calls;
+    return r->comp()->mass().find(nuc)->second * r->quantity();
+  }
+
+  virtual bool pure() const { return true; }
+
+  int nuc;
+  mutable int calls;
+};
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 TEST(ExXlateTests, NegPref) {
   TestContext tc;
@@ -169,6 +208,113 @@ TEST(ExXlateTests, XlateCapacities) {
   TestVecEq(bexp, bnode->unit_capacities[arc]);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(ExXlateTests, XlateCapacitiesMemo) {
+  Material::Ptr mat = get_mat(u235, qty);
+  Material::Ptr same = Material::CreateUntracked(qty, mat->comp());
+  Material::Ptr more = Material::CreateUntracked(2 * qty, mat->comp());
+
+  CountingConverter* pure = new CountingConverter(true);
+  CountingConverter* impure = new CountingConverter(false);
+  std::set< CapacityConstraint<Material> > constrs;
+  constrs.insert(
+      CapacityConstraint<Material>(qty, Converter<Material>::Ptr(pure)));
+  constrs.insert(
+      CapacityConstraint<Material>(qty, Converter<Material>::Ptr(impure)));
+
+  ExchangeTranslationContext<Material> ctx;
+  Material::Ptr offers[] = {mat, same, mat, more};
+  for (int i = 0; i != 4; i++) {
+    ExchangeNode::Ptr unode(new ExchangeNode());
+    ExchangeNode::Ptr vnode(new ExchangeNode());
+    Arc arc(unode, vnode);
+    TranslateCapacities<Material>(offers[i], constrs, vnode, arc, ctx);
+    ASSERT_EQ(2, vnode->unit_capacities[arc].size());
+    EXPECT_DOUBLE_EQ(vnode->unit_capacities[arc][0],
+                     vnode->unit_capacities[arc][1]);
+  }
+
+  // offers of the same quality and quantity share a pure converter's result
+  EXPECT_EQ(2, pure->calls);
+  EXPECT_EQ(4, impure->calls);
+  EXPECT_EQ(2, ctx.unit_caps.size());
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(ExXlateTests, XlateCapacitiesMemoLazyDecay) {
+  cyclus::Env::SetNucDataPath();
+  TestContext tc;
+  tc.get()->InitSim(cyclus::SimInfo(200, 2015, 1, "", "lazy"));
+
+  // two offers that share a composition, one last decayed 120 months ago
+  int am241 = 952410000;
+  CompMap v;
+  v[922350000] = 1;
+  v[am241] = 1;
+  Composition::Ptr c = Composition::CreateFromMass(v);
+  tc.get()->time(0);
+  Material::Ptr old = Material::Create(tc.trader(), qty, c);
+  tc.get()->time(120);
+  Material::Ptr young = Material::Create(tc.trader(), qty, c);
+  ASSERT_EQ(old->qual_id(), young->qual_id());
+
+  NucConverter* conv = new NucConverter(am241);
+  std::set< CapacityConstraint<Material> > constrs;
+  constrs.insert(
+      CapacityConstraint<Material>(qty, Converter<Material>::Ptr(conv)));
+
+  ExchangeTranslationContext<Material> ctx;
+  Material::Ptr offers[] = {young, old};
+  double ucaps[2];
+  for (int i = 0; i != 2; i++) {
+    ExchangeNode::Ptr unode(new ExchangeNode());
+    ExchangeNode::Ptr vnode(new ExchangeNode());
+    Arc arc(unode, vnode);
+    TranslateCapacities<Material>(offers[i], constrs, vnode, arc, ctx);
+    ucaps[i] = vnode->unit_capacities[arc][0];
+  }
+
+  // the old offer was last decayed at a different time, so it does not reuse
+  // the young offer's result
+  EXPECT_EQ(2, conv->calls);
+  EXPECT_NE(old->qual_id(), young->qual_id());
+  EXPECT_DOUBLE_EQ(young->comp()->mass().find(am241)->second, ucaps[0]);
+  EXPECT_DOUBLE_EQ(old->comp()->mass().find(am241)->second, ucaps[1]);
+  EXPECT_LT(ucaps[1], ucaps[0]);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(ExXlateTests, XlateCapacitiesNoDecay) {
+  cyclus::Env::SetNucDataPath();
+  TestContext tc;
+  tc.get()->InitSim(cyclus::SimInfo(200, 2015, 1, "", "lazy"));
+
+  CompMap v;
+  v[922350000] = 1;
+  v[952410000] = 1;
+  tc.get()->time(0);
+  Material::Ptr old =
+      Material::Create(tc.trader(), qty, Composition::CreateFromMass(v));
+  tc.get()->time(120);
+  int qual = old->qual_id();
+  int state = old->state_id();
+
+  // translating an offer with the default converter only reads its quantity
+  std::set< CapacityConstraint<Material> > constrs;
+  constrs.insert(CapacityConstraint<Material>(qty));
+  ExchangeTranslationContext<Material> ctx;
+  ExchangeNode::Ptr unode(new ExchangeNode());
+  ExchangeNode::Ptr vnode(new ExchangeNode());
+  Arc arc(unode, vnode);
+  TranslateCapacities<Material>(old, constrs, vnode, arc, ctx);
+
+  EXPECT_DOUBLE_EQ(1, vnode->unit_capacities[arc][0]);
+  EXPECT_EQ(qual, old->qual_id());
+  EXPECT_EQ(state, old->state_id());
+  EXPECT_EQ(0, old->prev_decay_time());
+  EXPECT_EQ(0, ctx.unit_caps.size());
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 TEST(ExXlateTests, XlateReq) {
   TestContext tc;
@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+
+#include "exchange_graph.h"
+#include "flow_solver.h"
+#include "greedy_solver.h"
+
+namespace cyclus {
+
+// two requesters (agents 1 and 2) for one unit each and two suppliers (agents
+// 3 and 4) of one unit each. Requester 1 slightly prefers supplier 3, which is
+// the only supplier requester 2 will take from, so greedily serving requester
+// 1 first leaves requester 2 unmet.
+void BuildCrossGraph(ExchangeGraph* g, Arc* arcs) {
+  ExchangeNodeGroup::Ptr s3(new ExchangeNodeGroup());
+  ExchangeNodeGroup::Ptr s4(new ExchangeNodeGroup());
+  RequestGroup::Ptr r1(new RequestGroup(1));
+  RequestGroup::Ptr r2(new RequestGroup(1));
+  s3->AddCapacity(1);
+  s4->AddCapacity(1);
+  r1->AddCapacity(1);
+  r2->AddCapacity(1);
+
+  ExchangeNode::Ptr u13(new ExchangeNode(1, false, "commod", 1));
+  ExchangeNode::Ptr u14(new ExchangeNode(1, false, "commod", 1));
+  ExchangeNode::Ptr u23(new ExchangeNode(1, false, "commod", 2));
+  ExchangeNode::Ptr v13(new ExchangeNode(1, false, "commod", 3));
+  ExchangeNode::Ptr v14(new ExchangeNode(1, false, "commod", 4));
+  ExchangeNode::Ptr v23(new ExchangeNode(1, false, "commod", 3));
+  r1->AddExchangeNode(u13);
+  r1->AddExchangeNode(u14);
+  r2->AddExchangeNode(u23);
+  s3->AddExchangeNode(v13);
+  s4->AddExchangeNode(v14);
+  s3->AddExchangeNode(v23);
+
+  arcs[0] = Arc(u13, v13);
+  arcs[1] = Arc(u14, v14);
+  arcs[2] = Arc(u23, v23);
+  double prefs[] = {2, 1.9, 1};
+  for (int i = 0; i != 3; i++) {
+    arcs[i].pref(prefs[i]);
+    arcs[i].unode()->prefs[arcs[i]] = prefs[i];
+    arcs[i].unode()->unit_capacities[arcs[i]].push_back(1);
+    arcs[i].vnode()->unit_capacities[arcs[i]].push_back(1);
+  }
+
+  g->AddRequestGroup(r1);
+  g->AddRequestGroup(r2);
+  g->AddSupplyGroup(s3);
+  g->AddSupplyGroup(s4);
+  for (int i = 0; i != 3; i++)
+    g->AddArc(arcs[i]);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(FlowSolverTests, Optimal) {
+  ExchangeGraph g;
+  Arc arcs[3];
+  BuildCrossGraph(&g, arcs);
+  FlowSolver solver(false);
+  ASSERT_TRUE(solver.IsFlowGraph(&g));
+  double obj = solver.Solve(&g);
+
+  const std::vector<Match>& matches = g.matches();
+  ASSERT_EQ(2, matches.size());
+  EXPECT_EQ(arcs[1], matches[0].first);
+  EXPECT_DOUBLE_EQ(1, matches[0].second);
+  EXPECT_EQ(arcs[2], matches[1].first);
+  EXPECT_DOUBLE_EQ(1, matches[1].second);
+  EXPECT_DOUBLE_EQ(1 / 1.9 + 1, obj);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(FlowSolverTests, PartialSupply) {
+  // more demand than supply; the preferred arc gets the supply
+  ExchangeNodeGroup::Ptr s(new ExchangeNodeGroup());
+  s->AddCapacity(3);
+  ExchangeGraph g;
+  g.AddSupplyGroup(s);
+  Arc arcs[2];
+  for (int i = 0; i != 2; i++) {
+    RequestGroup::Ptr r(new RequestGroup(2));
+    r->AddCapacity(2);
+    ExchangeNode::Ptr u(new ExchangeNode(2, false, "commod", i));
+    ExchangeNode::Ptr v(new ExchangeNode(2, false, "commod", 2));
+    r->AddExchangeNode(u);
+    s->AddExchangeNode(v);
+    arcs[i] = Arc(u, v);
+    arcs[i].pref(i + 1);
+    u->prefs[arcs[i]] = i + 1;
+    u->unit_capacities[arcs[i]].push_back(1);
+    v->unit_capacities[arcs[i]].push_back(1);
+    g.AddRequestGroup(r);
+    g.AddArc(arcs[i]);
+  }
+
+  FlowSolver solver(false);
+  solver.Solve(&g);
+  const std::vector<Match>& matches = g.matches();
+  ASSERT_EQ(2, matches.size());
+  EXPECT_EQ(arcs[0], matches[0].first);
+  EXPECT_DOUBLE_EQ(1, matches[0].second);
+  EXPECT_EQ(arcs[1], matches[1].first);
+  EXPECT_DOUBLE_EQ(2, matches[1].second);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(FlowSolverTests, Structure) {
+  FlowSolver solver(true);
+
+  // non-unit capacity coefficients are not a transportation problem
+  ExchangeGraph g1;
+  Arc arcs[3];
+  BuildCrossGraph(&g1, arcs);
+  EXPECT_TRUE(solver.IsFlowGraph(&g1));
+  arcs[0].vnode()->unit_capacities[arcs[0]][0] = 2;
+  EXPECT_FALSE(solver.IsFlowGraph(&g1));
+
+  // nor are multiple constraints
+  ExchangeGraph g2;
+  BuildCrossGraph(&g2, arcs);
+  arcs[0].vnode()->group->AddCapacity(5);
+  EXPECT_FALSE(solver.IsFlowGraph(&g2));
+
+  // nor are exclusive arcs, if exclusive orders are enforced
+  ExchangeGraph g3;
+  ExchangeNode::Ptr u(new ExchangeNode(1, true, "commod", 1));
+  ExchangeNode::Ptr v(new ExchangeNode(1, true, "commod", 2));
+  RequestGroup::Ptr r(new RequestGroup(1));
+  ExchangeNodeGroup::Ptr s(new ExchangeNodeGroup());
+  r->AddCapacity(1);
+  r->AddExchangeNode(u);
+  s->AddExchangeNode(v);
+  Arc a(u, v);
+  u->unit_capacities[a].push_back(1);
+  g3.AddRequestGroup(r);
+  g3.AddSupplyGroup(s);
+  g3.AddArc(a);
+  EXPECT_FALSE(solver.IsFlowGraph(&g3));
+  EXPECT_TRUE(FlowSolver(false).IsFlowGraph(&g3));
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(FlowSolverTests, Fallback) {
+  ExchangeGraph g1;
+  Arc arcs[3];
+  BuildCrossGraph(&g1, arcs);
+  arcs[0].vnode()->group->AddCapacity(5);
+  arcs[0].vnode()->unit_capacities[arcs[0]].push_back(1);
+  arcs[2].vnode()->unit_capacities[arcs[2]].push_back(1);
+
+  ExchangeGraph g2;
+  BuildCrossGraph(&g2, arcs);
+  arcs[0].vnode()->group->AddCapacity(5);
+  arcs[0].vnode()->unit_capacities[arcs[0]].push_back(1);
+  arcs[2].vnode()->unit_capacities[arcs[2]].push_back(1);
+
+  // the fallback's solution is used
+  FlowSolver flow(false);
+  GreedySolver greedy(false);
+  EXPECT_DOUBLE_EQ(greedy.Solve(&g2), flow.Solve(&g1));
+  ASSERT_EQ(g2.matches().size(), g1.matches().size());
+  for (int i = 0; i != g1.matches().size(); i++) {
+    EXPECT_EQ(g2.matches()[i].second, g1.matches()[i].second);
+  }
+}
+
+}  // namespace cyclus
@@ -83,3 +83,113 @@ TEST(GreedySolverTests, General) {
   EXPECT_EQ(g.request_groups()[1], gu1);
   EXPECT_EQ(g.request_groups()[0], gu2);
 }
+
+TEST(GreedySolverTests, BestFirst) {
+  // two requesters compete for a single supplier that can only satisfy one;
+  // without a preconditioner the default engine satisfies request groups in
+  // graph order, while the best-first engine gives the supply to the cheapest
+  // (most preferred) arc
+  ExchangeNode::Ptr u1(new ExchangeNode());
+  ExchangeNode::Ptr u2(new ExchangeNode());
+  ExchangeNode::Ptr v(new ExchangeNode());
+
+  Arc a1(u1, v);
+  Arc a2(u2, v);
+  a1.pref(1);
+  a2.pref(2);
+
+  u1->prefs[a1] = 1;
+  u1->unit_capacities[a1].push_back(1);
+  u2->prefs[a2] = 2;
+  u2->unit_capacities[a2].push_back(1);
+  v->unit_capacities[a1].push_back(1);
+  v->unit_capacities[a2].push_back(1);
+
+  RequestGroup::Ptr gu1(new RequestGroup(1));
+  gu1->AddExchangeNode(u1);
+  gu1->AddCapacity(1);
+  RequestGroup::Ptr gu2(new RequestGroup(1));
+  gu2->AddExchangeNode(u2);
+  gu2->AddCapacity(1);
+  ExchangeNodeGroup::Ptr gv(new ExchangeNodeGroup());
+  gv->AddExchangeNode(v);
+  gv->AddCapacity(1);
+
+  ExchangeGraph g;
+  g.AddRequestGroup(gu1);
+  g.AddRequestGroup(gu2);
+  g.AddSupplyGroup(gv);
+  g.AddArc(a1);
+  g.AddArc(a2);
+
+  bool excl = false;
+  GreedySolver s(excl);
+  EXPECT_FALSE(s.best_first());
+  s.best_first(true);
+  s.Solve(&g);
+
+  ASSERT_EQ(1, g.matches().size());
+  EXPECT_EQ(u2, g.matches()[0].first.unode());
+  EXPECT_DOUBLE_EQ(1, g.matches()[0].second);
+
+  ExchangeGraph h;
+  h.AddRequestGroup(gu1);
+  h.AddRequestGroup(gu2);
+  h.AddSupplyGroup(gv);
+  h.AddArc(a1);
+  h.AddArc(a2);
+
+  GreedyPreconditioner* c = NULL;
+  GreedySolver d(excl, c);
+  d.Solve(&h);
+
+  ASSERT_EQ(1, h.matches().size());
+  EXPECT_EQ(u1, h.matches()[0].first.unode());
+}
+
+TEST(GreedySolverTests, BestFirstGroupCapacity) {
+  // two bids of 3 share a supply capacity of 4, so the best-first engine
+  // gives the cheaper arc its full bid and the other arc what remains
+  ExchangeNode::Ptr u1(new ExchangeNode(3));
+  ExchangeNode::Ptr u2(new ExchangeNode(3));
+  ExchangeNode::Ptr v1(new ExchangeNode(3));
+  ExchangeNode::Ptr v2(new ExchangeNode(3));
+
+  Arc a1(u1, v1);
+  Arc a2(u2, v2);
+  a1.pref(1);
+  a2.pref(2);
+
+  u1->prefs[a1] = 1;
+  u1->unit_capacities[a1].push_back(1);
+  u2->prefs[a2] = 2;
+  u2->unit_capacities[a2].push_back(1);
+  v1->unit_capacities[a1].push_back(1);
+  v2->unit_capacities[a2].push_back(1);
+
+  RequestGroup::Ptr gu(new RequestGroup(6));
+  gu->AddExchangeNode(u1);
+  gu->AddExchangeNode(u2);
+  gu->AddCapacity(6);
+  ExchangeNodeGroup::Ptr gv(new ExchangeNodeGroup());
+  gv->AddExchangeNode(v1);
+  gv->AddExchangeNode(v2);
+  gv->AddCapacity(4);
+
+  ExchangeGraph g;
+  g.AddRequestGroup(gu);
+  g.AddSupplyGroup(gv);
+  g.AddArc(a1);
+  g.AddArc(a2);
+
+  GreedySolver s(false);
+  s.best_first(true);
+  s.Solve(&g);
+
+  ASSERT_EQ(2, g.matches().size());
+  EXPECT_EQ(u2, g.matches()[0].first.unode());
+  EXPECT_DOUBLE_EQ(3, g.matches()[0].second);
+  EXPECT_EQ(u1, g.matches()[1].first.unode());
+  EXPECT_DOUBLE_EQ(1, g.matches()[1].second);
+  EXPECT_EQ(4, gv->capacities()[0]);
+}
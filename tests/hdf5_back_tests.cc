@@ -254,3 +254,360 @@ TEST(Hdf5BackTest, Tables) {
   EXPECT_LE(1, tabs.size());
   EXPECT_EQ(1, tabs.count("IntTable"));
 }
+
+TEST(Hdf5BackTest, VLHeap) {
+  using std::string;
+  using std::vector;
+  using cyclus::Recorder;
+  using cyclus::Hdf5Back;
+  FileDeleter fd(path);
+
+  // enough distinct values to span several read blocks, with duplicates
+  int n = 1500;
+  int ndistinct = 700;
+  {
+    Recorder m;
+    Hdf5Back back(path);
+    m.RegisterBackend(&back);
+    for (int i = 0; i < n; ++i) {
+      int v = i % ndistinct;
+      m.NewDatum("VLTable")
+          ->AddVal("id", i)
+          ->AddVal("str", "s" + std::to_string(v))
+          ->AddVal("vec", vector<int>(v % 5 + 1, v))
+          ->Record();
+    }
+    m.Close();
+  }
+
+  // values are stored once, in 1D arrays
+  hid_t file = H5Fopen(path, H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t dset = H5Dopen2(file, "StringVals", H5P_DEFAULT);
+  hid_t dspace = H5Dget_space(dset);
+  EXPECT_EQ(1, H5Sget_simple_extent_ndims(dspace));
+  EXPECT_EQ(ndistinct, H5Sget_simple_extent_npoints(dspace));
+  H5Sclose(dspace);
+  H5Dclose(dset);
+  H5Fclose(file);
+
+  // reopening reads in the index, and appending keeps deduplicating
+  Recorder m;
+  Hdf5Back back(path);
+  m.RegisterBackend(&back);
+  m.NewDatum("VLTable")
+      ->AddVal("id", n)
+      ->AddVal("str", string("s3"))
+      ->AddVal("vec", vector<int>(1, -1))
+      ->Record();
+  m.Close();
+
+  cyclus::QueryResult qr = back.Query("VLTable", NULL);
+  ASSERT_EQ(n + 1, qr.rows.size());
+  for (int i = 0; i < n; ++i) {
+    int v = qr.GetVal<int>("id", i) % ndistinct;
+    EXPECT_EQ("s" + std::to_string(v), qr.GetVal<string>("str", i));
+    EXPECT_EQ(vector<int>(v % 5 + 1, v), qr.GetVal<vector<int> >("vec", i));
+  }
+  EXPECT_EQ("s3", qr.GetVal<string>("str", n));
+  EXPECT_EQ(vector<int>(1, -1), qr.GetVal<vector<int> >("vec", n));
+}
+
+/// Rewrites the 1D value array of a variable length type in the layout of
+/// older versions of Cyclus: a 5D array of extent UINT_MAX along every
+/// dimension, with single element chunks, indexed by the SHA1 key.
+static void MakeLegacyVals(hid_t file, std::string type) {
+  hid_t keysds = H5Dopen2(file, (type + "Keys").c_str(), H5P_DEFAULT);
+  hid_t keyspace = H5Dget_space(keysds);
+  hsize_t n = H5Sget_simple_extent_npoints(keyspace);
+  std::vector<unsigned int> keys(CYCLUS_SHA1_NINT * n);
+  hid_t keytype = H5Dget_type(keysds);
+  H5Dread(keysds, keytype, H5S_ALL, H5S_ALL, H5P_DEFAULT, &keys[0]);
+  H5Tclose(keytype);
+  H5Sclose(keyspace);
+  H5Dclose(keysds);
+
+  std::string name = type + "Vals";
+  hid_t valsds = H5Dopen2(file, name.c_str(), H5P_DEFAULT);
+  hid_t filetype = H5Dget_type(valsds);
+  hid_t dt = H5Tget_native_type(filetype, H5T_DIR_DEFAULT);
+  H5Tclose(filetype);
+  size_t elsize = H5Tget_size(dt);
+  std::vector<char> vals(elsize * n);
+  H5Dread(valsds, dt, H5S_ALL, H5S_ALL, H5P_DEFAULT, &vals[0]);
+  H5Dclose(valsds);
+  H5Ldelete(file, name.c_str(), H5P_DEFAULT);
+
+  hsize_t dims[CYCLUS_SHA1_NINT] = {UINT_MAX, UINT_MAX, UINT_MAX, UINT_MAX,
+                                    UINT_MAX};
+  hsize_t chunkdims[CYCLUS_SHA1_NINT] = {1, 1, 1, 1, 1};
+  hid_t dspace = H5Screate_simple(CYCLUS_SHA1_NINT, dims, dims);
+  hid_t prop = H5Pcreate(H5P_DATASET_CREATE);
+  H5Pset_chunk(prop, CYCLUS_SHA1_NINT, chunkdims);
+  valsds = H5Dcreate2(file, name.c_str(), dt, dspace, H5P_DEFAULT, prop,
+                      H5P_DEFAULT);
+  hid_t mspace = H5Screate_simple(CYCLUS_SHA1_NINT, chunkdims, NULL);
+  for (hsize_t i = 0; i < n; ++i) {
+    hsize_t idx[CYCLUS_SHA1_NINT];
+    for (int j = 0; j < CYCLUS_SHA1_NINT; ++j)
+      idx[j] = keys[CYCLUS_SHA1_NINT * i + j];
+    H5Sselect_hyperslab(dspace, H5S_SELECT_SET, idx, NULL, chunkdims, NULL);
+    H5Dwrite(valsds, dt, mspace, dspace, H5P_DEFAULT, &vals[elsize * i]);
+  }
+  hid_t vlspace = H5Screate_simple(1, &n, NULL);
+  H5Dvlen_reclaim(dt, vlspace, H5P_DEFAULT, &vals[0]);
+  H5Sclose(vlspace);
+  H5Tclose(dt);
+  H5Sclose(mspace);
+  H5Pclose(prop);
+  H5Sclose(dspace);
+  H5Dclose(valsds);
+}
+
+TEST(Hdf5BackTest, VLLegacy) {
+  using std::string;
+  using std::vector;
+  using cyclus::Recorder;
+  using cyclus::Hdf5Back;
+  FileDeleter fd(path);
+
+  {
+    Recorder m;
+    Hdf5Back back(path, true);
+    m.RegisterBackend(&back);
+    for (int i = 0; i < 3; ++i) {
+      m.NewDatum("VLTable")
+          ->AddVal("id", i)
+          ->AddVal("str", "s" + std::to_string(i))
+          ->AddVal("vec", vector<int>(i + 1, i))
+          ->Record();
+    }
+    m.Close();
+  }
+
+  // older versions did not record the hash algorithm
+  hid_t file = H5Fopen(path, H5F_ACC_RDWR, H5P_DEFAULT);
+  H5Adelete(file, "cyclus_vl_hash");
+  MakeLegacyVals(file, "String");
+  MakeLegacyVals(file, "VectorInt");
+  H5Fclose(file);
+
+  // legacy values are read, and new ones appended, by their keys
+  Recorder m;
+  Hdf5Back back(path);
+  m.RegisterBackend(&back);
+  m.NewDatum("VLTable")
+      ->AddVal("id", 3)
+      ->AddVal("str", string("s3"))
+      ->AddVal("vec", vector<int>(1, -1))
+      ->Record();
+  m.NewDatum("VLTable")
+      ->AddVal("id", 4)
+      ->AddVal("str", string("s1"))
+      ->AddVal("vec", vector<int>(2, 1))
+      ->Record();
+  m.Close();
+
+  cyclus::QueryResult qr = back.Query("VLTable", NULL);
+  ASSERT_EQ(5, qr.rows.size());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ("s" + std::to_string(i), qr.GetVal<string>("str", i));
+    EXPECT_EQ(vector<int>(i + 1, i), qr.GetVal<vector<int> >("vec", i));
+  }
+  EXPECT_EQ("s3", qr.GetVal<string>("str", 3));
+  EXPECT_EQ(vector<int>(1, -1), qr.GetVal<vector<int> >("vec", 3));
+  EXPECT_EQ("s1", qr.GetVal<string>("str", 4));
+  EXPECT_EQ(vector<int>(2, 1), qr.GetVal<vector<int> >("vec", 4));
+
+  // the arrays keep their layout, and duplicates are not appended
+  file = H5Fopen(path, H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t dset = H5Dopen2(file, "StringVals", H5P_DEFAULT);
+  hid_t dspace = H5Dget_space(dset);
+  EXPECT_EQ(CYCLUS_SHA1_NINT, H5Sget_simple_extent_ndims(dspace));
+  H5Sclose(dspace);
+  H5Dclose(dset);
+  dset = H5Dopen2(file, "StringKeys", H5P_DEFAULT);
+  dspace = H5Dget_space(dset);
+  EXPECT_EQ(4, H5Sget_simple_extent_npoints(dspace));
+  H5Sclose(dspace);
+  H5Dclose(dset);
+  H5Fclose(file);
+}
+
+TEST(Hdf5BackTest, VLHash) {
+  using std::string;
+  using cyclus::Recorder;
+  using cyclus::Hdf5Back;
+  using cyclus::Hasher;
+  FileDeleter fd(path);
+
+  // hashing in pieces gives the same digest as hashing at once
+  Hasher whole(Hasher::MURMUR3);
+  Hasher pieces(Hasher::MURMUR3);
+  string s = "the quick brown fox jumps over the lazy dog";
+  whole.Update(s);
+  for (int i = 0; i < s.size(); i += 7)
+    pieces.Update(s.substr(i, 7));
+  EXPECT_TRUE(whole.digest() == pieces.digest());
+  pieces.Clear();
+  pieces.Update(s.substr(1));
+  EXPECT_FALSE(whole.digest() == pieces.digest());
+
+  // reference MurmurHash3_x64_128 values with seed 0, as the low and high
+  // words of h1 and h2, followed by the length
+  const char* keys[] = {"", "hello",
+                        "The quick brown fox jumps over the lazy dog"};
+  unsigned int known[][5] = {
+      {0, 0, 0, 0, 0},
+      {0x41bd9b02, 0xcbd8a7b3, 0x48ae1d19, 0x5b1e906a, 5},
+      {0xbc071b6c, 0xe34bbc7b, 0xc49a9347, 0x7a433ca9, 43},
+  };
+  for (int i = 0; i < 3; ++i) {
+    Hasher h(Hasher::MURMUR3);
+    h.Update(string(keys[i]));
+    cyclus::Digest d = h.digest();
+    for (int j = 0; j < 5; ++j)
+      EXPECT_EQ(known[i][j], d.val[j]) << keys[i] << " word " << j;
+  }
+
+  // the algorithm of a database is kept when it is reopened
+  for (int n = 0; n < 2; ++n) {
+    Recorder m;
+    Hdf5Back back(path, n == 0);
+    m.RegisterBackend(&back);
+    m.NewDatum("VLTable")->AddVal("str", string("apple"))->Record();
+    m.Close();
+  }
+  hid_t file = H5Fopen(path, H5F_ACC_RDONLY, H5P_DEFAULT);
+  int algorithm;
+  hid_t attr = H5Aopen_by_name(file, "/", "cyclus_vl_hash", H5P_DEFAULT,
+                               H5P_DEFAULT);
+  H5Aread(attr, H5T_NATIVE_INT, &algorithm);
+  H5Aclose(attr);
+  hid_t dset = H5Dopen2(file, "StringKeys", H5P_DEFAULT);
+  hid_t dspace = H5Dget_space(dset);
+  EXPECT_EQ(Hasher::SHA1, algorithm);
+  EXPECT_EQ(1, H5Sget_simple_extent_npoints(dspace));
+  H5Sclose(dspace);
+  H5Dclose(dset);
+  H5Fclose(file);
+}
+
+TEST(Hdf5BackTest, Storage) {
+  using std::string;
+  using cyclus::Recorder;
+  using cyclus::Hdf5Back;
+  FileDeleter fd(path);
+
+  Hdf5Back back(path);
+  Hdf5Back::TableStorage s;
+  EXPECT_EQ(1024, back.storage("IntTable").chunk_size);
+  s.chunk_size = 0;
+  EXPECT_THROW(back.storage("", s), cyclus::ValueError);
+  s.chunk_size = 16;
+  s.codec = "gzip";
+  EXPECT_THROW(back.storage("", s), cyclus::ValueError);
+  s.codec = "deflate";
+  s.level = 10;
+  EXPECT_THROW(back.storage("", s), cyclus::ValueError);
+  s.level = 1;
+  s.shuffle = true;
+  back.storage("", s);
+  s.chunk_size = 100;
+  s.codec = "none";
+  back.storage("RawTable", s);
+  EXPECT_EQ(16, back.storage("IntTable").chunk_size);
+  EXPECT_EQ("none", back.storage("RawTable").codec);
+
+  Recorder m;
+  m.RegisterBackend(&back);
+  m.NewDatum("IntTable")->AddVal("intcol", 1)->Record();
+  m.NewDatum("RawTable")->AddVal("intcol", 2)->Record();
+  m.Close();
+
+  hid_t file = H5Fopen(path, H5F_ACC_RDONLY, H5P_DEFAULT);
+  hsize_t chunk;
+  unsigned int flags;
+  size_t nelmts = 1;
+  unsigned int level;
+  hid_t dset = H5Dopen2(file, "IntTable", H5P_DEFAULT);
+  hid_t plist = H5Dget_create_plist(dset);
+  EXPECT_EQ(1, H5Pget_chunk(plist, 1, &chunk));
+  EXPECT_EQ(16, chunk);
+  ASSERT_EQ(2, H5Pget_nfilters(plist));
+  EXPECT_EQ(H5Z_FILTER_SHUFFLE,
+            H5Pget_filter2(plist, 0, &flags, NULL, NULL, 0, NULL, NULL));
+  EXPECT_EQ(H5Z_FILTER_DEFLATE,
+            H5Pget_filter2(plist, 1, &flags, &nelmts, &level, 0, NULL, NULL));
+  EXPECT_EQ(1, level);
+  H5Pclose(plist);
+  H5Dclose(dset);
+
+  dset = H5Dopen2(file, "RawTable", H5P_DEFAULT);
+  plist = H5Dget_create_plist(dset);
+  H5Pget_chunk(plist, 1, &chunk);
+  EXPECT_EQ(100, chunk);
+  EXPECT_EQ(1, H5Pget_nfilters(plist));
+  H5Pclose(plist);
+  H5Dclose(dset);
+  H5Fclose(file);
+
+  // the tables are still H5TB tables
+  hsize_t nfields;
+  hsize_t nrecords;
+  file = H5Fopen(path, H5F_ACC_RDONLY, H5P_DEFAULT);
+  EXPECT_LE(0, H5TBget_table_info(file, "IntTable", &nfields, &nrecords));
+  EXPECT_EQ(1, nrecords);
+  H5Fclose(file);
+  cyclus::QueryResult qr = back.Query("RawTable", NULL);
+  ASSERT_EQ(1, qr.rows.size());
+  EXPECT_EQ(2, qr.GetVal<int>("intcol"));
+}
+
+// Writes and reads back a wide table with every codec and several chunk
+// sizes.
+TEST(Hdf5BackTest, StorageSweep) {
+  using std::string;
+  using cyclus::Recorder;
+  using cyclus::Hdf5Back;
+  const char* codecs[] = {"none", "deflate", "lz4", "zstd"};
+  hsize_t chunks[] = {16, 256, 1024};
+  int n = 2000;
+
+  for (int c = 0; c < 4; ++c) {
+    for (int k = 0; k < 3; ++k) {
+      FileDeleter fd(path);
+      Hdf5Back::TableStorage s;
+      s.codec = codecs[c];
+      s.level = s.codec == "deflate" ? 1 : s.codec == "zstd" ? 3 : 0;
+      s.chunk_size = chunks[k];
+      s.shuffle = s.codec != "none";
+
+      {
+        Recorder m;
+        Hdf5Back back(path);
+        back.storage("", s);
+        m.RegisterBackend(&back);
+        for (int i = 0; i < n; ++i) {
+          m.NewDatum("Wide")
+              ->AddVal("a", i)
+              ->AddVal("b", i % 17)
+              ->AddVal("c", 0.5 * i)
+              ->AddVal("d", 1.0)
+              ->AddVal("e", string("fixed"))
+              ->Record();
+        }
+        m.Close();
+      }
+
+      Hdf5Back back(path);
+      cyclus::QueryResult qr = back.Query("Wide", NULL);
+      ASSERT_EQ(n, qr.rows.size()) << s.codec << " chunk " << s.chunk_size;
+      for (int i = 0; i < n; i += 997) {
+        EXPECT_EQ(i, qr.GetVal<int>("a", i));
+        EXPECT_EQ(i % 17, qr.GetVal<int>("b", i));
+        EXPECT_DOUBLE_EQ(0.5 * i, qr.GetVal<double>("c", i));
+        EXPECT_EQ("fixed", qr.GetVal<string>("e", i));
+      }
+    }
+  }
+}
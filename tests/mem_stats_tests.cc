@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include "composition.h"
+#include "exchange_graph.h"
+#include "material.h"
+#include "mem_stats.h"
+#include "product.h"
+
+using cyclus::MemStats;
+
+TEST(MemStatsTests, Counts) {
+  MemStats::Enable(true);
+  long ncomp = MemStats::count(MemStats::COMPOSITION);
+  long nmat = MemStats::count(MemStats::MATERIAL);
+  long nprod = MemStats::count(MemStats::PRODUCT);
+  long matbytes = MemStats::bytes(MemStats::MATERIAL);
+  {
+    cyclus::CompMap v;
+    v[922350000] = 1;
+    cyclus::Composition::Ptr c = cyclus::Composition::CreateFromAtom(v);
+    cyclus::Material::Ptr m = cyclus::Material::CreateUntracked(1, c);
+    cyclus::Resource::Ptr clone = m->Clone();
+    cyclus::Product::Ptr p = cyclus::Product::CreateUntracked(1, "bananas");
+    EXPECT_EQ(ncomp + 1, MemStats::count(MemStats::COMPOSITION));
+    EXPECT_EQ(nmat + 2, MemStats::count(MemStats::MATERIAL));
+    EXPECT_EQ(nprod + 1, MemStats::count(MemStats::PRODUCT));
+    EXPECT_EQ(matbytes + 2 * sizeof(cyclus::Material),
+              MemStats::bytes(MemStats::MATERIAL));
+  }
+  EXPECT_EQ(ncomp, MemStats::count(MemStats::COMPOSITION));
+  EXPECT_EQ(nmat, MemStats::count(MemStats::MATERIAL));
+  EXPECT_EQ(nprod, MemStats::count(MemStats::PRODUCT));
+  EXPECT_EQ(matbytes, MemStats::bytes(MemStats::MATERIAL));
+  MemStats::Enable(false);
+}
+
+TEST(MemStatsTests, ExchangeGraph) {
+  MemStats::Enable(true);
+  long nnodes = MemStats::count(MemStats::EXCHANGE_NODE);
+  long narcs = MemStats::count(MemStats::ARC);
+  {
+    cyclus::ExchangeNode::Ptr u(new cyclus::ExchangeNode());
+    cyclus::ExchangeNode::Ptr v(new cyclus::ExchangeNode());
+    cyclus::Arc a(u, v);
+    cyclus::Arc b(a);
+    cyclus::ExchangeNode copy(*u);
+    EXPECT_EQ(nnodes + 3, MemStats::count(MemStats::EXCHANGE_NODE));
+    EXPECT_EQ(narcs + 2, MemStats::count(MemStats::ARC));
+  }
+  EXPECT_EQ(nnodes, MemStats::count(MemStats::EXCHANGE_NODE));
+  EXPECT_EQ(narcs, MemStats::count(MemStats::ARC));
+  MemStats::Enable(false);
+}
+
+TEST(MemStatsTests, HighWater) {
+  MemStats::Enable(true);
+  long n = MemStats::count(MemStats::PRODUCT);
+  EXPECT_EQ(n, MemStats::peak(MemStats::PRODUCT));
+  {
+    cyclus::Product::Ptr p1 = cyclus::Product::CreateUntracked(1, "bananas");
+    cyclus::Product::Ptr p2 = cyclus::Product::CreateUntracked(1, "bananas");
+  }
+  EXPECT_EQ(n, MemStats::count(MemStats::PRODUCT));
+  EXPECT_EQ(n + 2, MemStats::peak(MemStats::PRODUCT));
+
+  MemStats::ResetPeaks();
+  EXPECT_EQ(n, MemStats::peak(MemStats::PRODUCT));
+
+  // nothing is tracked while disabled
+  MemStats::Enable(false);
+  cyclus::Product::Ptr p = cyclus::Product::CreateUntracked(1, "bananas");
+  EXPECT_EQ(n, MemStats::count(MemStats::PRODUCT));
+  EXPECT_EQ(n, MemStats::peak(MemStats::PRODUCT));
+}
+
+TEST(MemStatsTests, AddExisting) {
+  MemStats::AddExisting(MemStats::DATUM, 3, 8);
+  EXPECT_EQ(0, MemStats::count(MemStats::DATUM));
+
+  MemStats::Enable(true);
+  long n = MemStats::count(MemStats::DATUM);
+  MemStats::AddExisting(MemStats::DATUM, 3, 8);
+  EXPECT_EQ(n + 3, MemStats::count(MemStats::DATUM));
+  EXPECT_EQ(n + 3, MemStats::peak(MemStats::DATUM));
+  MemStats::Remove(MemStats::DATUM, 8);
+  EXPECT_EQ(n + 2, MemStats::count(MemStats::DATUM));
+  EXPECT_EQ(n + 3, MemStats::peak(MemStats::DATUM));
+  MemStats::Enable(false);
+}
+
+TEST(MemStatsTests, StartOnEnable) {
+  cyclus::Product::Ptr before = cyclus::Product::CreateUntracked(1, "bananas");
+  MemStats::Enable(true);
+  EXPECT_EQ(0, MemStats::count(MemStats::PRODUCT));
+  EXPECT_EQ(0, MemStats::bytes(MemStats::PRODUCT));
+  EXPECT_EQ(0, MemStats::peak(MemStats::PRODUCT));
+
+  cyclus::Product::Ptr after = cyclus::Product::CreateUntracked(1, "bananas");
+  EXPECT_EQ(1, MemStats::count(MemStats::PRODUCT));
+
+  // objects from before counting started are uncounted when destroyed
+  before.reset();
+  after.reset();
+  EXPECT_EQ(-1, MemStats::count(MemStats::PRODUCT));
+  MemStats::Enable(false);
+}
+
+TEST(MemStatsTests, Name) {
+  EXPECT_EQ("Composition", MemStats::Name(MemStats::COMPOSITION));
+  EXPECT_EQ("Datum", MemStats::Name(MemStats::DATUM));
+  EXPECT_EQ("ExchangeNode", MemStats::Name(MemStats::EXCHANGE_NODE));
+  EXPECT_EQ("DecayChain", MemStats::Name(MemStats::DECAY_CHAIN));
+}
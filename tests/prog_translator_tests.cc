@@ -4,6 +4,7 @@
 
 #include "CoinModel.hpp"
 #include "CoinPackedMatrix.hpp"
+#include "CoinPackedVector.hpp"
 #include "OsiClpSolverInterface.hpp"
 #include "OsiSolverInterface.hpp"
 
@@ -211,6 +212,8 @@ TEST(ProgTranslatorTests, translation) {
   double row_val_7[] = {1, 1};
   m.appendRow(2, row_ind_7, row_val_7);
 
+  // the translator assembles the matrix column-ordered
+  m.reverseOrdering();
   EXPECT_TRUE(m.isEquivalent2(pt.ctx().m));
 
   // test population
@@ -279,6 +282,96 @@ TEST(ProgTranslatorTests, translation) {
   delete iface;
 }
 
+// a synthetic exchange in which each of nreq requesters (one node, two
+// constraints) is bid on by every one of nsup suppliers (two constraints)
+void BuildLargeGraph(ExchangeGraph* g, int nreq, int nsup) {
+  std::vector<ExchangeNodeGroup::Ptr> sups;
+  for (int j = 0; j != nsup; j++) {
+    ExchangeNodeGroup::Ptr sup(new ExchangeNodeGroup());
+    sup->AddCapacity(10);
+    sup->AddCapacity(20);
+    g->AddSupplyGroup(sup);
+    sups.push_back(sup);
+  }
+  for (int i = 0; i != nreq; i++) {
+    RequestGroup::Ptr req(new RequestGroup(5));
+    req->AddCapacity(5);
+    req->AddCapacity(7);
+    ExchangeNode::Ptr u(new ExchangeNode(5, false, "commod", i));
+    req->AddExchangeNode(u);
+    g->AddRequestGroup(req);
+    for (int j = 0; j != nsup; j++) {
+      ExchangeNode::Ptr v(new ExchangeNode(5, false, "commod", nreq + j));
+      sups[j]->AddExchangeNode(v);
+      Arc a(u, v);
+      a.pref(1 + j);
+      u->unit_capacities[a].push_back(1);
+      u->unit_capacities[a].push_back(1.5);
+      v->unit_capacities[a].push_back(1);
+      v->unit_capacities[a].push_back(0.5);
+      g->AddArc(a);
+    }
+  }
+}
+
+// checks that the two ways of assembling and loading the constraint matrix of
+// the same program agree: appending one CoinPackedVector per row to a
+// row-ordered matrix, as older versions did, and building it column-ordered
+// from (row, column, value) triplets in one step, as Translate() does.
+TEST(ProgTranslatorTests, LargeGraphAssembly) {
+  SolverFactory sf("clp");
+  ExchangeGraph g;
+  BuildLargeGraph(&g, 200, 10);
+  OsiSolverInterface* iface = sf.get();
+  ProgTranslator pt(&g, iface, false, 1e6);
+  pt.Translate();
+  const ProgTranslatorContext& ctx = pt.ctx();
+
+  // the coefficients of the program, by row and as triplets
+  CoinPackedMatrix byrow(ctx.m);
+  byrow.reverseOrdering();
+  int nrows = byrow.getNumRows();
+  int ncols = byrow.getNumCols();
+  std::vector<std::vector<int> > rowcols(nrows);
+  std::vector<std::vector<double> > rowvals(nrows);
+  std::vector<int> trows;
+  std::vector<int> tcols;
+  std::vector<double> tvals;
+  for (int i = 0; i != nrows; i++) {
+    CoinShallowPackedVector r = byrow.getVector(i);
+    for (int k = 0; k != r.getNumElements(); k++) {
+      rowcols[i].push_back(r.getIndices()[k]);
+      rowvals[i].push_back(r.getElements()[k]);
+      trows.push_back(i);
+      tcols.push_back(r.getIndices()[k]);
+      tvals.push_back(r.getElements()[k]);
+    }
+  }
+
+  OsiSolverInterface* rowiface = sf.get();
+  CoinPackedMatrix rowm(false, 0, 0);
+  rowm.setDimensions(0, ncols);
+  for (int i = 0; i != nrows; i++) {
+    CoinPackedVector v;
+    for (int k = 0; k != rowcols[i].size(); k++)
+      v.insert(rowcols[i][k], rowvals[i][k]);
+    rowm.appendRow(v);
+  }
+  rowiface->loadProblem(rowm, &ctx.col_lbs[0], &ctx.col_ubs[0],
+                        &ctx.obj_coeffs[0], &ctx.row_lbs[0], &ctx.row_ubs[0]);
+
+  OsiSolverInterface* coliface = sf.get();
+  CoinPackedMatrix colm(true, &trows[0], &tcols[0], &tvals[0], tvals.size());
+  coliface->loadProblem(colm, &ctx.col_lbs[0], &ctx.col_ubs[0],
+                        &ctx.obj_coeffs[0], &ctx.row_lbs[0], &ctx.row_ubs[0]);
+
+  EXPECT_TRUE(rowiface->getMatrixByCol()->isEquivalent(
+      *coliface->getMatrixByCol()));
+  delete iface;
+  delete rowiface;
+  delete coliface;
+}
+
 TEST(ProgTranslatorTests, depricated) {
 
   // confirm depricated error is thrown
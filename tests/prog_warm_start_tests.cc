@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "CoinMessageHandler.hpp"
+#include "CoinWarmStartBasis.hpp"
+#include "OsiSolverInterface.hpp"
+
+#include "exchange_graph.h"
+#include "prog_translator.h"
+#include "prog_warm_start.h"
+#include "solver_factory.h"
+
+namespace cyclus {
+
+// a single supplier (agent 0) with capacity cap bids on one request from each
+// of nreq requesters (agents 1 to nreq), each requesting qty; later requesters
+// are preferred
+void BuildWarmStartGraph(ExchangeGraph* g, int nreq, double qty, double cap) {
+  ExchangeNodeGroup::Ptr sup(new ExchangeNodeGroup());
+  sup->AddCapacity(cap);
+  g->AddSupplyGroup(sup);
+  for (int i = 0; i != nreq; i++) {
+    ExchangeNode::Ptr u(new ExchangeNode(qty, false, "commod", i + 1));
+    ExchangeNode::Ptr v(new ExchangeNode(qty, false, "commod", 0));
+    Arc a(u, v);
+    a.pref(i + 1);
+    u->unit_capacities[a].push_back(1);
+    v->unit_capacities[a].push_back(1);
+    u->prefs[a] = i + 1;
+
+    RequestGroup::Ptr req(new RequestGroup(qty));
+    req->AddCapacity(qty);
+    req->AddExchangeNode(u);
+    g->AddRequestGroup(req);
+    sup->AddExchangeNode(v);
+    g->AddArc(a);
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(ProgWarmStartTests, Keys) {
+  SolverFactory sf("clp");
+  OsiSolverInterface* iface = sf.get();
+  ExchangeGraph g;
+  BuildWarmStartGraph(&g, 2, 1.0, 1.5);
+  ProgTranslator pt(&g, iface, false, 10);
+  EXPECT_FALSE(pt.keys());
+  pt.keys(true);
+  pt.ToProg();
+  const ProgTranslatorContext& ctx = pt.ctx();
+
+  // arcs, then faux arcs
+  EXPECT_EQ(ProgKey::ARC, ctx.col_keys[0].kind);
+  EXPECT_EQ(1, ctx.col_keys[0].u);
+  EXPECT_EQ(0, ctx.col_keys[0].v);
+  EXPECT_EQ("commod", ctx.col_keys[0].commod);
+  EXPECT_EQ(2, ctx.col_keys[1].u);
+  EXPECT_EQ(ProgKey::FAUX, ctx.col_keys[2].kind);
+  EXPECT_EQ(1, ctx.col_keys[2].u);
+  EXPECT_EQ(ProgKey::FAUX, ctx.col_keys[3].kind);
+  EXPECT_EQ(2, ctx.col_keys[3].u);
+
+  // supply rows, then request rows
+  ASSERT_EQ(3, ctx.row_keys.size());
+  EXPECT_EQ(ProgKey::SUP_CAP, ctx.row_keys[0].kind);
+  EXPECT_EQ(0, ctx.row_keys[0].v);
+  EXPECT_EQ(ProgKey::REQ_CAP, ctx.row_keys[1].kind);
+  EXPECT_EQ(1, ctx.row_keys[1].u);
+  EXPECT_EQ(ProgKey::REQ_CAP, ctx.row_keys[2].kind);
+  EXPECT_EQ(2, ctx.row_keys[2].u);
+  delete iface;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(ProgWarmStartTests, StoreApply) {
+  SolverFactory sf("clp");
+  CoinMessageHandler h;
+  h.setLogLevel(0);
+  ProgWarmStart ws;
+  std::vector<double> start;
+
+  // the first exchange has nothing to start from
+  ExchangeGraph g1;
+  BuildWarmStartGraph(&g1, 2, 1.0, 1.5);
+  OsiSolverInterface* iface1 = sf.get();
+  iface1->passInMessageHandler(&h);
+  ProgTranslator pt1(&g1, iface1, false, 10);
+  pt1.keys(true);
+  pt1.ToProg();
+  EXPECT_EQ(0, ws.Apply(iface1, pt1.ctx(), &start));
+  SolveProg(iface1);
+  ws.Store(iface1, pt1.ctx(), 0, true);
+  EXPECT_EQ(4, ws.ncols());
+  EXPECT_EQ(3, ws.nrows());
+  EXPECT_DOUBLE_EQ(0.5, iface1->getColSolution()[0]);
+
+  // the second exchange gains a requester
+  ExchangeGraph g2;
+  BuildWarmStartGraph(&g2, 3, 1.0, 1.5);
+  OsiSolverInterface* iface2 = sf.get();
+  iface2->passInMessageHandler(&h);
+  ProgTranslator pt2(&g2, iface2, false, 10);
+  pt2.keys(true);
+  pt2.ToProg();
+  EXPECT_EQ(4, ws.Apply(iface2, pt2.ctx(), &start));
+  ASSERT_EQ(6, start.size());
+  EXPECT_DOUBLE_EQ(0.5, start[0]);  // requester 1's arc
+  EXPECT_DOUBLE_EQ(1.0, start[1]);  // requester 2's arc
+  EXPECT_DOUBLE_EQ(0, start[2]);  // requester 3's arc is new
+  SolveProg(iface2);
+
+  // the warm start must not change the answer
+  ExchangeGraph g3;
+  BuildWarmStartGraph(&g3, 3, 1.0, 1.5);
+  OsiSolverInterface* iface3 = sf.get();
+  iface3->passInMessageHandler(&h);
+  ProgTranslator pt3(&g3, iface3, false, 10);
+  pt3.keys(true);
+  pt3.ToProg();
+  SolveProg(iface3);
+  EXPECT_DOUBLE_EQ(iface3->getObjValue(), iface2->getObjValue());
+
+  delete iface1;
+  delete iface2;
+  delete iface3;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(ProgWarmStartTests, NoBasis) {
+  SolverFactory sf("clp");
+  CoinMessageHandler h;
+  h.setLogLevel(0);
+  ProgWarmStart ws;
+  std::vector<double> start;
+
+  ExchangeGraph g1;
+  BuildWarmStartGraph(&g1, 2, 1.0, 1.5);
+  OsiSolverInterface* iface1 = sf.get();
+  iface1->passInMessageHandler(&h);
+  ProgTranslator pt1(&g1, iface1, false, 10);
+  pt1.keys(true);
+  pt1.ToProg();
+  SolveProg(iface1);
+  ws.Store(iface1, pt1.ctx(), 0, false);
+
+  // the solution is mapped, but the basis of iface1 is not
+  ExchangeGraph g2;
+  BuildWarmStartGraph(&g2, 2, 1.0, 1.5);
+  OsiSolverInterface* iface2 = sf.get();
+  iface2->passInMessageHandler(&h);
+  ProgTranslator pt2(&g2, iface2, false, 10);
+  pt2.keys(true);
+  pt2.ToProg();
+  EXPECT_EQ(4, ws.Apply(iface2, pt2.ctx(), &start));
+  EXPECT_DOUBLE_EQ(0.5, start[0]);
+  CoinWarmStartBasis* basis =
+      dynamic_cast<CoinWarmStartBasis*>(iface2->getWarmStart());
+  ASSERT_TRUE(basis != NULL);
+  for (int i = 0; i != iface2->getNumCols(); i++)
+    EXPECT_EQ(CoinWarmStartBasis::atLowerBound, basis->getStructStatus(i));
+  for (int i = 0; i != iface2->getNumRows(); i++)
+    EXPECT_EQ(CoinWarmStartBasis::basic, basis->getArtifStatus(i));
+
+  delete basis;
+  delete iface1;
+  delete iface2;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(ProgWarmStartTests, Prune) {
+  SolverFactory sf("clp");
+  CoinMessageHandler h;
+  h.setLogLevel(0);
+  ProgWarmStart ws;
+
+  ExchangeGraph g1;
+  BuildWarmStartGraph(&g1, 2, 1.0, 1.5);
+  OsiSolverInterface* iface1 = sf.get();
+  iface1->passInMessageHandler(&h);
+  ProgTranslator pt1(&g1, iface1, false, 10);
+  pt1.keys(true);
+  pt1.ToProg();
+  SolveProg(iface1);
+  ws.Store(iface1, pt1.ctx(), 0, true);
+  EXPECT_EQ(4, ws.ncols());
+
+  // requester 2 leaves and its entries age out after kMaxAge timesteps, no
+  // matter how many exchanges are stored in each
+  ExchangeGraph g2;
+  BuildWarmStartGraph(&g2, 1, 1.0, 1.5);
+  OsiSolverInterface* iface2 = sf.get();
+  iface2->passInMessageHandler(&h);
+  ProgTranslator pt2(&g2, iface2, false, 10);
+  pt2.keys(true);
+  pt2.ToProg();
+  SolveProg(iface2);
+  for (int t = 0; t != ProgWarmStart::kMaxAge; t++) {
+    ws.Store(iface2, pt2.ctx(), t, true);
+    ws.Store(iface2, pt2.ctx(), t, true);
+    EXPECT_EQ(4, ws.ncols());
+  }
+  ws.Store(iface2, pt2.ctx(), ProgWarmStart::kMaxAge, true);
+  EXPECT_EQ(2, ws.ncols());
+  EXPECT_EQ(2, ws.nrows());
+
+  ws.Clear();
+  EXPECT_EQ(0, ws.ncols());
+  delete iface1;
+  delete iface2;
+}
+
+}  // namespace cyclus
@@ -163,6 +163,47 @@ TEST(RecorderTest, Manager_CloseFlushing) {
   EXPECT_EQ(back1.notify_count, 1);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(RecorderTest, Manager_DeferReplay) {
+  using cyclus::DatumList;
+  using cyclus::Recorder;
+  TestBack back;
+  Recorder m;
+  m.set_dump_count(10);
+  m.RegisterBackend(&back);
+
+  DatumList a;
+  DatumList b;
+  Recorder::Defer(&a);
+  m.NewDatum("DumbTitle")->AddVal("animal", std::string("monkey"))->Record();
+  m.NewDatum("DumbTitle")->AddVal("animal", std::string("elephant"))->Record();
+  Recorder::Defer(&b);
+  m.NewDatum("DumbTitle")->AddVal("animal", std::string("giraffe"))->Record();
+  Recorder::Defer(NULL);
+
+  EXPECT_EQ(2, a.size());
+  EXPECT_EQ(1, b.size());
+  EXPECT_EQ(0, m.buffered());
+
+  // datums are recorded in replay order, not in creation order
+  m.Replay(&b);
+  m.Replay(&a);
+  EXPECT_EQ(0, a.size());
+  EXPECT_EQ(0, b.size());
+  EXPECT_EQ(3, m.buffered());
+
+  m.Close();
+  ASSERT_EQ(3, back.data.size());
+  std::string want[] = {"giraffe", "monkey", "elephant"};
+  for (int i = 0; i < 3; ++i) {
+    cyclus::Datum* d = back.data[i];
+    ASSERT_EQ(2, d->vals().size());
+    EXPECT_STREQ("SimId", d->vals()[0].first);
+    EXPECT_EQ(m.sim_id(), d->vals()[0].second.cast<boost::uuids::uuid>());
+    EXPECT_EQ(want[i], d->vals()[1].second.cast<std::string>());
+  }
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 TEST(RecorderTest, Datum_record) {
   using cyclus::Datum;
@@ -29,6 +29,7 @@ using cyclus::Facility;
 using cyclus::Material;
 using cyclus::Agent;
 using cyclus::PrefMap;
+using cyclus::PrefTable;
 using cyclus::Request;
 using cyclus::RequestPortfolio;
 using cyclus::ResourceExchange;
@@ -63,11 +64,10 @@ class Requester: public TestFacility {
 
   // increments counter and squares all preferences
   virtual void AdjustMatlPrefs(PrefMap<Material>::type& prefs) {
-    std::map<Request<Material>*,
-             std::map<Bid<Material>*, double> >::iterator p_it;
+    PrefMap<Material>::type::iterator p_it;
     for (p_it = prefs.begin(); p_it != prefs.end(); ++p_it) {
-      std::map<Bid<Material>*, double>& map = p_it->second;
-      std::map<Bid<Material>*, double>::iterator m_it;
+      PrefMap<Material>::bid_map& map = p_it->second;
+      PrefMap<Material>::bid_map::iterator m_it;
       for (m_it = map.begin(); m_it != map.end(); ++m_it) {
         m_it->second = std::pow(m_it->second, 2);
       }
@@ -109,6 +109,27 @@ class Bidder: public TestFacility {
   int bid_ctr_;
 };
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class Manager: public TestFacility {
+ public:
+  Manager(Context* ctx) : TestFacility(ctx) { UsePrefTables(true); }
+
+  virtual cyclus::Agent* Clone() {
+    Manager* m = new Manager(context());
+    m->InitFrom(this);
+    return m;
+  }
+
+  // records the table and halves all preferences
+  virtual void AdjustMatlPrefTable(PrefTable<Material>& prefs) {
+    for (int i = 0; i != prefs.size(); i++)
+      prefs.prefs[i] *= 0.5;
+    table_ = prefs;
+  }
+
+  PrefTable<Material> table_;
+};
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 class ResourceExchangeTests: public ::testing::Test {
  protected:
@@ -322,3 +343,98 @@ TEST_F(ResourceExchangeTests, PrefValues) {
   child->Decommission();
   parent->Decommission();
 }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(ResourceExchangeTests, PrefTables) {
+  Manager* mgr = new Manager(tc.get());
+  Facility* parent = dynamic_cast<Facility*>(mgr->Clone());
+  Facility* child1 = dynamic_cast<Facility*>(reqr->Clone());
+  Facility* child2 = dynamic_cast<Facility*>(reqr->Clone());
+  parent->Build(NULL);
+  child1->Build(parent);
+  child2->Build(parent);
+
+  Manager* pcast = dynamic_cast<Manager*>(parent);
+  Requester* c1cast = dynamic_cast<Requester*>(child1);
+  Requester* c2cast = dynamic_cast<Requester*>(child2);
+
+  RequestPortfolio<Material>::Ptr rp1(new RequestPortfolio<Material>());
+  Request<Material>* req1 = rp1->AddRequest(mat, c1cast, commod, pref);
+  c1cast->port_ = rp1;
+  RequestPortfolio<Material>::Ptr rp2(new RequestPortfolio<Material>());
+  Request<Material>* req2 = rp2->AddRequest(mat, c2cast, commod, pref);
+  c2cast->port_ = rp2;
+
+  Bidder* bidr = new Bidder(tc.get(), commod);
+  BidPortfolio<Material>::Ptr bp(new BidPortfolio<Material>());
+  Bid<Material>* bid1 = bp->AddBid(req1, mat, bidr);
+  Bid<Material>* bid2 = bp->AddBid(req2, mat, bidr);
+  bidr->port_ = bp;
+  Facility* bclone = dynamic_cast<Facility*>(bidr->Clone());
+  bclone->Build(NULL);
+
+  exchng->AddAllRequests();
+  exchng->AddAllBids();
+  exchng->AdjustAll();
+
+  // the manager sees both children's arcs after they adjusted their own
+  const PrefTable<Material>& table = pcast->table_;
+  ASSERT_EQ(2, table.size());
+  EXPECT_EQ(req1, table.requests[0]);
+  EXPECT_EQ(req2, table.requests[1]);
+  EXPECT_EQ(bid1, table.bids[0]);
+  EXPECT_EQ(bid2, table.bids[1]);
+  EXPECT_EQ(child1->id(), table.requester_ids[0]);
+  EXPECT_EQ(child2->id(), table.requester_ids[1]);
+  EXPECT_EQ(bidr->id(), table.bidder_ids[0]);
+  EXPECT_EQ(bidr->id(), table.bidder_ids[1]);
+  ASSERT_EQ(1, table.commods.size());
+  EXPECT_EQ(commod, table.commods[0]);
+  EXPECT_EQ(0, table.commod_ids[0]);
+  EXPECT_EQ(0, table.commod_ids[1]);
+
+  // and its adjustments are written back
+  double exp = std::pow(pref, 2) * 0.5;
+  ExchangeContext<Material>& context = exchng->ex_ctx();
+  EXPECT_DOUBLE_EQ(exp, context.trader_prefs[child1][req1][bid1]);
+  EXPECT_DOUBLE_EQ(exp, context.trader_prefs[child2][req2][bid2]);
+
+  child1->Decommission();
+  child2->Decommission();
+  parent->Decommission();
+}
+
+TEST_F(ResourceExchangeTests, PrefTablesOptIn) {
+  Manager* mgr = new Manager(tc.get());
+  Facility* parent = dynamic_cast<Facility*>(mgr->Clone());
+  Facility* child = dynamic_cast<Facility*>(reqr->Clone());
+  parent->Build(NULL);
+  child->Build(parent);
+  EXPECT_TRUE(parent->use_pref_tables());
+  parent->UsePrefTables(false);
+
+  Manager* pcast = dynamic_cast<Manager*>(parent);
+  Requester* ccast = dynamic_cast<Requester*>(child);
+  RequestPortfolio<Material>::Ptr rp(new RequestPortfolio<Material>());
+  Request<Material>* req = rp->AddRequest(mat, ccast, commod, pref);
+  ccast->port_ = rp;
+
+  Bidder* bidr = new Bidder(tc.get(), commod);
+  BidPortfolio<Material>::Ptr bp(new BidPortfolio<Material>());
+  Bid<Material>* bid = bp->AddBid(req, mat, bidr);
+  bidr->port_ = bp;
+  Facility* bclone = dynamic_cast<Facility*>(bidr->Clone());
+  bclone->Build(NULL);
+
+  exchng->AddAllRequests();
+  exchng->AddAllBids();
+  exchng->AdjustAll();
+
+  // an unregistered ancestor is never handed a table
+  EXPECT_EQ(0, pcast->table_.size());
+  ExchangeContext<Material>& context = exchng->ex_ctx();
+  EXPECT_DOUBLE_EQ(std::pow(pref, 2), context.trader_prefs[child][req][bid]);
+
+  child->Decommission();
+  parent->Decommission();
+}
@@ -99,3 +99,25 @@ TEST_F(ResourceTest, ProductExtractGraphid) {
   EXPECT_NE(p1->state_id(), p3->state_id());
 }
 
+
+TEST_F(ResourceTest, ResCast) {
+  cyclus::Resource::Ptr r = m1;
+  EXPECT_EQ(Material::kTag, r->tag());
+  EXPECT_EQ(m1, cyclus::ResCast<Material>(r));
+  EXPECT_FALSE(cyclus::ResCast<Product>(r));
+
+  r = p1->Clone();
+  EXPECT_EQ(Product::kTag, r->tag());
+  EXPECT_TRUE(cyclus::ResCast<Product>(r));
+  EXPECT_FALSE(cyclus::ResCast<Material>(r));
+
+  EXPECT_FALSE(cyclus::ResCast<Material>(cyclus::Resource::Ptr()));
+
+  std::vector<cyclus::Resource::Ptr> rs;
+  rs.push_back(m1);
+  rs.push_back(p1);
+  std::vector<Material::Ptr> mats = cyclus::ResCast<Material>(rs);
+  ASSERT_EQ(2, mats.size());
+  EXPECT_EQ(m1, mats[0]);
+  EXPECT_FALSE(mats[1]);
+}
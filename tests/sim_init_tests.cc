@@ -1,5 +1,8 @@
+#include <cstdio>
+
 #include <gtest/gtest.h>
 
+#include "checkpoint_back.h"
 #include "comp_math.h"
 #include "composition.h"
 #include "context.h"
@@ -15,6 +18,9 @@
 // special name to tell sqlite to use in-mem db
 static const char* dbpath = ":memory:";
 
+// prefix of the checkpoint files written by the fixture
+static const char* ckptprefix = "siminittest";
+
 namespace cy = cyclus;
 using cy::Agent;
 
@@ -86,6 +92,30 @@ Agent* ConstructInver(cy::Context* ctx) {
   return new Inver(ctx);
 }
 
+// Counts the queries made of each table of a backend.
+class QueryCounter : public cy::QueryableBackend {
+ public:
+  QueryCounter(cy::QueryableBackend* b) : b_(b) {}
+
+  virtual cy::QueryResult Query(std::string table,
+                                std::vector<cy::Cond>* conds) {
+    ++counts[table];
+    return b_->Query(table, conds);
+  }
+  virtual std::map<std::string, cy::DbTypes> ColumnTypes(std::string table) {
+    return b_->ColumnTypes(table);
+  }
+  virtual std::list<cy::ColumnInfo> Schema(std::string table) {
+    return b_->Schema(table);
+  }
+  virtual std::set<std::string> Tables() { return b_->Tables(); }
+
+  std::map<std::string, int> counts;
+
+ private:
+  cy::QueryableBackend* b_;
+};
+
 class SimInitTest : public ::testing::Test {
  public:
   SimInitTest() : rec((unsigned int) 300) {}
@@ -97,12 +127,22 @@ class SimInitTest : public ::testing::Test {
 
     b = new cy::SqliteBack(dbpath);
     rec.RegisterBackend(b);
+    ckpt = new cy::CheckpointBack(ckptprefix);
+    rec.RegisterBackend(ckpt);
     ctx = new cy::Context(&ti, &rec);
     ctx->NewDatum("SolverInfo")
         ->AddVal("Solver", std::string("greedy")) // str constructor for macs
         ->AddVal("ExclusiveOrders", true)
         ->Record();
-    ctx->InitSim(cy::SimInfo(5));
+    cy::SimInfo info(5);
+    info.dre_stats = true;
+    info.checkpoint_minutes = 60;
+    cy::TableStorageInfo st;
+    st.table = "Resources";
+    st.codec = "zstd";
+    st.shuffle = 1;
+    info.hdf5_storage.push_back(st);
+    ctx->InitSim(info);
 
     cy::CompMap v;
     v[922350000] = 1;
@@ -143,6 +183,10 @@ class SimInitTest : public ::testing::Test {
     rec.Close();
     delete ctx;
     delete b;
+    delete ckpt;
+    for (int t = 0; t <= 5; ++t) {
+      remove(cy::CheckpointBack::Path(ckptprefix, t).c_str());
+    }
   }
 
   void resetnextids() {
@@ -154,12 +198,14 @@ class SimInitTest : public ::testing::Test {
   }
   int agentid() { return Agent::next_id_; }
   int stateid() { return cy::Resource::nextstate_id_; }
+  void stateid(int id) { cy::Resource::nextstate_id_ = id; }
   int objid() { return cy::Resource::nextobj_id_; }
   int compid() { return cy::Composition::next_id_; }
   int prodid() { return cy::Product::next_qualid_; }
   int transid(cy::Context* ctx) { return ctx->trans_id_; }
 
   cy::SimInfo siminfo(cy::Context* ctx) { return ctx->si_; }
+  void delta_snapshots(cy::Context* ctx) { ctx->si_.delta_snapshots = true; }
   std::set<Agent*> agent_list(cy::Context* ctx) { return ctx->agent_list_; }
   std::map<int, cy::TimeListener*> tickers(cy::Timer* ti) { return ti->tickers_; }
 
@@ -170,11 +216,16 @@ class SimInitTest : public ::testing::Test {
   std::map<int, std::vector<Agent*> > decom_queue(cy::Timer* ti) {
     return ti->decom_queue_;
   }
+  void set_time(cy::Timer* ti, int t) { ti->time_ = t; }
+  std::map<int, std::pair<cy::TimeListener*, int> > sleepers(cy::Timer* ti) {
+    return ti->sleepers_;
+  }
 
   cy::Context* ctx;
   cy::Timer ti;
   cy::Recorder rec;
   cy::SqliteBack* b;
+  cy::CheckpointBack* ckpt;
 };
 
 TEST_F(SimInitTest, InitNextIds) {
@@ -220,6 +271,17 @@ TEST_F(SimInitTest, InitSimInfo) {
   EXPECT_EQ(si_orig.parent_sim, si_init.parent_sim);
   EXPECT_EQ(si_orig.parent_type, si_init.parent_type);
   EXPECT_EQ(si_orig.branch_time, si_init.branch_time);
+  EXPECT_TRUE(si_init.dre_stats);
+  EXPECT_EQ(si_orig.threads, si_init.threads);
+  EXPECT_EQ(si_orig.checkpoint_interval, si_init.checkpoint_interval);
+  EXPECT_DOUBLE_EQ(60, si_init.checkpoint_minutes);
+  EXPECT_EQ(si_orig.decay_cache_size, si_init.decay_cache_size);
+  ASSERT_EQ(1, si_init.hdf5_storage.size());
+  EXPECT_EQ("Resources", si_init.hdf5_storage[0].table);
+  EXPECT_EQ(-1, si_init.hdf5_storage[0].chunk_size);
+  EXPECT_EQ("zstd", si_init.hdf5_storage[0].codec);
+  EXPECT_EQ(-1, si_init.hdf5_storage[0].level);
+  EXPECT_EQ(1, si_init.hdf5_storage[0].shuffle);
 }
 
 TEST_F(SimInitTest, InitRecipes) {
@@ -290,6 +352,32 @@ TEST_F(SimInitTest, InitDecomSched) {
   }
 }
 
+TEST_F(SimInitTest, InitSleeps) {
+  std::set<Agent*> agents = agent_list(ctx);
+  std::vector<cy::TimeListener*> deployed;
+  std::set<Agent*>::iterator it;
+  for (it = agents.begin(); it != agents.end(); ++it) {
+    if ((*it)->enter_time() != -1) {
+      deployed.push_back(dynamic_cast<cy::TimeListener*>(*it));
+    }
+  }
+  ASSERT_EQ(2, deployed.size());
+  ctx->Sleep(deployed[0], 4);
+  ctx->Sleep(deployed[1]);
+  cy::SimInit::Snapshot(ctx);
+  rec.Flush();
+
+  cy::SimInit si;
+  si.Init(&rec, b);
+  EXPECT_EQ(0, tickers(si.timer()).size());
+  std::map<int, std::pair<cy::TimeListener*, int> > s = sleepers(si.timer());
+  ASSERT_EQ(2, s.size());
+  ASSERT_EQ(1, s.count(deployed[0]->id()));
+  ASSERT_EQ(1, s.count(deployed[1]->id()));
+  EXPECT_EQ(4, s[deployed[0]->id()].second);
+  EXPECT_EQ(-1, s[deployed[1]->id()].second);
+}
+
 TEST_F(SimInitTest, InitProtos) {
   cy::SimInit si;
   si.Init(&rec, b);
@@ -421,6 +509,150 @@ TEST_F(SimInitTest, InitAgentInventories) {
   }
 }
 
+TEST_F(SimInitTest, InitInventoryQueries) {
+  QueryCounter qc(b);
+  cy::SimInit si;
+  si.Init(&rec, &qc);
+
+  // inventories are restored with one query per table rather than one per
+  // agent and resource
+  EXPECT_EQ(1, qc.counts["AgentStateInventories"]);
+  EXPECT_EQ(1, qc.counts["Resources"]);
+  EXPECT_EQ(1, qc.counts["MaterialInfo"]);
+  EXPECT_EQ(0, qc.counts["Products"]);
+  EXPECT_EQ(2 + 1, qc.counts["Compositions"]);  // recipes, then inventories
+}
+
+TEST_F(SimInitTest, InitSparseInventoryQueries) {
+  // an agent whose resources are far from the others' in id
+  stateid(1000);
+  Agent* late = ctx->CreateAgent<Agent>("proto1");
+  late->Build(NULL);
+  set_time(&ti, 1);
+  cy::SimInit::Snapshot(ctx);
+  rec.Flush();
+
+  cy::PyStart();
+  QueryCounter qc(b);
+  cy::SimInit si;
+  si.Restart(&qc, rec.sim_id(), 1);
+  cy::PyStop();
+
+  // one range query for each run of ids rather than one spanning the gap
+  EXPECT_EQ(2, qc.counts["Resources"]);
+  EXPECT_EQ(2, qc.counts["MaterialInfo"]);
+  EXPECT_EQ(5, agent_list(si.context()).size());  // 3 deployed, 2 protos
+}
+
+TEST_F(SimInitTest, DeltaSnapshots) {
+  delta_snapshots(ctx);
+  std::set<Agent*> agents = agent_list(ctx);
+  Inver* inver = NULL;
+  std::set<Agent*>::iterator it;
+  for (it = agents.begin(); it != agents.end(); ++it) {
+    if ((*it)->enter_time() != -1) {
+      inver = dynamic_cast<Inver*>(*it);
+    }
+  }
+  ASSERT_TRUE(inver != NULL);
+  std::vector<cy::Cond> conds;
+  conds.push_back(cy::Cond("AgentId", "==", inver->id()));
+
+  // the first delta snapshot records every agent, later ones only the agents
+  // whose state changed
+  cy::SimInit::Snapshot(ctx);
+  rec.Flush();
+  int n = b->Query("AgentStateAgent", &conds).rows.size();
+  cy::SimInit::Snapshot(ctx);
+  rec.Flush();
+  EXPECT_EQ(n, b->Query("AgentStateAgent", &conds).rows.size());
+  inver->val1 = 99;
+  cy::SimInit::Snapshot(ctx);
+  rec.Flush();
+  EXPECT_EQ(n + 1, b->Query("AgentStateAgent", &conds).rows.size());
+}
+
+TEST_F(SimInitTest, Branch) {
+  cy::PyStart();
+  ti.RunSim();
+  rec.Flush();
+
+  // several branches from the same prefix, each with its own sim id
+  for (int i = 0; i < 2; ++i) {
+    boost::uuids::uuid id = boost::uuids::random_generator()();
+    cy::SimInit si;
+    si.Branch(b, rec.sim_id(), 5, id);
+    cy::SimInfo info = si.context()->sim_info();
+    EXPECT_EQ(id, si.recorder()->sim_id());
+    EXPECT_EQ(5, si.context()->time());
+    EXPECT_EQ(rec.sim_id(), info.parent_sim);
+    EXPECT_EQ("branch", info.parent_type);
+    EXPECT_EQ(5, info.branch_time);
+    EXPECT_EQ(4, agent_list(si.context()).size());  // 2 deployed, 2 protos
+
+    cy::SqliteBack branch(dbpath);
+    si.recorder()->RegisterBackend(&branch);
+    si.timer()->RunSim();
+    si.recorder()->Close();
+    std::vector<cy::Cond> conds;
+    conds.push_back(cy::Cond("SimId", "==", id));
+    EXPECT_EQ(1, branch.Query("Finish", &conds).rows.size());
+  }
+  cy::PyStop();
+}
+
+TEST_F(SimInitTest, BranchFromCheckpoint) {
+  cy::PyStart();
+  ti.RunSim();
+  rec.Flush();  // the snapshot at 4 writes the checkpoint at 3
+
+  std::vector<cy::Cond> conds;
+  conds.push_back(cy::Cond("SimId", "==", rec.sim_id()));
+  conds.push_back(cy::Cond("EnterTime", ">=", 3));
+  cy::QueryResult entries = b->Query("AgentEntry", &conds);
+  ASSERT_EQ(1, entries.rows.size());  // proto2 is built at 3
+  conds[1] = cy::Cond("Time", "==", 5);
+  cy::QueryResult ids = b->Query("NextIds", &conds);
+  ASSERT_LT(0, ids.rows.size());
+
+  // every branch from the checkpoint continues exactly as the original run
+  cy::CheckpointBack c;
+  c.Load(cy::CheckpointBack::Path(ckptprefix, 3));
+  for (int i = 0; i < 3; ++i) {
+    boost::uuids::uuid id = boost::uuids::random_generator()();
+    cy::SimInit si;
+    si.Branch(&c, rec.sim_id(), 3, id);
+    cy::SqliteBack branch(dbpath);
+    si.recorder()->RegisterBackend(&branch);
+    si.timer()->RunSim();
+    si.recorder()->Close();
+
+    conds.clear();
+    conds.push_back(cy::Cond("SimId", "==", id));
+    conds.push_back(cy::Cond("EnterTime", ">=", 3));
+    cy::QueryResult qr = branch.Query("AgentEntry", &conds);
+    ASSERT_EQ(entries.rows.size(), qr.rows.size());
+    EXPECT_EQ(entries.GetVal<int>("AgentId"), qr.GetVal<int>("AgentId"));
+    EXPECT_EQ(entries.GetVal<std::string>("Prototype"),
+              qr.GetVal<std::string>("Prototype"));
+    EXPECT_EQ(3, qr.GetVal<int>("EnterTime"));
+
+    conds[1] = cy::Cond("Time", "==", 5);
+    qr = branch.Query("NextIds", &conds);
+    ASSERT_EQ(ids.rows.size(), qr.rows.size());
+    for (int j = 0; j < ids.rows.size(); ++j) {
+      for (int k = 0; k < qr.rows.size(); ++k) {
+        if (qr.GetVal<std::string>("Object", k) ==
+            ids.GetVal<std::string>("Object", j)) {
+          EXPECT_EQ(ids.GetVal<int>("NextId", j), qr.GetVal<int>("NextId", k))
+              << ids.GetVal<std::string>("Object", j);
+        }
+      }
+    }
+  }
+  cy::PyStop();
+}
+
 TEST_F(SimInitTest, RestartSimInfo) {
   cy::PyStart();
   ti.RunSim();
@@ -6,8 +6,12 @@
 #include "OsiSolverInterface.hpp"
 
 #include "equality_helpers.h"
+#include "exchange_graph.h"
+#include "prog_solver.h"
+#include "rec_backend.h"
 #include "solver_factory.h"
 #include "env.h"
+#include "test_context.h"
 
 namespace cyclus {
 
@@ -165,4 +169,140 @@ TEST_F(SolverFactoryTests, CbcRedundant) {
   delete si;
 }
 
+TEST_F(SolverFactoryTests, CbcTimeLimit) {
+  if (!Env::allow_milps()) {
+    std::cout << "[  SKIPPED ] MILPS have been disabled.\n";
+    return;
+  }
+  sf_.solver_t("cbc");
+  OsiSolverInterface* si = sf_.get();
+  CoinMessageHandler h;
+  h.setLogLevel(0);
+  si->passInMessageHandler(&h);
+  Init(si);
+  si->setInteger(1);  // y
+  si->setInteger(2);  // z
+  EXPECT_TRUE(SolveProg(si, si->getInfinity(), false, NULL, 10));
+  const double* exp = &mip_exp_[0];
+  array_double_eq(&exp[0], si->getColSolution(), n_vars_);
+  delete si;
+}
+
+TEST(ProgSolverTests, Adaptive) {
+  if (!Env::allow_milps()) {
+    std::cout << "[  SKIPPED ] MILPS have been disabled.\n";
+    return;
+  }
+  ProgSolver solver("cbc", true);
+  solver.adaptive(true);
+  solver.time_per_int(0.5);
+
+  // one exclusive request that one supplier can meet
+  ExchangeNode::Ptr u(new ExchangeNode(1, true));
+  ExchangeNode::Ptr v(new ExchangeNode(1, true));
+  Arc a(u, v);
+  u->unit_capacities[a].push_back(1);
+  v->unit_capacities[a].push_back(1);
+  RequestGroup::Ptr r(new RequestGroup(1));
+  r->AddCapacity(1);
+  r->AddExchangeNode(u);
+  ExchangeNodeGroup::Ptr s(new ExchangeNodeGroup());
+  s->AddCapacity(1);
+  s->AddExchangeNode(v);
+  ExchangeGraph g;
+  g.AddRequestGroup(r);
+  g.AddSupplyGroup(s);
+  g.AddArc(a);
+
+  solver.Solve(&g);
+  EXPECT_NE("lp", solver.path());
+  ASSERT_EQ(1, g.matches().size());
+  EXPECT_EQ(a, g.matches()[0].first);
+  EXPECT_DOUBLE_EQ(1, g.matches()[0].second);
+}
+
+class StepsBack : public RecBackend {
+ public:
+  virtual void Notify(DatumList data) {
+    for (int i = 0; i != data.size(); i++) {
+      if (data[i]->title() == "ProgSolverSteps")
+        steps.push_back(data[i]->vals());
+    }
+  }
+  virtual std::string Name() { return "StepsBack"; }
+  virtual void Flush() {}
+  virtual void Close() {}
+
+  std::vector<Datum::Vals> steps;
+};
+
+TEST(ProgSolverTests, AdaptiveGreedy) {
+  if (!Env::allow_milps()) {
+    std::cout << "[  SKIPPED ] MILPS have been disabled.\n";
+    return;
+  }
+  StepsBack back;  // outlives the context's recorder
+  TestContext tc;
+  tc.recorder()->RegisterBackend(&back);
+
+  // a budget too small for cbc to improve on the greedy solution
+  double tmax = 1e-6;
+  ProgSolver solver("cbc", tmax, true, false, false);
+  solver.sim_ctx(tc.get());
+  solver.adaptive(true);
+
+  // two exclusive requests for one supplier that can only meet one of them;
+  // the greedy solution is optimal
+  ExchangeNode::Ptr u1(new ExchangeNode(1, true));
+  ExchangeNode::Ptr u2(new ExchangeNode(1, true));
+  ExchangeNode::Ptr v1(new ExchangeNode(1, true));
+  ExchangeNode::Ptr v2(new ExchangeNode(1, true));
+  Arc a1(u1, v1);
+  Arc a2(u2, v2);
+  a1.pref(2);
+  a2.pref(1);
+  u1->unit_capacities[a1].push_back(1);
+  v1->unit_capacities[a1].push_back(1);
+  u1->prefs[a1] = 2;
+  u2->unit_capacities[a2].push_back(1);
+  v2->unit_capacities[a2].push_back(1);
+  u2->prefs[a2] = 1;
+  RequestGroup::Ptr r1(new RequestGroup(1));
+  r1->AddCapacity(1);
+  r1->AddExchangeNode(u1);
+  RequestGroup::Ptr r2(new RequestGroup(1));
+  r2->AddCapacity(1);
+  r2->AddExchangeNode(u2);
+  ExchangeNodeGroup::Ptr s(new ExchangeNodeGroup());
+  s->AddCapacity(1);
+  s->AddExchangeNode(v1);
+  s->AddExchangeNode(v2);
+  ExchangeGraph g;
+  g.AddRequestGroup(r1);
+  g.AddRequestGroup(r2);
+  g.AddSupplyGroup(s);
+  g.AddArc(a1);
+  g.AddArc(a2);
+
+  solver.Solve(&g);
+  EXPECT_EQ("greedy", solver.path());
+  ASSERT_EQ(1, g.matches().size());
+  EXPECT_EQ(a1, g.matches()[0].first);
+  EXPECT_DOUBLE_EQ(1, g.matches()[0].second);
+
+  tc.recorder()->Flush();
+  ASSERT_EQ(1, back.steps.size());
+  const Datum::Vals& v = back.steps[0];
+  ASSERT_EQ(8, v.size());  // including the SimId
+  EXPECT_STREQ("NumInts", v[3].first);
+  EXPECT_EQ(2, v[3].second.cast<int>());
+  EXPECT_STREQ("Budget", v[4].first);
+  EXPECT_DOUBLE_EQ(tmax, v[4].second.cast<double>());
+  EXPECT_STREQ("Path", v[5].first);
+  EXPECT_EQ("greedy", v[5].second.cast<std::string>());
+  EXPECT_STREQ("GreedyObj", v[6].first);
+  EXPECT_STREQ("ProgObj", v[7].first);
+  EXPECT_LE(v[6].second.cast<double>(), v[7].second.cast<double>());
+}
+
 }  // namespace cyclus
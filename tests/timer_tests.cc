@@ -4,6 +4,8 @@
 #include "facility.h"
 #include "greedy_preconditioner.h"
 #include "greedy_solver.h"
+#include "material.h"
+#include "mem_stats.h"
 #include "pyhooks.h"
 #include "recorder.h"
 #include "timer.h"
@@ -37,6 +39,128 @@ class Dier : public cyclus::Facility {
 
 int Dier::decom_count = 0;
 
+class Decomer : public cyclus::Facility {
+ public:
+  Decomer(cyclus::Context* ctx) : cyclus::Facility(ctx) {}
+  virtual ~Decomer() {}
+
+  virtual cyclus::Agent* Clone() { return new Decomer(context()); }
+  virtual void InitInv(cyclus::Inventories& inv) {}
+  virtual cyclus::Inventories SnapshotInv() { return cyclus::Inventories(); }
+  virtual void Decommission() {
+    decom_times.push_back(context()->time());
+  }
+
+  void Tick() {}
+  void Tock() {}
+  std::vector<int> decom_times;
+};
+
+class Parer : public cyclus::Facility {
+ public:
+  Parer(cyclus::Context* ctx) : cyclus::Facility(ctx), ticks(0) {
+    spec(":Parer:Parer");
+  }
+  virtual ~Parer() {}
+
+  virtual cyclus::Agent* Clone() { return new Parer(context()); }
+  virtual void InitInv(cyclus::Inventories& inv) {}
+  virtual cyclus::Inventories SnapshotInv() { return cyclus::Inventories(); }
+  virtual Json::Value annotations() {
+    Json::Value root(Json::objectValue);
+    root["parallel"] = true;
+    return root;
+  }
+
+  void Tick() {
+    ticks++;
+    context()->NewDatum("Parer")
+        ->AddVal("AgentId", id())
+        ->AddVal("Time", context()->time())
+        ->Record();
+  }
+  void Tock() {}
+  int ticks;
+};
+
+class Maker : public cyclus::Facility {
+ public:
+  Maker(cyclus::Context* ctx) : cyclus::Facility(ctx), n(1) {
+    spec(":Maker:Maker");
+  }
+  virtual ~Maker() {}
+
+  virtual cyclus::Agent* Clone() { return new Maker(context()); }
+  virtual void InitInv(cyclus::Inventories& inv) {}
+  virtual cyclus::Inventories SnapshotInv() { return cyclus::Inventories(); }
+  virtual Json::Value annotations() {
+    Json::Value root(Json::objectValue);
+    root["parallel"] = true;
+    return root;
+  }
+
+  void Tick() {
+    for (int i = 0; i < n; ++i) {
+      cyclus::Material::Ptr m = cyclus::Material::Create(this, 1, comp);
+      obj_ids.push_back(m->obj_id());
+    }
+  }
+  void Tock() {}
+  int n;
+  cyclus::Composition::Ptr comp;
+  std::vector<int> obj_ids;
+};
+
+class Napper : public cyclus::Facility {
+ public:
+  Napper(cyclus::Context* ctx) : cyclus::Facility(ctx) {
+    // parallel annotations are cached per spec
+    spec(":Napper:Napper");
+  }
+  virtual ~Napper() {}
+
+  virtual cyclus::Agent* Clone() { return new Napper(context()); }
+  virtual void InitInv(cyclus::Inventories& inv) {}
+  virtual cyclus::Inventories SnapshotInv() { return cyclus::Inventories(); }
+
+  void Tick() {
+    for (int i = 0; i < targets.size(); ++i) {
+      seen.push_back(targets[i]->ticks);
+    }
+    if (context()->time() == 0) {
+      for (int i = 0; i < targets.size(); ++i) {
+        context()->Sleep(targets[i]);
+      }
+    }
+  }
+  void Tock() {}
+  std::vector<Parer*> targets;
+  std::vector<int> seen;
+};
+
+class Sleeper : public cyclus::Facility {
+ public:
+  Sleeper(cyclus::Context* ctx) : cyclus::Facility(ctx), period(3) {}
+  virtual ~Sleeper() {}
+
+  virtual cyclus::Agent* Clone() { return new Sleeper(context()); }
+  virtual void InitInv(cyclus::Inventories& inv) {}
+  virtual cyclus::Inventories SnapshotInv() { return cyclus::Inventories(); }
+
+  void Tick() {
+    ticks.push_back(context()->time());
+    if (period > 0) {
+      context()->Sleep(this, context()->time() + period);
+    } else {
+      context()->Sleep(this);
+    }
+  }
+  void Tock() { tocks.push_back(context()->time()); }
+  int period;
+  std::vector<int> ticks;
+  std::vector<int> tocks;
+};
+
 class Termer : public cyclus::Facility {
  public:
   Termer(cyclus::Context* ctx) : cyclus::Facility(ctx) {}
@@ -64,6 +188,31 @@ class Snapper : public cyclus::Facility {
   bool snap;
 };
 
+// counts the Checkpoints rows that have reached the backend in each Tick
+class CkptWatcher : public cyclus::Facility {
+ public:
+  CkptWatcher(cyclus::Context* ctx, cyclus::SqliteBack* b)
+      : cyclus::Facility(ctx), b(b) {}
+  virtual ~CkptWatcher() {}
+
+  virtual cyclus::Agent* Clone() { return new CkptWatcher(context(), b); }
+  virtual void InitInv(cyclus::Inventories& inv) {}
+  virtual cyclus::Inventories SnapshotInv() { return cyclus::Inventories(); }
+
+  void Tick() {
+    std::vector<cyclus::Cond> conds;
+    conds.push_back(cyclus::Cond("Time", "==", context()->time()));
+    try {
+      rows.push_back(b->Query("Checkpoints", &conds).rows.size());
+    } catch (cyclus::Error& err) {
+      rows.push_back(0);  // no Checkpoints table yet
+    }
+  }
+  void Tock() {}
+  cyclus::SqliteBack* b;
+  std::vector<int> rows;
+};
+
 TEST(TimerTests, BareSim) {
   cyclus::PyStart();
   cyclus::Recorder rec;
@@ -149,6 +298,87 @@ TEST(TimerTests, CustomSnapshot) {
   cyclus::PyStop();
 }
 
+TEST(TimerTests, CheckpointInterval) {
+  cyclus::PyStart();
+  cyclus::Recorder rec;
+  cyclus::Timer ti;
+  cyclus::Context ctx(&ti, &rec);
+  cyclus::SqliteBack b(path);
+  rec.RegisterBackend(&b);
+
+  cyclus::SimInfo si(10);
+  si.checkpoint_interval = 3;
+  ti.Initialize(&ctx, si);
+
+  Snapper* turtle = new Snapper(&ctx);
+  turtle->Build(NULL);
+  CkptWatcher* w = new CkptWatcher(&ctx, &b);
+  w->Build(NULL);
+
+  ti.RunSim();
+  rec.Close();
+
+  cyclus::QueryResult qr = b.Query("Snapshots", NULL);
+  ASSERT_EQ(4, qr.rows.size());
+  EXPECT_EQ(3, qr.GetVal<int>("Time", 0));
+  EXPECT_EQ(6, qr.GetVal<int>("Time", 1));
+  EXPECT_EQ(9, qr.GetVal<int>("Time", 2));
+  EXPECT_EQ(10, qr.GetVal<int>("Time", 3));
+
+  qr = b.Query("Checkpoints", NULL);
+  ASSERT_EQ(3, qr.rows.size());
+  EXPECT_EQ(3, qr.GetVal<int>("Time", 0));
+  EXPECT_EQ("interval", qr.GetVal<std::string>("Trigger", 0));
+  EXPECT_LE(0, qr.GetVal<double>("WallSecs", 0));
+
+  // each checkpoint's own row is in the backend by the time agents run
+  ASSERT_EQ(10, w->rows.size());
+  for (int t = 0; t < 10; ++t) {
+    EXPECT_EQ(t > 0 && t % 3 == 0 ? 1 : 0, w->rows[t]) << "time " << t;
+  }
+  cyclus::PyStop();
+}
+
+TEST(TimerTests, MemoryStats) {
+  cyclus::PyStart();
+  cyclus::Recorder rec;
+  cyclus::Timer ti;
+  cyclus::Context ctx(&ti, &rec);
+  cyclus::SqliteBack b(path);
+  rec.RegisterBackend(&b);
+
+  cyclus::SimInfo si(3);
+  si.memory_stats = true;
+  ti.Initialize(&ctx, si);
+
+  Snapper* turtle = new Snapper(&ctx);
+  turtle->Build(NULL);
+
+  ti.RunSim();
+  rec.Close();
+  cyclus::MemStats::Enable(false);
+
+  std::vector<cyclus::Cond> conds;
+  conds.push_back(cyclus::Cond("Object", "==", std::string("RecorderBuffer")));
+  cyclus::QueryResult qr = b.Query("MemoryStats", &conds);
+  ASSERT_EQ(3, qr.rows.size());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(i, qr.GetVal<int>("Time", i));
+    EXPECT_LT(0, qr.GetVal<int>("Count", i));
+    EXPECT_LT(0, qr.GetVal<double>("Bytes", i));
+  }
+
+  // live datums include the whole reusable buffer of the recorder
+  conds[0] = cyclus::Cond("Object", "==", std::string("Datum"));
+  qr = b.Query("MemoryStats", &conds);
+  ASSERT_EQ(3, qr.rows.size());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(rec.dump_count(), qr.GetVal<int>("Count", i));
+    EXPECT_LE(qr.GetVal<int>("Count", i), qr.GetVal<int>("HighWater", i));
+  }
+  cyclus::PyStop();
+}
+
 TEST(TimerTests, NullParentDecomNoSegfault) {
   cyclus::PyStart();
   cyclus::Recorder rec;
@@ -182,3 +412,173 @@ TEST(TimerTests, DoubleDecom) {
   EXPECT_EQ(1, Dier::decom_count);
   cyclus::PyStop();
 }
+
+TEST(TimerTests, RescheduleDecom) {
+  cyclus::PyStart();
+  cyclus::Recorder rec;
+  cyclus::Timer ti;
+  cyclus::Context ctx(&ti, &rec);
+
+  ti.Initialize(&ctx, cyclus::SimInfo(5));
+
+  Decomer* d1 = new Decomer(&ctx);
+  d1->Build(NULL);
+  Decomer* d2 = new Decomer(&ctx);
+  d2->Build(NULL);
+  ctx.SchedDecom(d1, 3);
+  ctx.SchedDecom(d2, 3);
+  ctx.SchedDecom(d1, 1);
+  ctx.SchedDecom(d1, 2);
+
+  ti.RunSim();
+  ASSERT_EQ(1, d1->decom_times.size());
+  EXPECT_EQ(2, d1->decom_times[0]);
+  ASSERT_EQ(1, d2->decom_times.size());
+  EXPECT_EQ(3, d2->decom_times[0]);
+  cyclus::PyStop();
+}
+
+TEST(TimerTests, ParallelTick) {
+  cyclus::PyStart();
+  cyclus::Recorder rec;
+  cyclus::Timer ti;
+  cyclus::Context ctx(&ti, &rec);
+  cyclus::SqliteBack b(path);
+  rec.RegisterBackend(&b);
+
+  cyclus::SimInfo si(3);
+  si.threads = 4;
+  ti.Initialize(&ctx, si);
+
+  std::vector<Parer*> ps;
+  for (int i = 0; i < 10; ++i) {
+    Parer* p = new Parer(&ctx);
+    p->Build(NULL);
+    ps.push_back(p);
+  }
+
+  ti.RunSim();
+  rec.Close();
+
+  for (int i = 0; i < ps.size(); ++i) {
+    EXPECT_EQ(3, ps[i]->ticks);
+  }
+
+  // datums are recorded in order of time and then agent id regardless of
+  // which thread ran which agent
+  cyclus::QueryResult qr = b.Query("Parer", NULL);
+  ASSERT_EQ(30, qr.rows.size());
+  for (int i = 0; i < qr.rows.size(); ++i) {
+    EXPECT_EQ(i / 10, qr.GetVal<int>("Time", i));
+    EXPECT_EQ(ps[i % 10]->id(), qr.GetVal<int>("AgentId", i));
+  }
+  cyclus::PyStop();
+}
+
+TEST(TimerTests, ParallelTickIds) {
+  cyclus::PyStart();
+  cyclus::Recorder rec;
+  cyclus::Timer ti;
+  cyclus::Context ctx(&ti, &rec);
+
+  cyclus::SimInfo si(2);
+  si.threads = 4;
+  ti.Initialize(&ctx, si);
+
+  cyclus::CompMap v;
+  v[922350000] = 1;
+  cyclus::Composition::Ptr c = cyclus::Composition::CreateFromMass(v);
+  std::vector<Maker*> ms;
+  for (int i = 0; i < 6; ++i) {
+    Maker* m = new Maker(&ctx);
+    m->n = i + 1;
+    m->comp = c;
+    m->Build(NULL);
+    ms.push_back(m);
+  }
+
+  ti.RunSim();
+
+  // each agent takes its objects' ids from its own block, and the blocks are
+  // laid out in agent id order, regardless of which thread ran which agent
+  for (int t = 0; t < 2; ++t) {
+    int first = ms[0]->obj_ids[t];
+    for (int i = 0; i < ms.size(); ++i) {
+      int n = ms[i]->n;
+      ASSERT_EQ(2 * n, ms[i]->obj_ids.size());
+      for (int j = 0; j < n; ++j) {
+        EXPECT_EQ(first + 16 * i + j, ms[i]->obj_ids[t * n + j]);
+      }
+    }
+  }
+  cyclus::PyStop();
+}
+
+TEST(TimerTests, ParallelTickSleptBySerial) {
+  cyclus::PyStart();
+  cyclus::Recorder rec;
+  cyclus::Timer ti;
+  cyclus::Context ctx(&ti, &rec);
+
+  cyclus::SimInfo si(3);
+  si.threads = 4;
+  ti.Initialize(&ctx, si);
+
+  Parer* p1 = new Parer(&ctx);
+  p1->Build(NULL);
+  Napper* n = new Napper(&ctx);
+  n->Build(NULL);
+  Parer* p2 = new Parer(&ctx);
+  p2->Build(NULL);
+  n->targets.push_back(p1);
+  n->targets.push_back(p2);
+
+  ti.RunSim();
+
+  // the parallel agent with a lower id is ticked before the serial one, the
+  // one with a higher id after it, and neither is ticked once put to sleep
+  ASSERT_EQ(6, n->seen.size());
+  EXPECT_EQ(1, n->seen[0]);
+  EXPECT_EQ(0, n->seen[1]);
+  EXPECT_EQ(1, p1->ticks);
+  EXPECT_EQ(0, p2->ticks);
+  cyclus::PyStop();
+}
+
+TEST(TimerTests, Sleep) {
+  cyclus::PyStart();
+  cyclus::Recorder rec;
+  cyclus::Timer ti;
+  cyclus::Context ctx(&ti, &rec);
+
+  ti.Initialize(&ctx, cyclus::SimInfo(10));
+
+  Sleeper* s1 = new Sleeper(&ctx);
+  s1->Build(NULL);
+  Sleeper* s2 = new Sleeper(&ctx);
+  s2->period = -1;
+  s2->Build(NULL);
+
+  EXPECT_THROW(ctx.Sleep(s1, 0), cyclus::ValueError);
+
+  ti.RunSim();
+
+  // sleeping from Tick skips the Tock of the same timestep
+  ASSERT_EQ(4, s1->ticks.size());
+  EXPECT_EQ(0, s1->ticks[0]);
+  EXPECT_EQ(3, s1->ticks[1]);
+  EXPECT_EQ(6, s1->ticks[2]);
+  EXPECT_EQ(9, s1->ticks[3]);
+  EXPECT_EQ(0, s1->tocks.size());
+
+  ASSERT_EQ(1, s2->ticks.size());
+  EXPECT_EQ(0, s2->ticks[0]);
+
+  // waking resumes notifications
+  ctx.Wake(s2);
+  s2->period = 0;
+  ti.Initialize(&ctx, cyclus::SimInfo(1));
+  ti.RunSim();
+  EXPECT_EQ(2, s2->ticks.size());
+  cyclus::PyStop();
+}
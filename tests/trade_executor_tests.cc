@@ -9,6 +9,7 @@
 #include "bid.h"
 #include "context.h"
 #include "material.h"
+#include "rec_backend.h"
 #include "request.h"
 #include "resource_helpers.h"
 #include "test_context.h"
@@ -29,6 +30,50 @@ using cyclus::TestTrader;
 using cyclus::Trade;
 using cyclus::TradeExecutor;
 using cyclus::Trader;
+using cyclus::TraderCompare;
+
+typedef cyclus::TradeExecutionContext<Material>::Range Range;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class ParTrader : public TestTrader {
+ public:
+  ParTrader(Context* ctx, cyclus::TestObjFactory* fac) : TestTrader(ctx, fac) {
+    // parallel_trades annotations are cached per spec
+    cyclus::Agent::spec(":ParTrader:ParTrader");
+  }
+
+  virtual Json::Value annotations() {
+    Json::Value root(Json::objectValue);
+    root["parallel_trades"] = true;
+    return root;
+  }
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class TransBack : public cyclus::RecBackend {
+ public:
+  virtual void Notify(cyclus::DatumList data) {
+    for (int i = 0; i < data.size(); ++i) {
+      if (data[i]->title() != "Transactions") {
+        continue;
+      }
+      const cyclus::Datum::Vals& v = data[i]->vals();
+      for (int j = 0; j < v.size(); ++j) {
+        if (std::string(v[j].first) == "SenderId") {
+          senders.push_back(v[j].second.cast<int>());
+        } else if (std::string(v[j].first) == "ReceiverId") {
+          receivers.push_back(v[j].second.cast<int>());
+        }
+      }
+    }
+  }
+  virtual std::string Name() { return "TransBack"; }
+  virtual void Flush() {}
+  virtual void Close() {}
+
+  std::vector<int> senders;
+  std::vector<int> receivers;
+};
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 class TradeExecutorTests : public ::testing::Test {
@@ -89,23 +134,25 @@ class TradeExecutorTests : public ::testing::Test {
 TEST_F(TradeExecutorTests, SupplierGrouping) {
   TradeExecutor<Material> exec(trades);
   GroupTradesBySupplier(exec.trade_ctx(), trades);
-  std::map<Trader*, std::vector< Trade<Material> > > obs =
-      exec.trade_ctx().trades_by_supplier;
-  std::map<Trader*, std::vector< Trade<Material> > > exp;
-  exp[s1].push_back(t1);
-  exp[s2].push_back(t2);
-  exp[s2].push_back(t3);
 
-  EXPECT_EQ(obs, exp);
+  std::vector< Trade<Material> > exp;
+  exp.push_back(t1);
+  exp.push_back(t2);
+  exp.push_back(t3);
+  EXPECT_EQ(exp, exec.trade_ctx().trades);
 
-  std::set<Trader*> requesters;
-  std::set<Trader*> suppliers;
+  const std::vector< std::pair<Trader*, Range> >& by_sup =
+      exec.trade_ctx().by_supplier;
+  ASSERT_EQ(2, by_sup.size());
+  EXPECT_EQ(s1, by_sup[0].first);
+  EXPECT_EQ(Range(0, 1), by_sup[0].second);
+  EXPECT_EQ(s2, by_sup[1].first);
+  EXPECT_EQ(Range(1, 3), by_sup[1].second);
+
+  std::set<Trader*, TraderCompare> requesters;
   requesters.insert(r1);
   requesters.insert(r2);
-  suppliers.insert(s1);
-  suppliers.insert(s2);
   EXPECT_EQ(exec.trade_ctx().requesters, requesters);
-  EXPECT_EQ(exec.trade_ctx().suppliers, suppliers);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -114,37 +161,109 @@ TEST_F(TradeExecutorTests, SupplierResponses) {
   GroupTradesBySupplier(exec.trade_ctx(), trades);
   GetTradeResponses(exec.trade_ctx());
 
-  std::map<Trader*,
-           std::vector< std::pair<Trade<Material>, Material::Ptr> > >
-      by_req_obs = exec.trade_ctx().trades_by_requester;
-  EXPECT_NE(std::find(by_req_obs[r1].begin(),
-                      by_req_obs[r1].end(),
-                      std::make_pair(t1, fac.mat)),
-            by_req_obs[r1].end());
-  EXPECT_NE(std::find(by_req_obs[r1].begin(),
-                      by_req_obs[r1].end(),
-                      std::make_pair(t2, fac.mat)),
-            by_req_obs[r1].end());
-  EXPECT_NE(std::find(by_req_obs[r2].begin(),
-                      by_req_obs[r2].end(),
-                      std::make_pair(t3, fac.mat)),
-            by_req_obs[r2].end());
-
-  std::map<std::pair<Trader*, Trader*>,
-           std::vector< std::pair<Trade<Material>, Material::Ptr> > >
-      all_t_obs = exec.trade_ctx().all_trades;
-  EXPECT_NE(std::find(all_t_obs[std::make_pair(s1, r1)].begin(),
-                      all_t_obs[std::make_pair(s1, r1)].end(),
-                      std::make_pair(t1, fac.mat)),
-            all_t_obs[std::make_pair(s1, r1)].end());
-  EXPECT_NE(std::find(all_t_obs[std::make_pair(s2, r1)].begin(),
-                      all_t_obs[std::make_pair(s2, r1)].end(),
-                      std::make_pair(t2, fac.mat)),
-            all_t_obs[std::make_pair(s2, r1)].end());
-  EXPECT_NE(std::find(all_t_obs[std::make_pair(s2, r2)].begin(),
-                      all_t_obs[std::make_pair(s2, r2)].end(),
-                      std::make_pair(t3, fac.mat)),
-            all_t_obs[std::make_pair(s2, r2)].end());
+  const std::vector< std::pair<Trade<Material>, Material::Ptr> >& resps =
+      exec.trade_ctx().responses;
+  ASSERT_EQ(3, resps.size());
+  EXPECT_EQ(std::make_pair(t1, fac.mat), resps[0]);
+  EXPECT_EQ(std::make_pair(t2, fac.mat), resps[1]);
+  EXPECT_EQ(std::make_pair(t3, fac.mat), resps[2]);
+
+  const std::vector< std::pair<Trader*, Range> >& by_req =
+      exec.trade_ctx().by_requester;
+  ASSERT_EQ(2, by_req.size());
+  EXPECT_EQ(r1, by_req[0].first);
+  EXPECT_EQ(Range(0, 2), by_req[0].second);
+  EXPECT_EQ(r2, by_req[1].first);
+  EXPECT_EQ(Range(2, 3), by_req[1].second);
+
+  const std::vector< std::pair<std::pair<Trader*, Trader*>, Range> >&
+      by_pair = exec.trade_ctx().by_pair;
+  ASSERT_EQ(3, by_pair.size());
+  EXPECT_EQ(std::make_pair(static_cast<Trader*>(s1),
+                           static_cast<Trader*>(r1)), by_pair[0].first);
+  EXPECT_EQ(Range(0, 1), by_pair[0].second);
+  EXPECT_EQ(std::make_pair(static_cast<Trader*>(s2),
+                           static_cast<Trader*>(r1)), by_pair[1].first);
+  EXPECT_EQ(Range(1, 2), by_pair[1].second);
+  EXPECT_EQ(std::make_pair(static_cast<Trader*>(s2),
+                           static_cast<Trader*>(r2)), by_pair[2].first);
+  EXPECT_EQ(Range(2, 3), by_pair[2].second);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(TradeExecutorTests, GroupingOrder) {
+  // a supplier's trades keep their given order, and a requester's responses
+  // are ordered by supplier
+  std::vector< Trade<Material> > shuffled;
+  shuffled.push_back(t3);
+  shuffled.push_back(t2);
+  shuffled.push_back(t1);
+  TradeExecutor<Material> exec(shuffled);
+  GroupTradesBySupplier(exec.trade_ctx(), shuffled);
+  GetTradeResponses(exec.trade_ctx());
+
+  std::vector< Trade<Material> > exp;
+  exp.push_back(t1);
+  exp.push_back(t3);
+  exp.push_back(t2);
+  EXPECT_EQ(exp, exec.trade_ctx().trades);
+
+  const std::vector< std::pair<Trade<Material>, Material::Ptr> >& resps =
+      exec.trade_ctx().responses;
+  ASSERT_EQ(3, resps.size());
+  EXPECT_EQ(t1, resps[0].first);
+  EXPECT_EQ(t2, resps[1].first);
+  EXPECT_EQ(t3, resps[2].first);
+  EXPECT_EQ(3, exec.trade_ctx().by_pair.size());
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(TradeExecutorTests, ParallelSuppliers) {
+  cyclus::SimInfo si(1);
+  si.threads = 4;
+  tc.get()->InitSim(si);
+
+  // suppliers 1 and 2 are consecutive and thread safe, so they respond
+  // concurrently, and supplier 3 does not
+  ParTrader* p1 = new ParTrader(tc.get(), &fac);
+  ParTrader* p2 = new ParTrader(tc.get(), &fac);
+  TestTrader* p3 = new TestTrader(tc.get(), &fac);
+  Bid<Material>* pbid1 = Bid<Material>::Create(req1, fac.mat, p1);
+  Bid<Material>* pbid2 = Bid<Material>::Create(req2, fac.mat, p2);
+  Bid<Material>* pbid3 = Bid<Material>::Create(req1, fac.mat, p3);
+  std::vector< Trade<Material> > ptrades;
+  ptrades.push_back(Trade<Material>(req1, pbid1, amt));
+  ptrades.push_back(Trade<Material>(req2, pbid2, amt));
+  ptrades.push_back(Trade<Material>(req1, pbid3, amt));
+  ptrades.push_back(Trade<Material>(req2, pbid1, amt));
+
+  TradeExecutor<Material> exec(ptrades);
+  exec.ExecuteTrades(tc.get());
+  EXPECT_EQ(2, p1->offer);
+  EXPECT_EQ(1, p2->offer);
+  EXPECT_EQ(1, p3->offer);
+  EXPECT_EQ(2, r1->accept);
+  EXPECT_EQ(2, r2->accept);
+
+  // responses are grouped as if the suppliers had responded in turn
+  const std::vector< std::pair<Trader*, Range> >& by_req =
+      exec.trade_ctx().by_requester;
+  ASSERT_EQ(2, by_req.size());
+  EXPECT_EQ(Range(0, 2), by_req[0].second);
+  EXPECT_EQ(Range(2, 4), by_req[1].second);
+  const std::vector< std::pair<Trade<Material>, Material::Ptr> >& resps =
+      exec.trade_ctx().responses;
+  EXPECT_EQ(ptrades[0], resps[0].first);
+  EXPECT_EQ(ptrades[2], resps[1].first);
+  EXPECT_EQ(ptrades[3], resps[2].first);
+  EXPECT_EQ(ptrades[1], resps[3].first);
+
+  delete pbid3;
+  delete pbid2;
+  delete pbid1;
+  delete p3;
+  delete p2;
+  delete p1;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -168,6 +287,32 @@ TEST_F(TradeExecutorTests, NoThrowWriting) {
   EXPECT_NO_THROW(exec.RecordTrades(tc.get()));
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(TradeExecutorTests, RecordOrder) {
+  // trades are recorded in supplier and then requester order, although
+  // by_pair groups them by requester first
+  Bid<Material>* bid4 = Bid<Material>::Create(req2, fac.mat, s1);
+  std::vector< Trade<Material> > rtrades;
+  rtrades.push_back(t2);
+  rtrades.push_back(Trade<Material>(req2, bid4, amt));
+  TradeExecutor<Material> exec(rtrades);
+  exec.ExecuteTrades();
+  ASSERT_EQ(2, exec.trade_ctx().by_pair.size());
+  EXPECT_EQ(static_cast<Trader*>(s2), exec.trade_ctx().by_pair[0].first.first);
+
+  TransBack back;
+  tc.recorder()->RegisterBackend(&back);
+  exec.RecordTrades(tc.get());
+  tc.recorder()->Close();
+
+  ASSERT_EQ(2, back.senders.size());
+  EXPECT_EQ(s1->manager()->id(), back.senders[0]);
+  EXPECT_EQ(r2->manager()->id(), back.receivers[0]);
+  EXPECT_EQ(s2->manager()->id(), back.senders[1]);
+  EXPECT_EQ(r1->manager()->id(), back.receivers[1]);
+  delete bid4;
+}
+
 // This test was a part of a previous iteration of Trade testing, but its not
 // clear if this throwing behavior is what we want. I'm leaving it here for now
 // in case it needs to be picked up again. MJG - 11/26/13
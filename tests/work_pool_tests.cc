@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include "work_pool.h"
+
+using cyclus::WorkPool;
+
+struct Counter {
+  explicit Counter(int n) : runs(n) {
+    for (int i = 0; i < n; ++i) {
+      runs[i] = 0;
+    }
+  }
+
+  void operator()(int i) { ++runs[i]; }
+
+  std::vector<std::atomic<int> > runs;
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(WorkPoolTests, RunsEveryTaskOnce) {
+  WorkPool pool(4);
+  EXPECT_EQ(4, pool.size());
+
+  // the same threads run many batches, including ones with fewer tasks than
+  // threads and ones that are empty
+  int ns[] = {1000, 3, 0, 1, 17};
+  for (int b = 0; b < 5; ++b) {
+    Counter c(ns[b]);
+    pool.Run(ns[b], std::ref(c));
+    for (int i = 0; i < ns[b]; ++i) {
+      EXPECT_EQ(1, c.runs[i]) << "batch " << b << ", task " << i;
+    }
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(WorkPoolTests, SingleThread) {
+  WorkPool pool(1);
+  EXPECT_EQ(1, pool.size());
+  Counter c(10);
+  pool.Run(10, std::ref(c));
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(1, c.runs[i]);
+  }
+}